@@ -0,0 +1,59 @@
+import array
+import ctypes
+import os
+import shutil
+import sys
+import tempfile
+import unittest
+
+import sourcetraildb as srctrl
+
+
+# an int32 type with the byte order that is not the one of the host
+NON_NATIVE_INT32 = ctypes.c_int32.__ctype_be__ if sys.byteorder == "little" else ctypes.c_int32.__ctype_le__
+
+
+class BulkBufferTest(unittest.TestCase):
+	def setUp(self):
+		self.directory = tempfile.mkdtemp()
+		sourceFilePath = os.path.join(self.directory, "main.cpp").replace("\\", "/")
+		with open(sourceFilePath, "w") as sourceFile:
+			sourceFile.write("void foo() {}\n")
+
+		self.assertTrue(srctrl.open(os.path.join(self.directory, "test.srctrldb")), srctrl.getLastError())
+		srctrl.beginTransaction()
+		self.fileId = srctrl.recordFile(sourceFilePath)
+		self.symbolId = srctrl.recordSymbol(
+			'{ "name_delimiter": "::", "name_elements": [ '
+				'{ "prefix": "void", "name": "foo", "postfix": "()" } '
+			'] }')
+		self.assertNotEqual(self.fileId, 0, srctrl.getLastError())
+		self.assertNotEqual(self.symbolId, 0, srctrl.getLastError())
+
+	def tearDown(self):
+		srctrl.commitTransaction()
+		srctrl.close()
+		shutil.rmtree(self.directory)
+
+	def test_native_location_rows_are_recorded(self):
+		rows = array.array("i", [self.symbolId, self.fileId, 1, 6, 1, 8])
+		self.assertTrue(srctrl.recordSymbolLocations(rows), srctrl.getLastError())
+
+	def test_location_rows_with_explicit_native_byte_order_are_recorded(self):
+		rows = (ctypes.c_int32 * 6)(self.symbolId, self.fileId, 1, 6, 1, 8)
+		self.assertTrue(srctrl.recordSymbolLocations(rows), srctrl.getLastError())
+
+	def test_non_native_location_rows_are_rejected(self):
+		rows = (NON_NATIVE_INT32 * 6)(self.symbolId, self.fileId, 1, 6, 1, 8)
+		with self.assertRaises(TypeError):
+			srctrl.recordSymbolLocations(rows)
+
+	def test_non_native_reference_ids_are_rejected(self):
+		rows = array.array("i", [self.symbolId, self.symbolId, srctrl.REFERENCE_CALL])
+		referenceIds = (NON_NATIVE_INT32 * 1)()
+		with self.assertRaises(TypeError):
+			srctrl.recordReferences(rows, referenceIds)
+
+
+if __name__ == "__main__":
+	unittest.main()
@@ -0,0 +1,612 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Write throughput benchmark of the SourcetrailDBWriter. Records a synthetic workload and reports operations per
+// second and the peak resident set size after each record* family. Optionally measures typical read queries before
+// and after analyzing the written database.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+#include "CppSQLite3.h"
+#include "SourcetrailDBWriter.h"
+
+namespace
+{
+struct BenchmarkOptions
+{
+	std::string databasePath = "bench_core.srctrldb";
+	int symbolCount = 100000;
+	int hierarchyDepth = 3;
+	int referencesPerSymbol = 4;
+	int locationsPerReference = 2;
+	double duplicateRatio = 0.1;
+	int fileCount = 100;
+	int linesPerFile = 200;
+	unsigned int seed = 42;
+	std::string traceFilePath;
+	std::string journalFilePath;
+	std::string ingestLogFilePath;
+	bool hashKeys = false;
+	bool nameBuilder = false;
+	bool inMemory = false;
+	bool atomicBuild = false;
+	bool recreateOnClear = false;
+	bool analyze = false;
+	bool optimizeLocality = false;
+	bool help = false;
+};
+
+struct BenchmarkResult
+{
+	std::string name;
+	size_t callCount;
+	double seconds;
+	long peakResidentSetKiloBytes;
+};
+
+long getPeakResidentSetKiloBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#	ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#	else
+	return usage.ru_maxrss;
+#	endif
+#endif
+}
+
+void printUsage()
+{
+	std::cout << "usage: bench_core [options]\n"
+			  << "  --help                          print this list of options\n"
+			  << "  --database=<path>               database file to write (default: bench_core.srctrldb)\n"
+			  << "  --symbols=<count>               number of recorded symbols (default: 100000)\n"
+			  << "  --depth=<count>                 name hierarchy depth of each symbol (default: 3)\n"
+			  << "  --references-per-symbol=<count> references originating at each symbol (default: 4)\n"
+			  << "  --locations-per-reference=<n>   locations recorded for each reference (default: 2)\n"
+			  << "  --duplicate-ratio=<ratio>       share of calls that repeat earlier input (default: 0.1)\n"
+			  << "  --files=<count>                 number of recorded source files (default: 100)\n"
+			  << "  --lines-per-file=<count>        lines of each generated source file (default: 200)\n"
+			  << "  --seed=<number>                 seed of the workload generator (default: 42)\n"
+			  << "  --trace=<path>                  write a Chrome trace event file of the run (default: off)\n"
+			  << "  --journal=<path>                write an operation journal of the run for srctrldb_replay (default: off)\n"
+			  << "  --ingest-log=<path>             record to an ingest log and materialize it into the database (default: off)\n"
+			  << "  --hash-keys=<0|1>               index node names and error messages by hash keys (default: 0)\n"
+			  << "  --name-builder=<0|1>            record symbols with a NameHierarchyBuilder of the writer (default: 0)\n"
+			  << "  --in-memory=<0|1>               record to an in-memory database written to disk by close (default: 0)\n"
+			  << "  --atomic-build=<0|1>            build in a temporary file that replaces the database on close (default: 0)\n"
+			  << "  --recreate-on-clear=<0|1>       clear the database by replacing the database file (default: 0)\n"
+			  << "  --analyze=<0|1>                 measure read queries before and after analyzeDatabase() (default: 0)\n"
+			  << "  --optimize-locality=<0|1>       call optimizeDatabaseLocality() before closing (default: 0)\n";
+}
+
+bool parseOptions(int argc, const char* argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--help")
+		{
+			options.help = true;
+			continue;
+		}
+
+		const size_t separator = argument.find('=');
+		if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos)
+		{
+			return false;
+		}
+
+		const std::string key = argument.substr(2, separator - 2);
+		const std::string value = argument.substr(separator + 1);
+		if (key == "database")
+		{
+			options.databasePath = value;
+		}
+		else if (key == "symbols")
+		{
+			options.symbolCount = std::atoi(value.c_str());
+		}
+		else if (key == "depth")
+		{
+			options.hierarchyDepth = std::atoi(value.c_str());
+		}
+		else if (key == "references-per-symbol")
+		{
+			options.referencesPerSymbol = std::atoi(value.c_str());
+		}
+		else if (key == "locations-per-reference")
+		{
+			options.locationsPerReference = std::atoi(value.c_str());
+		}
+		else if (key == "duplicate-ratio")
+		{
+			options.duplicateRatio = std::atof(value.c_str());
+		}
+		else if (key == "files")
+		{
+			options.fileCount = std::atoi(value.c_str());
+		}
+		else if (key == "lines-per-file")
+		{
+			options.linesPerFile = std::atoi(value.c_str());
+		}
+		else if (key == "seed")
+		{
+			options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+		}
+		else if (key == "trace")
+		{
+			options.traceFilePath = value;
+		}
+		else if (key == "journal")
+		{
+			options.journalFilePath = value;
+		}
+		else if (key == "ingest-log")
+		{
+			options.ingestLogFilePath = value;
+		}
+		else if (key == "hash-keys")
+		{
+			options.hashKeys = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "name-builder")
+		{
+			options.nameBuilder = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "in-memory")
+		{
+			options.inMemory = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "atomic-build")
+		{
+			options.atomicBuild = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "recreate-on-clear")
+		{
+			options.recreateOnClear = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "analyze")
+		{
+			options.analyze = std::atoi(value.c_str()) != 0;
+		}
+		else if (key == "optimize-locality")
+		{
+			options.optimizeLocality = std::atoi(value.c_str()) != 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return options.symbolCount > 0 && options.hierarchyDepth > 0 && options.referencesPerSymbol >= 0 &&
+		options.locationsPerReference >= 0 && options.duplicateRatio >= 0.0 && options.duplicateRatio < 1.0 &&
+		options.fileCount > 0 && options.linesPerFile > 0;
+}
+
+sourcetrail::NameHierarchy createNameHierarchy(int symbolIndex, int hierarchyDepth)
+{
+	sourcetrail::NameHierarchy nameHierarchy;
+	nameHierarchy.nameDelimiter = "::";
+	for (int level = 0; level < hierarchyDepth - 1; level++)
+	{
+		// every scope contains 16 children of the next level, so that the parents are shared between symbols. Scopes
+		// above the 8 lowest levels all have index 0, shifting an int by its width or more is undefined.
+		const int shift = 4 * (hierarchyDepth - 1 - level);
+		const int scopeIndex = shift < 32 ? symbolIndex >> shift : 0;
+		nameHierarchy.nameElements.push_back({"", "scope" + std::to_string(level) + "_" + std::to_string(scopeIndex), ""});
+	}
+	nameHierarchy.nameElements.push_back({"void", "function" + std::to_string(symbolIndex), "(int, float)"});
+	return nameHierarchy;
+}
+
+std::string getSourceFilePath(const BenchmarkOptions& options, int fileIndex)
+{
+	return options.databasePath + "_file" + std::to_string(fileIndex) + ".cpp";
+}
+
+bool writeSourceFiles(const BenchmarkOptions& options)
+{
+	for (int i = 0; i < options.fileCount; i++)
+	{
+		std::ofstream fileStream(getSourceFilePath(options, i), std::ios::out | std::ios::trunc);
+		for (int line = 0; line < options.linesPerFile; line++)
+		{
+			fileStream << "void function" << line << "(int a, float b) { return call" << line << "(a, b); }\n";
+		}
+		if (!fileStream)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void removeSourceFiles(const BenchmarkOptions& options)
+{
+	for (int i = 0; i < options.fileCount; i++)
+	{
+		std::remove(getSourceFilePath(options, i).c_str());
+	}
+}
+
+class Benchmark
+{
+public:
+	Benchmark(const BenchmarkOptions& options): m_options(options), m_random(options.seed), m_failed(false) {}
+
+	bool run()
+	{
+		if (!writeSourceFiles(m_options))
+		{
+			std::cerr << "ERROR: Unable to write source files next to " << m_options.databasePath << std::endl;
+			return false;
+		}
+
+		if ((!m_options.traceFilePath.empty() && !m_writer.startTracing(m_options.traceFilePath)) ||
+			(!m_options.journalFilePath.empty() && !m_writer.startJournal(m_options.journalFilePath, false)))
+		{
+			std::cerr << "ERROR: " << m_writer.getLastError() << std::endl;
+			return false;
+		}
+
+		m_writer.setHashKeysEnabled(m_options.hashKeys);
+		m_writer.setAtomicBuildEnabled(m_options.atomicBuild);
+		m_writer.setRecreateOnClearEnabled(m_options.recreateOnClear);
+		if (m_options.inMemory)
+		{
+			measure("openInMemory", 1, [&](size_t) { check(m_writer.openInMemory(m_options.databasePath)); });
+			measure("clear", 1, [&](size_t) { check(m_writer.clear()); });
+		}
+		else if (m_options.ingestLogFilePath.empty())
+		{
+			measure("open", 1, [&](size_t) { check(m_writer.open(m_options.databasePath)); });
+			measure("clear", 1, [&](size_t) { check(m_writer.clear()); });
+		}
+		else
+		{
+			measure("openIngestLog", 1, [&](size_t) { check(m_writer.openIngestLog(m_options.ingestLogFilePath)); });
+		}
+		measure("beginTransaction", 1, [&](size_t) { check(m_writer.beginTransaction()); });
+
+		runRecordFiles();
+		runRecordSymbols();
+		runRecordSymbolKinds();
+		runRecordSymbolLocations();
+		runRecordReferences();
+		runRecordReferenceLocations();
+
+		measure("commitTransaction", 1, [&](size_t) { check(m_writer.commitTransaction()); });
+		if (m_options.optimizeLocality && m_options.ingestLogFilePath.empty())
+		{
+			measure("optimizeDatabaseLocality", 1, [&](size_t) { check(m_writer.optimizeDatabaseLocality()); });
+		}
+		measure("close", 1, [&](size_t) { check(m_writer.close()); });
+
+		if (!m_options.ingestLogFilePath.empty() && !m_failed)
+		{
+			// the recorded source files are read while materializing
+			std::remove(m_options.databasePath.c_str());
+			measure("open", 1, [&](size_t) { check(m_writer.open(m_options.databasePath)); });
+			measure("materializeIngestLog", 1, [&](size_t) {
+				check(m_writer.materializeIngestLog(m_options.ingestLogFilePath));
+			});
+			measure("close", 1, [&](size_t) { check(m_writer.close()); });
+			std::remove(m_options.ingestLogFilePath.c_str());
+		}
+
+		if (m_options.analyze && !m_failed)
+		{
+			runReadQueries("");
+			measure("open", 1, [&](size_t) { check(m_writer.open(m_options.databasePath)); });
+			measure("analyzeDatabase", 1, [&](size_t) { check(m_writer.analyzeDatabase()); });
+			measure("close", 1, [&](size_t) { check(m_writer.close()); });
+			runReadQueries(" analyzed");
+		}
+		m_writer.stopTracing();
+		m_writer.stopJournal();
+
+		removeSourceFiles(m_options);
+		return !m_failed;
+	}
+
+	void printResults() const
+	{
+		std::cout << std::left << std::setw(28) << "operation" << std::right << std::setw(12) << "calls"
+				  << std::setw(12) << "seconds" << std::setw(14) << "ops/sec" << std::setw(18) << "peak RSS (KiB)"
+				  << std::endl;
+		for (const BenchmarkResult& result: m_results)
+		{
+			const double opsPerSecond = result.seconds > 0.0 ? result.callCount / result.seconds : 0.0;
+			std::cout << std::left << std::setw(28) << result.name << std::right << std::setw(12) << result.callCount
+					  << std::setw(12) << std::fixed << std::setprecision(3) << result.seconds << std::setw(14)
+					  << std::setprecision(0) << opsPerSecond << std::setw(18) << result.peakResidentSetKiloBytes
+					  << std::endl;
+		}
+	}
+
+private:
+	// returns an index below currentIndex with the configured probability, otherwise currentIndex itself
+	size_t pickIndex(size_t currentIndex)
+	{
+		if (currentIndex > 0 && m_uniform(m_random) < m_options.duplicateRatio)
+		{
+			return std::uniform_int_distribution<size_t>(0, currentIndex - 1)(m_random);
+		}
+		return currentIndex;
+	}
+
+	void check(bool success)
+	{
+		if (!success && !m_failed)
+		{
+			std::cerr << "ERROR: " << m_writer.getLastError() << std::endl;
+			m_failed = true;
+		}
+	}
+
+	void measure(const std::string& name, size_t callCount, const std::function<void(size_t)>& operation)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < callCount && !m_failed; i++)
+		{
+			operation(i);
+		}
+		const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+		m_results.push_back({name, callCount, duration.count(), getPeakResidentSetKiloBytes()});
+	}
+
+	void runRecordFiles()
+	{
+		m_fileIds.resize(m_options.fileCount);
+		measure("recordFile", m_fileIds.size(), [&](size_t i) {
+			m_fileIds[i] = m_writer.recordFile(getSourceFilePath(m_options, static_cast<int>(i)));
+			check(m_fileIds[i] != 0);
+			check(m_writer.recordFileLanguage(m_fileIds[i], "cpp"));
+		});
+	}
+
+	void runRecordSymbols()
+	{
+		std::vector<sourcetrail::NameHierarchy> nameHierarchies;
+		nameHierarchies.reserve(m_options.symbolCount);
+		for (int i = 0; i < m_options.symbolCount; i++)
+		{
+			nameHierarchies.push_back(createNameHierarchy(static_cast<int>(pickIndex(i)), m_options.hierarchyDepth));
+		}
+
+		m_symbolIds.resize(nameHierarchies.size());
+		if (m_options.nameBuilder)
+		{
+			// the builder is filled within the measurement, like an indexer would do while traversing its AST
+			sourcetrail::NameHierarchyBuilder builder = m_writer.createNameHierarchyBuilder();
+			measure("recordSymbol", m_symbolIds.size(), [&](size_t i) {
+				builder.setNameDelimiter(nameHierarchies[i].nameDelimiter);
+				builder.clear();
+				for (const sourcetrail::NameElement& nameElement: nameHierarchies[i].nameElements)
+				{
+					builder.pushElement(nameElement.prefix, nameElement.name, nameElement.postfix);
+				}
+				m_symbolIds[i] = m_writer.recordSymbol(builder);
+				check(m_symbolIds[i] != 0);
+			});
+		}
+		else
+		{
+			measure("recordSymbol", m_symbolIds.size(), [&](size_t i) {
+				m_symbolIds[i] = m_writer.recordSymbol(nameHierarchies[i]);
+				check(m_symbolIds[i] != 0);
+			});
+		}
+	}
+
+	void runRecordSymbolKinds()
+	{
+		measure("recordSymbolDefinitionKind", m_symbolIds.size(), [&](size_t i) {
+			check(m_writer.recordSymbolDefinitionKind(m_symbolIds[i], sourcetrail::DefinitionKind::EXPLICIT));
+		});
+		measure("recordSymbolKind", m_symbolIds.size(), [&](size_t i) {
+			check(m_writer.recordSymbolKind(m_symbolIds[i], sourcetrail::SymbolKind::FUNCTION));
+		});
+	}
+
+	void runRecordSymbolLocations()
+	{
+		std::vector<sourcetrail::SourceRange> locations;
+		locations.reserve(m_symbolIds.size());
+		for (size_t i = 0; i < m_symbolIds.size(); i++)
+		{
+			locations.push_back(createSourceRange(pickIndex(i)));
+		}
+
+		measure("recordSymbolLocation", m_symbolIds.size(), [&](size_t i) {
+			check(m_writer.recordSymbolLocation(m_symbolIds[i], locations[i]));
+		});
+		measure("recordSymbolScopeLocation", m_symbolIds.size(), [&](size_t i) {
+			check(m_writer.recordSymbolScopeLocation(m_symbolIds[i], locations[i]));
+		});
+	}
+
+	void runRecordReferences()
+	{
+		struct Reference
+		{
+			int contextSymbolId;
+			int referencedSymbolId;
+		};
+
+		std::vector<Reference> references;
+		references.reserve(m_symbolIds.size() * m_options.referencesPerSymbol);
+		std::uniform_int_distribution<size_t> symbolDistribution(0, m_symbolIds.size() - 1);
+		for (size_t i = 0; i < m_symbolIds.size(); i++)
+		{
+			for (int j = 0; j < m_options.referencesPerSymbol; j++)
+			{
+				const size_t index = references.size();
+				const size_t pickedIndex = pickIndex(index);
+				references.push_back(
+					pickedIndex == index ? Reference{m_symbolIds[i], m_symbolIds[symbolDistribution(m_random)]}
+										 : references[pickedIndex]);
+			}
+		}
+
+		m_referenceIds.resize(references.size());
+		measure("recordReference", m_referenceIds.size(), [&](size_t i) {
+			m_referenceIds[i] = m_writer.recordReference(
+				references[i].contextSymbolId, references[i].referencedSymbolId, sourcetrail::ReferenceKind::CALL);
+			check(m_referenceIds[i] != 0);
+		});
+	}
+
+	void runRecordReferenceLocations()
+	{
+		std::vector<sourcetrail::SourceRange> locations;
+		locations.reserve(m_referenceIds.size() * m_options.locationsPerReference);
+		for (size_t i = 0; i < m_referenceIds.size() * m_options.locationsPerReference; i++)
+		{
+			locations.push_back(createSourceRange(pickIndex(i)));
+		}
+
+		measure("recordReferenceLocation", locations.size(), [&](size_t i) {
+			check(m_writer.recordReferenceLocation(m_referenceIds[i / m_options.locationsPerReference], locations[i]));
+		});
+	}
+
+	// runs lookups like the ones Sourcetrail uses to show a file, the references of a symbol and their locations
+	void runReadQueries(const std::string& nameSuffix)
+	{
+		try
+		{
+			CppSQLite3DB database;
+			database.open(m_options.databasePath.c_str());
+
+			CppSQLite3Statement fileStatement = database.compileStatement(
+				"SELECT id, start_line, start_column, end_line, end_column, type FROM source_location WHERE "
+				"file_node_id = ?;");
+			measure("readFileLocations" + nameSuffix, m_fileIds.size(), [&](size_t i) {
+				fileStatement.bind(1, m_fileIds[i]);
+				for (CppSQLite3Query q = fileStatement.execQuery(); !q.eof(); q.nextRow())
+				{
+				}
+				fileStatement.reset();
+			});
+
+			CppSQLite3Statement edgeStatement = database.compileStatement(
+				"SELECT id, type, target_node_id FROM edge WHERE source_node_id = ?;");
+			measure("readSymbolEdges" + nameSuffix, m_symbolIds.size(), [&](size_t i) {
+				edgeStatement.bind(1, m_symbolIds[i]);
+				for (CppSQLite3Query q = edgeStatement.execQuery(); !q.eof(); q.nextRow())
+				{
+				}
+				edgeStatement.reset();
+			});
+
+			CppSQLite3Statement locationStatement = database.compileStatement(
+				"SELECT source_location.id, source_location.file_node_id, source_location.start_line FROM occurrence "
+				"INNER JOIN source_location ON source_location.id = occurrence.source_location_id WHERE "
+				"occurrence.element_id = ?;");
+			measure("readRefLocations" + nameSuffix, m_referenceIds.size(), [&](size_t i) {
+				locationStatement.bind(1, m_referenceIds[i]);
+				for (CppSQLite3Query q = locationStatement.execQuery(); !q.eof(); q.nextRow())
+				{
+				}
+				locationStatement.reset();
+			});
+		}
+		catch (CppSQLite3Exception e)
+		{
+			std::cerr << "ERROR: " << e.errorMessage() << std::endl;
+			m_failed = true;
+		}
+	}
+
+	sourcetrail::SourceRange createSourceRange(size_t index) const
+	{
+		const int fileId = m_fileIds[index % m_fileIds.size()];
+		const int line = static_cast<int>((index / m_fileIds.size()) % m_options.linesPerFile) + 1;
+		const int column = static_cast<int>(index % 40) + 1;
+		return {fileId, line, column, line, column + 8};
+	}
+
+	const BenchmarkOptions m_options;
+	sourcetrail::SourcetrailDBWriter m_writer;
+	std::mt19937 m_random;
+	std::uniform_real_distribution<double> m_uniform;
+	bool m_failed;
+
+	std::vector<int> m_fileIds;
+	std::vector<int> m_symbolIds;
+	std::vector<int> m_referenceIds;
+	std::vector<BenchmarkResult> m_results;
+};
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+	if (options.help)
+	{
+		printUsage();
+		return 0;
+	}
+
+	std::cout << "SourcetrailDB core benchmark" << std::endl;
+	std::cout << "symbols: " << options.symbolCount << ", depth: " << options.hierarchyDepth
+			  << ", references per symbol: " << options.referencesPerSymbol
+			  << ", locations per reference: " << options.locationsPerReference
+			  << ", duplicate ratio: " << options.duplicateRatio << ", files: " << options.fileCount << std::endl;
+	std::cout << std::endl;
+
+	Benchmark benchmark(options);
+	const bool success = benchmark.run();
+	benchmark.printResults();
+	return success ? 0 : 1;
+}
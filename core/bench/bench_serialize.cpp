@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Micro benchmark of serializing the name hierarchies of recorded symbols to the database format. Compares building a
+// new string for each prefix level of a symbol, as SourcetrailDBWriter::recordSymbol() used to do, with serializing
+// into a reused buffer, and reports the heap allocations and time per symbol. The writer variants record the symbols
+// through SourcetrailDBWriter::recordSymbol() into a database or an ingest log, once for new symbols and once for
+// symbols that already exist. Only allocations of operator new are counted, SQLite allocates its own memory with malloc().
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "NameHierarchy.h"
+#include "SourcetrailDBWriter.h"
+
+namespace
+{
+size_t s_allocationCount = 0;
+}
+
+void* operator new(size_t size)
+{
+	s_allocationCount++;
+	if (void* p = std::malloc(size == 0 ? 1 : size))
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+// the implementation before serializing into a buffer was added, kept for comparison
+std::string serializeWithTemporaries(const sourcetrail::NameHierarchy& nameHierarchy)
+{
+	static std::string META_DELIMITER = "\tm";
+	static std::string NAME_DELIMITER = "\tn";
+	static std::string PARTS_DELIMITER = "\ts";
+	static std::string SIGNATURE_DELIMITER = "\tp";
+
+	std::string serialized = nameHierarchy.nameDelimiter + META_DELIMITER;
+	for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
+	{
+		if (i != 0)
+		{
+			serialized += NAME_DELIMITER;
+		}
+		const sourcetrail::NameElement& nameElement = nameHierarchy.nameElements[i];
+		serialized += nameElement.name + PARTS_DELIMITER + nameElement.prefix + SIGNATURE_DELIMITER + nameElement.postfix;
+	}
+	return serialized;
+}
+
+std::vector<sourcetrail::NameHierarchy> createNameHierarchies(int count)
+{
+	std::vector<sourcetrail::NameHierarchy> nameHierarchies;
+	for (int i = 0; i < count; i++)
+	{
+		nameHierarchies.push_back(
+			{"::",
+			 {{"", "project_namespace_" + std::to_string(i % 10), ""},
+			  {"template <typename T>", "SomeLongClassName" + std::to_string(i % 100), "<T>"},
+			  {"void", "memberFunction" + std::to_string(i), "(const std::vector<int> &, int)"}}});
+	}
+	return nameHierarchies;
+}
+
+template <typename Function>
+void measure(const std::string& name, const std::vector<sourcetrail::NameHierarchy>& nameHierarchies, Function function)
+{
+	size_t totalSize = 0;
+	const size_t allocationCountBefore = s_allocationCount;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (const sourcetrail::NameHierarchy& nameHierarchy: nameHierarchies)
+	{
+		totalSize += function(nameHierarchy);
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const size_t allocationCount = s_allocationCount - allocationCountBefore;
+
+	std::cout << std::left << std::setw(24) << name << std::right << std::setw(16) << std::fixed
+			  << std::setprecision(2) << static_cast<double>(allocationCount) / nameHierarchies.size() << std::setw(14)
+			  << seconds * 1e9 / nameHierarchies.size() << std::setw(16) << totalSize << std::endl;
+}
+
+// records all symbols twice with an opened writer, the sizes reported are the numbers of recorded symbols
+bool measureWriter(
+	const std::string& name,
+	const std::vector<sourcetrail::NameHierarchy>& nameHierarchies,
+	sourcetrail::SourcetrailDBWriter& writer)
+{
+	const auto recordSymbol = [&writer](const sourcetrail::NameHierarchy& nameHierarchy) {
+		return static_cast<size_t>(writer.recordSymbol(nameHierarchy) != 0);
+	};
+	measure(name + ", new", nameHierarchies, recordSymbol);
+	measure(name + ", existing", nameHierarchies, recordSymbol);
+
+	if (!writer.getLastError().empty())
+	{
+		std::cout << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+	return true;
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	const int symbolCount = argc > 1 ? std::atoi(argv[1]) : 200000;
+	const std::string databaseFilePath = argc > 2 ? argv[2] : "bench_serialize.srctrldb";
+	if (symbolCount <= 0)
+	{
+		std::cout << "usage: bench_serialize [symbol count] [database path]" << std::endl;
+		return 1;
+	}
+
+	const std::vector<sourcetrail::NameHierarchy> nameHierarchies = createNameHierarchies(symbolCount);
+
+	std::cout << "serializing " << symbolCount << " symbols with " << nameHierarchies.front().nameElements.size()
+			  << " prefix levels each" << std::endl
+			  << std::endl;
+	std::cout << std::left << std::setw(24) << "variant" << std::right << std::setw(16) << "allocs/symbol"
+			  << std::setw(14) << "ns/symbol" << std::setw(16) << "bytes" << std::endl;
+
+	measure("temporaries", nameHierarchies, [](const sourcetrail::NameHierarchy& nameHierarchy) {
+		size_t size = 0;
+		sourcetrail::NameHierarchy currentNameHierarchy;
+		currentNameHierarchy.nameDelimiter = nameHierarchy.nameDelimiter;
+		for (const sourcetrail::NameElement& nameElement: nameHierarchy.nameElements)
+		{
+			currentNameHierarchy.nameElements.push_back(nameElement);
+			size += serializeWithTemporaries(currentNameHierarchy).size();
+		}
+		return size;
+	});
+
+	std::string buffer;
+	measure("reused buffer", nameHierarchies, [&buffer](const sourcetrail::NameHierarchy& nameHierarchy) {
+		size_t size = 0;
+		for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
+		{
+			sourcetrail::serializeNameHierarchyToDatabaseString(nameHierarchy, i + 1, buffer);
+			size += buffer.size();
+		}
+		return size;
+	});
+
+	std::remove(databaseFilePath.c_str());
+	sourcetrail::SourcetrailDBWriter writer;
+	bool success = writer.open(databaseFilePath) && writer.beginTransaction() &&
+		measureWriter("database", nameHierarchies, writer) && writer.commitTransaction() && writer.close();
+	std::remove(databaseFilePath.c_str());
+
+	const std::string ingestLogFilePath = databaseFilePath + ".log";
+	success = success && writer.openIngestLog(ingestLogFilePath) &&
+		measureWriter("ingest log", nameHierarchies, writer) && writer.close();
+	std::remove(ingestLogFilePath.c_str());
+
+	if (!success)
+	{
+		std::cout << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -17,6 +17,8 @@
 #ifndef SOURCETRAIL_DATABASE_STORAGE_H
 #define SOURCETRAIL_DATABASE_STORAGE_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,6 +33,7 @@
 #include "StorageNode.h"
 #include "StorageOccurrence.h"
 #include "StorageSourceLocation.h"
+#include "StorageStatus.h"
 #include "StorageSymbol.h"
 
 namespace sourcetrail
@@ -42,18 +45,73 @@ namespace sourcetrail
  * knows about basic data types, more elaborate types like enums, structs and classes need to be converted to basic
  * types before using this interface.
  */
+class IngestLog;
+class StatisticsCounters;
+class TraceRecorder;
+
 class DatabaseStorage
 {
 public:
 	static int getSupportedDatabaseVersion();
+	static std::string getErrorMessage(const StorageStatus& status);
 	static std::unique_ptr<DatabaseStorage> openDatabase(const std::string& dbFilePath);
+
+	// creates a storage that keeps the database in memory, initialized with the contents of the file if it exists
+	static std::unique_ptr<DatabaseStorage> openInMemoryDatabase(const std::string& dbFilePath);
+
+	// Creates a storage for building a database in a temporary file that starts as a copy of the database file if it
+	// exists. The temporary file is written without journaling, see setJournalingEnabled().
+	static std::unique_ptr<DatabaseStorage> openTemporaryDatabase(
+		const std::string& dbFilePath, const std::string& temporaryFilePath);
+
+	// creates a storage that appends all writes to an ingest log instead of a database, the log is replaced if it
+	// exists and queries are not supported
+	static std::unique_ptr<DatabaseStorage> openIngestLog(const std::string& ingestLogFilePath);
+	// creates a storage that continues an existing ingest log after its last committed file
+	static std::unique_ptr<DatabaseStorage> resumeIngestLog(const std::string& ingestLogFilePath);
 	~DatabaseStorage();
 
 	void setupDatabase();
 	void clearDatabase();
+	// Replaces the database file by an empty database and sets it up, which takes constant time and leaves no unused
+	// pages, unlike clearDatabase(). Falls back to clearDatabase() during a transaction or if the file can't be removed.
+	void recreateDatabase();
 
 	void setProjectSettingsText(const std::string& text);
 
+	bool isIngestLog() const;
+	bool isInMemory() const;
+
+	// number of bytes of all pages of the database
+	size_t getDatabaseSize() const;
+
+	// Replaces the file with a copy of the database, an open transaction is discarded as when closing a database. The
+	// copy is rebuilt without unused pages if vacuum is true.
+	void backupToFile(const std::string& filePath, bool vacuum);
+
+	// Without journaling, the rollback journal is kept in memory and writes are not synced to disk. Transactions can
+	// still be rolled back, but the database file may be corrupt after a crash.
+	void setJournalingEnabled(bool enabled);
+
+	// Gathers the statistics of the query planner about the tables and indices. PRAGMA optimize is run as well, SQLite
+	// versions before 3.18 ignore it.
+	void analyze();
+
+	// inserts the contents of an ingest log into this database, which has to be set up and empty
+	void materializeIngestLog(const std::string& ingestLogFilePath);
+
+	// counters are not owned and may be nullptr
+	void setStatisticsCounters(StatisticsCounters* counters);
+
+	// recorder is not owned and may be nullptr
+	void setTraceRecorder(TraceRecorder* recorder);
+
+	// Stores integer hashes of node names and error messages in extra columns and indexes those instead of the full
+	// text. Takes effect with the next setupDatabase(), which adds the hash columns to an existing database. A database
+	// that already has hash columns always keeps them up to date.
+	void setHashKeysEnabled(bool enabled);
+	bool getHashKeysEnabled() const;
+
 	bool isEmpty() const;
 	bool isCompatible() const;
 	int getLoadedDatabaseVersion() const;
@@ -61,6 +119,9 @@ public:
 	void commitTransaction();
 	void rollbackTransaction();
 	void optimizeDatabaseMemory();
+	// Renumbers the source locations in the order of (file_node_id, start_line), rewrites the occurrences in the same
+	// order and vacuums the database, so the rows of one file are stored next to each other. Element ids don't change.
+	void optimizeDatabaseLocality();
 
 	int addElementComponent(const StorageElementComponentData& storageElementComponentData);
 	int addNode(const StorageNodeData& storageNodeData);
@@ -75,33 +136,79 @@ public:
 	void setNodeType(int nodeId, int nodeKind);
 	void setFileLanguage(int fileId, const std::string& languageIdentifier);
 
+	// Non-throwing variants of the methods above for the frequently called statements. They report SQLite errors by
+	// their status instead of a SourcetrailException, the ingest log may still throw.
+	StorageStatus tryAddNode(const StorageNodeData& storageNodeData, int& id);
+	// takes the name by reference, so callers serializing into a reused buffer don't copy it for each node
+	StorageStatus tryAddNode(int nodeKind, const std::string& serializedName, int& id);
+	StorageStatus tryAddSymbol(const StorageSymbol& storageSymbol);
+	StorageStatus tryAddEdge(const StorageEdgeData& storageEdgeData, int& id);
+	StorageStatus tryAddLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData, int& id);
+	StorageStatus tryAddSourceLocation(const StorageSourceLocationData& storageSourceLocationData, int& id);
+	StorageStatus tryAddOccurrence(const StorageOccurrence& storageOccurrence);
+	StorageStatus trySetNodeType(int nodeId, int nodeKind);
+
+	// the committed files are stored with one row each as part of the current transaction
+	void addCommittedFile(int fileId);
+	std::vector<std::string> getCommittedFilePaths() const;
+
 	template <typename ResultType>
 	std::vector<ResultType> getAll() const
 	{
 		return doGetAll<ResultType>("");
 	}
 
+	void updateNameIndex();
+	std::vector<int> findNodeIdsByNamePrefix(const std::string& prefix, int maxResultCount = 0) const;
+	// Substrings of at least 3 characters are looked up by the trigrams of the indexed names, shorter substrings are
+	// searched by scanning all indexed names. Indices built without trigrams need to be updated first.
+	std::vector<int> findNodeIdsByNameSubstring(const std::string& substring, int maxResultCount = 0) const;
+
+	void updateLocationIndex();
+	std::vector<StorageSourceLocation> getLocationsAt(int fileId, int line, int column) const;
+
+	void forEachNode(const std::function<void(int nodeId, int nodeKind, const char* serializedName, size_t serializedNameSize)>& callback) const;
+	void forEachNodeKind(const std::function<void(int nodeId, int nodeKind)>& callback) const;
+	void forEachEdge(const std::function<void(int edgeId, int sourceNodeId, int targetNodeId, int edgeKind)>& callback) const;
+
 private:
 	DatabaseStorage() = default;
 
 	void setupTables();
 	void clearTables();
 	void setupIndices();
+	void dropIndices();
+	void setupHashKeys();
+	bool hasColumn(const std::string& tableName, const std::string& columnName) const;
 	void setupPrecompiledStatements();
 	void clearPrecompiledStatements();
 
 	int insertElement();
+	StorageStatus tryInsertElement(int& id);
 	void insertOrUpdateMetaValue(const std::string& key, const std::string& value);
 	CppSQLite3Statement compileStatement(const std::string& statement) const;
 	void executeStatement(const std::string& statement) const;
-	void executeStatement(CppSQLite3Statement& statement) const;
+	int executeStatement(CppSQLite3Statement& statement) const;
 	CppSQLite3Query executeQuery(const std::string& query) const;
 	CppSQLite3Query executeQuery(CppSQLite3Statement& statement) const;
+	StorageStatus tryExecuteStatement(
+		CppSQLite3Statement& statement, StorageStatement statementKind, int* changedRowCount = nullptr) const;
+	StorageStatus tryFindId(CppSQLite3Statement& statement, StorageStatement statementKind, int& id) const;
+	static void throwIfFailed(const StorageStatus& status);
 
 	template <typename ResultType>
 	std::vector<ResultType> doGetAll(const std::string& query) const;
 
 	mutable CppSQLite3DB m_database;
+	std::unique_ptr<IngestLog> m_ingestLog;
+	StatisticsCounters* m_statistics = nullptr;
+	TraceRecorder* m_trace = nullptr;
+	uint64_t m_transactionStartNanoseconds = 0;
+	bool m_transactionActive = false;
+	bool m_hashKeysEnabled = false;
+	bool m_inMemory = false;
+	bool m_journalingEnabled = true;
+	std::string m_databaseFilePath;
 
 	CppSQLite3Statement m_insertElementStatement;
 	CppSQLite3Statement m_insertElementComponentStatement;
@@ -123,6 +230,7 @@ private:
 	CppSQLite3Statement m_findErrorStatement;
 	CppSQLite3Statement m_insertErrorStatement;
 	CppSQLite3Statement m_insertOrUpdateMetaValueStmt;
+	CppSQLite3Statement m_insertCommittedFileStmt;
 };
 
 template <>
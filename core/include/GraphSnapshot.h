@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_GRAPH_SNAPSHOT_H
+#define SOURCETRAIL_GRAPH_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sourcetrail
+{
+class DatabaseStorage;
+class MemoryMappedFile;
+
+/**
+ * GraphSnapshot
+ *
+ * Read-only adjacency representation of the node and edge tables of a Sourcetrail database, intended for whole
+ * graph analyses like reachability or fan-in ranking.
+ *
+ * Nodes are renumbered to dense indices [0, getNodeCount()) in ascending order of their database ids. Outgoing
+ * edges are stored in compressed sparse row format: the edges of the node at index i are found at the edge indices
+ * [getOffsets()[i], getOffsets()[i + 1]) of the getTargets(), getEdgeKinds() and getEdgeIds() arrays. Edge targets
+ * are dense node indices as well.
+ *
+ * A snapshot can be saved to disk and loaded again later. Loading memory maps the file, so no parsing or copying
+ * takes place. Snapshot files use the byte order of the machine that wrote them.
+ *
+ * The following code snippet illustrates a basic usage of the GraphSnapshot class:
+ *
+ *   std::unique_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase("MyProject.srctrldb");
+ *   GraphSnapshot::create(*storage)->save("MyProject.srctrlgraph");
+ *   ...
+ *   std::unique_ptr<GraphSnapshot> snapshot = GraphSnapshot::load("MyProject.srctrlgraph");
+ *   for (int i = 0; i < snapshot->getNodeCount(); i++)
+ *   {
+ *     const int fanOut = snapshot->getOffsets()[i + 1] - snapshot->getOffsets()[i];
+ *   }
+ */
+class GraphSnapshot
+{
+public:
+	/**
+	 * Builds a snapshot from the node and edge tables with one sequential pass over each table
+	 *
+	 *  throws: SourcetrailException if the tables cannot be read or an edge references an unknown node
+	 */
+	static std::unique_ptr<GraphSnapshot> create(const DatabaseStorage& storage);
+
+	/**
+	 * Memory maps a snapshot file that has been written by save()
+	 *
+	 *  throws: SourcetrailException if the file cannot be mapped or is not a valid snapshot file
+	 */
+	static std::unique_ptr<GraphSnapshot> load(const std::string& filePath);
+
+	~GraphSnapshot();
+
+	/**
+	 * Writes the snapshot to disk
+	 *
+	 *  throws: SourcetrailException if the file cannot be written
+	 */
+	void save(const std::string& filePath) const;
+
+	int getNodeCount() const;
+	int getEdgeCount() const;
+
+	/**
+	 * Provides the dense index of a node
+	 *
+	 *  return: index of the node with the given database id. -1 if the snapshot does not contain the node.
+	 */
+	int getNodeIndex(int nodeId) const;
+	int getNodeId(int nodeIndex) const;
+	int getNodeKind(int nodeIndex) const;
+
+	const int32_t* getNodeIds() const;
+	const int32_t* getNodeKinds() const;
+	const int32_t* getOffsets() const;
+	const int32_t* getTargets() const;
+	const int32_t* getEdgeKinds() const;
+	const int32_t* getEdgeIds() const;
+
+private:
+	GraphSnapshot();
+	GraphSnapshot(const GraphSnapshot&) = delete;
+	GraphSnapshot& operator=(const GraphSnapshot&) = delete;
+
+	void assignArrays(const int32_t* words, size_t wordCount);
+	// checks that the node ids are ascending and that the offsets and targets only refer to existing edges and nodes,
+	// so that the accessors cannot read outside of a corrupt file
+	bool hasConsistentArrays() const;
+
+	std::vector<int32_t> m_buffer;
+	std::unique_ptr<MemoryMappedFile> m_mappedFile;
+
+	const int32_t* m_words;
+	size_t m_wordCount;
+	int m_nodeCount;
+	int m_edgeCount;
+	const int32_t* m_nodeIds;
+	const int32_t* m_nodeKinds;
+	const int32_t* m_offsets;
+	const int32_t* m_targets;
+	const int32_t* m_edgeKinds;
+	const int32_t* m_edgeIds;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_GRAPH_SNAPSHOT_H
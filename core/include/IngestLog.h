@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_INGEST_LOG_H
+#define SOURCETRAIL_INGEST_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "StorageEdge.h"
+#include "StorageElementComponent.h"
+#include "StorageError.h"
+#include "StorageFile.h"
+#include "StorageLocalSymbol.h"
+#include "StorageNode.h"
+#include "StorageOccurrence.h"
+#include "StorageSourceLocation.h"
+#include "StorageSymbol.h"
+
+namespace sourcetrail
+{
+class MemoryMappedFile;
+
+/**
+ * INTERNAL: Struct holding the normalized contents of an ingest log, ready to be inserted into a database.
+ *
+ * Duplicate source locations are merged, occurrences refer to the merged source locations and are unique, and
+ * the node kinds and file languages contain the last recorded values.
+ */
+struct IngestLogContents
+{
+	// ids of all nodes, edges, local symbols and errors in ascending order
+	std::vector<int> elementIds;
+	std::vector<StorageNode> nodes;
+	std::vector<StorageSymbol> symbols;
+	std::vector<StorageFile> files;
+	std::vector<StorageEdge> edges;
+	std::vector<StorageLocalSymbol> localSymbols;
+	std::vector<StorageSourceLocation> sourceLocations;
+	std::vector<StorageOccurrence> occurrences;
+	std::vector<StorageError> errors;
+	std::vector<StorageElementComponentData> elementComponents;
+	// ids of the files that were marked as committed in ascending order
+	std::vector<int> committedFileIds;
+};
+
+/**
+ * INTERNAL: Class appending the write operations of the DatabaseStorage to a memory mapped log file.
+ *
+ * The log assigns the ids that the database would assign to an empty database. Elements that are looked up by
+ * value (nodes, edges, local symbols, errors and files) are deduplicated in memory, so the same values receive the
+ * same id. Source locations and occurrences are only deduplicated by load(), which sorts them. The file contents are
+ * read when the log is loaded, not when the file is recorded.
+ *
+ * Marking a file as committed flushes the log to disk. After a crash, resume() continues the log after the last
+ * committed file and discards the records that were written afterwards.
+ *
+ * The log is written in the native byte order and is meant to be loaded on the machine that wrote it.
+ */
+class IngestLog
+{
+public:
+	// throws SourcetrailException if the log file cannot be created
+	static std::unique_ptr<IngestLog> create(const std::string& filePath);
+
+	// throws SourcetrailException if the file is no ingest log or is damaged
+	static IngestLogContents load(const std::string& filePath);
+
+	// opens an existing log, discards all records after the last committed file and restores the assigned ids of the
+	// remaining records, throws SourcetrailException if the file is no ingest log
+	static std::unique_ptr<IngestLog> resume(const std::string& filePath);
+
+	~IngestLog();
+
+	bool isEmpty() const;
+	void clear();
+
+	int addElementComponent(const StorageElementComponentData& storageElementComponentData);
+	int addNode(const StorageNodeData& storageNodeData);
+	int addNode(int nodeKind, const std::string& serializedName);
+	void addSymbol(const StorageSymbol& storageSymbol);
+	void addFile(const StorageFile& storageFile);
+	int addEdge(const StorageEdgeData& storageEdgeData);
+	int addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData);
+	int addSourceLocation(const StorageSourceLocationData& storageSourceLocationData);
+	void addOccurrence(const StorageOccurrence& storageOccurrence);
+	int addError(const StorageErrorData& storageErrorData);
+
+	void setNodeType(int nodeId, int nodeKind);
+	void setFileLanguage(int fileId, const std::string& languageIdentifier);
+
+	void addCommittedFile(int fileId);
+	std::vector<std::string> getCommittedFilePaths() const;
+
+private:
+	struct EdgeKey
+	{
+		bool operator==(const EdgeKey& other) const;
+
+		int sourceNodeId;
+		int targetNodeId;
+		int edgeKind;
+	};
+
+	struct EdgeKeyHash
+	{
+		size_t operator()(const EdgeKey& key) const;
+	};
+
+	IngestLog();
+	IngestLog(const IngestLog&) = delete;
+	IngestLog& operator=(const IngestLog&) = delete;
+
+	void writeRecord(
+		uint8_t recordKind, std::initializer_list<int> values, std::initializer_list<const std::string*> texts = {});
+
+	std::unique_ptr<MemoryMappedFile> m_file;
+	size_t m_usedSize;
+
+	int m_nextElementId;
+	int m_nextSourceLocationId;
+	int m_nextElementComponentId;
+	std::unordered_map<std::string, int> m_nodeIds;
+	std::unordered_map<EdgeKey, int, EdgeKeyHash> m_edgeIds;
+	std::unordered_map<std::string, int> m_localSymbolIds;
+	std::unordered_map<std::string, int> m_errorIds;
+	std::unordered_map<int, std::string> m_filePaths;
+	std::set<int> m_committedFileIds;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_INGEST_LOG_H
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_MEMORY_MAPPED_FILE_H
+#define SOURCETRAIL_MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace sourcetrail
+{
+/**
+ * INTERNAL: Class providing access to the contents of a file mapped into memory.
+ *
+ * The mapping stays valid for the lifetime of the MemoryMappedFile object or until the next call to resize().
+ */
+class MemoryMappedFile
+{
+public:
+	static std::unique_ptr<MemoryMappedFile> openReadOnly(const std::string& filePath);
+	// creates an empty file or truncates an existing one
+	static std::unique_ptr<MemoryMappedFile> createWritable(const std::string& filePath);
+	// opens an existing file for writing without changing its contents
+	static std::unique_ptr<MemoryMappedFile> openWritable(const std::string& filePath);
+	~MemoryMappedFile();
+
+	const char* getData() const;
+	// nullptr if the file is read-only or empty
+	char* getWritableData();
+	size_t getSize() const;
+
+	// changes the file size and remaps it, which invalidates pointers into the old mapping. Only for writable files.
+	void resize(size_t size);
+
+	// writes the modified pages to disk and waits until they are written
+	void flush();
+
+private:
+	MemoryMappedFile();
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	void map();
+	void unmap();
+
+	std::string m_filePath;
+	char* m_data;
+	size_t m_size;
+	bool m_writable;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_MEMORY_MAPPED_FILE_H
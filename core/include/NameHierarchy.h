@@ -17,6 +17,7 @@
 #ifndef SOURCETRAIL_NAME_HIERARCHY_H
 #define SOURCETRAIL_NAME_HIERARCHY_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -93,6 +94,71 @@ NameHierarchy deserializeNameHierarchyFromJson(const std::string& serializedName
  * INTERNAL: Converts a NameHierarchy to a string in Sourcetrail database format
  */
 std::string serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy);
+
+/**
+ * INTERNAL: Converts the first elements of a NameHierarchy to a string in Sourcetrail database format
+ *
+ * The string is cleared first and its capacity is reserved for the exact size of the result, so reusing it for
+ * multiple calls avoids allocations once its capacity suffices.
+ *
+ *  param: nameHierarchy - the name hierarchy to convert
+ *  param: elementCount - number of leading name elements to convert, e.g. 1 for the outermost parent
+ *  param: serialized - set to the converted string
+ */
+void serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy, size_t elementCount, std::string& serialized);
+
+/**
+ * Non-owning reference to a range of characters, e.g. inside of a database row.
+ */
+struct StringRef
+{
+	std::string toString() const
+	{
+		return std::string(data, size);
+	}
+
+	const char* data;
+	size_t size;
+};
+
+/**
+ * Non-owning counterpart of NameElement with all parts referencing the parsed database string.
+ */
+struct NameElementRef
+{
+	StringRef prefix;
+	StringRef name;
+	StringRef postfix;
+};
+
+/**
+ * Parses a string in Sourcetrail database format without copying any characters
+ *
+ * All parts of the result reference the passed characters and are only valid as long as these are. The vector of
+ * name elements is cleared first, so reusing it for multiple calls avoids allocations once its capacity suffices.
+ *
+ *  param: data - serialized name as stored in the "serialized_name" column of the "node" table
+ *  param: size - number of characters of data
+ *  param: nameDelimiter - set to the name delimiter of the hierarchy
+ *  param: nameElements - filled with all name elements of the hierarchy, empty for a hierarchy without elements
+ *
+ *  return: true if successful. false if the string is not in database format.
+ *
+ *  see: deserializeNameHierarchyFromDatabaseString(const std::string& serializedName, std::string* error)
+ */
+bool parseNameHierarchyDatabaseString(const char* data, size_t size, StringRef& nameDelimiter, std::vector<NameElementRef>& nameElements);
+
+/**
+ * Converts a string in Sourcetrail database format to a NameHierarchy
+ *
+ *  param: serializedName - serialized name as stored in the "serialized_name" column of the "node" table
+ *  param: error - optional pointer to a string, where an error message will be set
+ *
+ *  return: NameHierarchy object. Empty on failure.
+ *
+ *  see: serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy)
+ */
+NameHierarchy deserializeNameHierarchyFromDatabaseString(const std::string& serializedName, std::string* error = nullptr);
 }	 // namespace sourcetrail
 
 #endif	  // SOURCETRAIL_NAME_HIERARCHY_H
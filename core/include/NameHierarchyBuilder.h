@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
+#define SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NameHierarchy.h"
+
+namespace sourcetrail
+{
+/**
+ * INTERNAL: Class storing each distinct string once in large blocks of memory and identifying it by an id.
+ *
+ * Ids are assigned in ascending order starting at 0 and the strings are never released, so the references returned by
+ * getString() stay valid for the lifetime of the pool.
+ */
+class NameStringPool
+{
+public:
+	NameStringPool();
+
+	uint32_t intern(const char* data, size_t size);
+	StringRef getString(uint32_t id) const;
+	size_t getStringCount() const;
+
+private:
+	struct StringRefHash
+	{
+		size_t operator()(const StringRef& s) const;
+	};
+
+	struct StringRefEqual
+	{
+		bool operator()(const StringRef& a, const StringRef& b) const;
+	};
+
+	NameStringPool(const NameStringPool&) = delete;
+	NameStringPool& operator=(const NameStringPool&) = delete;
+
+	const char* allocate(const char* data, size_t size);
+
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	char* m_currentBlock;
+	size_t m_blockUsedSize;
+	std::vector<StringRef> m_strings;
+	std::unordered_map<StringRef, uint32_t, StringRefHash, StringRefEqual> m_ids;
+};
+
+/**
+ * Class for building the name of a symbol without allocating memory for each recorded symbol
+ *
+ * The builder stores the prefix, name and postfix of each element as id of an interned string. Removing elements and
+ * clearing the builder keeps the allocated memory, so a builder that is reused for all symbols of an indexer only
+ * allocates memory for strings it has not seen before.
+ *
+ * Builders created by SourcetrailDBWriter::createNameHierarchyBuilder() share the string pool of the writer, which
+ * allows the writer to look up the ids of already recorded symbols without accessing the database.
+ *
+ * Example:
+ *    NameHierarchyBuilder builder = writer.createNameHierarchyBuilder("::");
+ *    builder.pushElement("", "Foo", "");
+ *    builder.pushElement("void", "bar", "()");
+ *    int barId = writer.recordSymbol(builder);
+ *    builder.popElement();
+ *    builder.pushElement("int", "baz", "()");
+ *    int bazId = writer.recordSymbol(builder);
+ */
+class NameHierarchyBuilder
+{
+public:
+	// creates a builder with a string pool of its own
+	explicit NameHierarchyBuilder(const std::string& nameDelimiter = "::");
+
+	void setNameDelimiter(const std::string& nameDelimiter);
+
+	void pushElement(const std::string& prefix, const std::string& name, const std::string& postfix);
+	void pushElement(const char* prefix, const char* name, const char* postfix);
+	void popElement();
+
+	// removes all elements and keeps the name delimiter
+	void clear();
+
+	size_t getElementCount() const;
+
+	NameHierarchy toNameHierarchy() const;
+
+	/**
+	 * INTERNAL: Appends the database string of the first elementCount elements to a string that contains the database
+	 * string of the first elementCount - 1 elements (or is empty if elementCount is 1)
+	 */
+	void appendToDatabaseString(size_t elementCount, std::string& serializedName) const;
+
+private:
+	friend class SourcetrailDBWriter;
+
+	struct Element
+	{
+		uint32_t prefixId;
+		uint32_t nameId;
+		uint32_t postfixId;
+	};
+
+	NameHierarchyBuilder(std::shared_ptr<NameStringPool> pool, const std::string& nameDelimiter);
+
+	void append(std::string& s, uint32_t id) const;
+
+	std::shared_ptr<NameStringPool> m_pool;
+	uint32_t m_nameDelimiterId;
+	std::vector<Element> m_elements;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_OPERATION_JOURNAL_H
+#define SOURCETRAIL_OPERATION_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NameHierarchy.h"
+#include "SourceRange.h"
+
+namespace sourcetrail
+{
+class SourcetrailDBWriter;
+
+/**
+ * Enum of the SourcetrailDBWriter calls that are stored in an operation journal.
+ *
+ * The values are part of the journal file format, so new operations have to be appended.
+ */
+enum class JournalOperation : uint8_t
+{
+	OPEN = 1,
+	CLOSE = 2,
+	CLEAR = 3,
+	BEGIN_TRANSACTION = 4,
+	COMMIT_TRANSACTION = 5,
+	ROLLBACK_TRANSACTION = 6,
+	OPTIMIZE_DATABASE_MEMORY = 7,
+	SET_NAME_INDEX_ENABLED = 8,
+	UPDATE_NAME_INDEX = 9,
+	SET_LOCATION_INDEX_ENABLED = 10,
+	UPDATE_LOCATION_INDEX = 11,
+	RECORD_SYMBOL = 12,
+	RECORD_SYMBOL_DEFINITION_KIND = 13,
+	RECORD_SYMBOL_KIND = 14,
+	RECORD_SYMBOL_LOCATION = 15,
+	RECORD_SYMBOL_LOCATIONS = 16,
+	RECORD_SYMBOL_SCOPE_LOCATION = 17,
+	RECORD_SYMBOL_SIGNATURE_LOCATION = 18,
+	RECORD_REFERENCE = 19,
+	RECORD_REFERENCES = 20,
+	RECORD_REFERENCE_LOCATION = 21,
+	RECORD_REFERENCE_LOCATIONS = 22,
+	RECORD_REFERENCE_IS_AMBIGUOUS = 23,
+	RECORD_REFERENCE_TO_UNSOLVED_SYMBOL = 24,
+	RECORD_QUALIFIER_LOCATION = 25,
+	RECORD_FILE = 26,
+	RECORD_FILE_LANGUAGE = 27,
+	RECORD_LOCAL_SYMBOL = 28,
+	RECORD_LOCAL_SYMBOL_LOCATION = 29,
+	RECORD_ATOMIC_SOURCE_RANGE = 30,
+	RECORD_ERROR = 31,
+	OPEN_INGEST_LOG = 32,
+	MATERIALIZE_INGEST_LOG = 33,
+	RESUME_INGEST_LOG = 34,
+	RECORD_FILE_COMMITTED = 35,
+	SET_HASH_KEYS_ENABLED = 36,
+	OPEN_IN_MEMORY = 37,
+	SET_ATOMIC_BUILD_ENABLED = 38,
+	SET_RECREATE_ON_CLEAR_ENABLED = 39,
+	ANALYZE_DATABASE = 40,
+	SET_ANALYZE_ON_CLOSE_ENABLED = 41,
+	OPTIMIZE_DATABASE_LOCALITY = 42
+};
+
+/**
+ * INTERNAL: Class writing the calls of a SourcetrailDBWriter to a binary journal file.
+ *
+ * Each call is stored as one entry consisting of the operation, its arguments and, for calls that create elements,
+ * the returned ids. Integers are stored as zigzag encoded varints and strings with a varint length prefix. If the
+ * journal is anonymized, every symbol name, file path, local symbol name and error message is replaced by a token of
+ * the same length that is unique for each distinct string. Kinds, ranges and the structure of names are kept, so a
+ * replay still exercises the same deduplication and table sizes.
+ *
+ * The content of recorded files is not stored. A replay reads the files from disk if they exist at the journaled path.
+ */
+class OperationJournal
+{
+public:
+	/**
+	 * Collects one journal entry and appends it to the journal on destruction. Does nothing if the journal is nullptr.
+	 */
+	class Entry
+	{
+	public:
+		Entry(OperationJournal* journal, JournalOperation operation);
+		~Entry();
+
+		void addInt(int value);
+		void addString(const std::string& value);
+		// anonymized if the journal is anonymized
+		void addName(const std::string& value);
+		void addNameHierarchy(const NameHierarchy& nameHierarchy);
+		void addSourceRange(const SourceRange& sourceRange);
+		void addRows(const int* values, size_t valueCount);
+
+		int setResultId(int id);
+		void setResultIds(const int* ids, size_t idCount);
+
+	private:
+		Entry(const Entry&) = delete;
+		Entry& operator=(const Entry&) = delete;
+
+		OperationJournal* m_journal;
+		JournalOperation m_operation;
+		std::string m_data;
+		bool m_hasResult;
+	};
+
+	// throws SourcetrailException if the journal file cannot be created
+	OperationJournal(const std::string& journalFilePath, bool anonymize);
+	~OperationJournal();
+
+private:
+	OperationJournal(const OperationJournal&) = delete;
+	OperationJournal& operator=(const OperationJournal&) = delete;
+
+	const std::string& anonymize(const std::string& value);
+	void append(const std::string& data);
+	void flush();
+
+	std::ofstream m_file;
+	std::string m_buffer;
+	const bool m_anonymize;
+	std::unordered_map<std::string, std::string> m_anonymizedStrings;
+};
+
+/**
+ * INTERNAL: Class reading the entries of an operation journal that has been loaded into memory.
+ *
+ * All read methods throw a SourcetrailException if the journal ends unexpectedly.
+ */
+class OperationJournalReader
+{
+public:
+	// throws SourcetrailException if the file cannot be read or is no operation journal
+	explicit OperationJournalReader(const std::string& journalFilePath);
+
+	size_t getByteCount() const;
+
+	// returns false at the end of the journal
+	bool readOperation(JournalOperation& operation);
+
+	int readInt();
+	std::string readString();
+	NameHierarchy readNameHierarchy();
+	SourceRange readSourceRange();
+	std::vector<int> readRows();
+
+private:
+	uint32_t readVarint();
+
+	std::string m_data;
+	size_t m_position;
+};
+
+struct OperationJournalReplayResult
+{
+	size_t operationCount = 0;
+	size_t failedOperationCount = 0;
+	std::string firstError;
+};
+
+/**
+ * INTERNAL: Replays all entries of a journal against a writer.
+ *
+ * Journaled open() calls open databaseFilePath instead of the original database, journaled openIngestLog(),
+ * materializeIngestLog() and resumeIngestLog() calls use databaseFilePath + ".log" instead of the original ingest
+ * log. Ids returned during the replay are mapped to the journaled ids, so the replay does not depend on the ids being
+ * identical.
+ */
+OperationJournalReplayResult replayOperationJournal(
+	OperationJournalReader& reader, const std::string& databaseFilePath, SourcetrailDBWriter& writer);
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_OPERATION_JOURNAL_H
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_SRCTRLDB_C_H
+#define SOURCETRAIL_SRCTRLDB_C_H
+
+#include <stddef.h>
+
+/**
+ * SourcetrailDB C interface
+ *
+ * Plain C version of the SourcetrailDBWriter interface for languages that call into native code through a C foreign
+ * function interface (e.g. Rust or Go).
+ *
+ *  - Writers are opaque handles created by srctrl_writer_create() and released by srctrl_writer_destroy(). Each
+ *    handle can be used from its own thread, but a single handle must not be used by multiple threads at once.
+ *  - Strings are passed as pointer and length and don't need to be null terminated.
+ *  - All functions that can fail return one of the srctrl_status codes. Ids are returned through out parameters.
+ *    If SRCTRL_ERROR is returned, srctrl_writer_get_last_error() provides the error message.
+ *  - Kinds are passed as the integer values of srctrl_symbol_kind, srctrl_definition_kind and
+ *    srctrl_reference_kind, which match the values of the C++ enums.
+ *  - The batch functions record whole arrays of rows in one call. They stop at the first failing row.
+ *
+ * The following code snippet illustrates a basic usage of the C interface:
+ *
+ *   srctrl_writer* writer = srctrl_writer_create();
+ *   srctrl_open(writer, "MyProject.srctrldb", 18);
+ *   srctrl_name_element element = { { "void", 4 }, { "foo", 3 }, { "()", 2 } };
+ *   srctrl_symbol symbol = { { "::", 2 }, &element, 1 };
+ *   int symbolId = 0;
+ *   srctrl_record_symbol(writer, &symbol, &symbolId);
+ *   srctrl_close(writer);
+ *   srctrl_writer_destroy(writer);
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+enum srctrl_status
+{
+	SRCTRL_OK = 0,
+	SRCTRL_ERROR = 1,
+	SRCTRL_ERROR_INVALID_ARGUMENT = 2,
+	SRCTRL_ERROR_OUT_OF_MEMORY = 3
+};
+
+enum srctrl_definition_kind
+{
+	SRCTRL_DEFINITION_IMPLICIT = 1,
+	SRCTRL_DEFINITION_EXPLICIT = 2
+};
+
+enum srctrl_symbol_kind
+{
+	SRCTRL_SYMBOL_TYPE = 0,
+	SRCTRL_SYMBOL_BUILTIN_TYPE = 1,
+	SRCTRL_SYMBOL_MODULE = 2,
+	SRCTRL_SYMBOL_NAMESPACE = 3,
+	SRCTRL_SYMBOL_PACKAGE = 4,
+	SRCTRL_SYMBOL_STRUCT = 5,
+	SRCTRL_SYMBOL_CLASS = 6,
+	SRCTRL_SYMBOL_INTERFACE = 7,
+	SRCTRL_SYMBOL_ANNOTATION = 8,
+	SRCTRL_SYMBOL_GLOBAL_VARIABLE = 9,
+	SRCTRL_SYMBOL_FIELD = 10,
+	SRCTRL_SYMBOL_FUNCTION = 11,
+	SRCTRL_SYMBOL_METHOD = 12,
+	SRCTRL_SYMBOL_ENUM = 13,
+	SRCTRL_SYMBOL_ENUM_CONSTANT = 14,
+	SRCTRL_SYMBOL_TYPEDEF = 15,
+	SRCTRL_SYMBOL_TYPE_PARAMETER = 16,
+	SRCTRL_SYMBOL_MACRO = 17,
+	SRCTRL_SYMBOL_UNION = 18
+};
+
+enum srctrl_reference_kind
+{
+	SRCTRL_REFERENCE_TYPE_USAGE = 0,
+	SRCTRL_REFERENCE_USAGE = 1,
+	SRCTRL_REFERENCE_CALL = 2,
+	SRCTRL_REFERENCE_INHERITANCE = 3,
+	SRCTRL_REFERENCE_OVERRIDE = 4,
+	SRCTRL_REFERENCE_TYPE_ARGUMENT = 5,
+	SRCTRL_REFERENCE_TEMPLATE_SPECIALIZATION = 6,
+	SRCTRL_REFERENCE_INCLUDE = 7,
+	SRCTRL_REFERENCE_IMPORT = 8,
+	SRCTRL_REFERENCE_MACRO_USAGE = 9,
+	SRCTRL_REFERENCE_ANNOTATION_USAGE = 10
+};
+
+typedef struct srctrl_writer srctrl_writer;
+
+typedef struct srctrl_string
+{
+	const char* data;
+	size_t length;
+} srctrl_string;
+
+typedef struct srctrl_name_element
+{
+	srctrl_string prefix;
+	srctrl_string name;
+	srctrl_string postfix;
+} srctrl_name_element;
+
+typedef struct srctrl_symbol
+{
+	srctrl_string nameDelimiter;
+	const srctrl_name_element* nameElements;
+	size_t nameElementCount;
+} srctrl_symbol;
+
+/**
+ * Provides the version string of the SourcetrailDB Core. The string is owned by the library and stays valid.
+ */
+void srctrl_get_version_string(const char** version, size_t* versionLength);
+int srctrl_get_supported_database_version(void);
+
+/**
+ * Creates a new writer
+ *
+ *  return: handle of the writer or NULL if it cannot be allocated.
+ */
+srctrl_writer* srctrl_writer_create(void);
+
+/**
+ * Releases a writer. The database gets closed and uncommitted changes are discarded. Passing NULL is allowed.
+ */
+void srctrl_writer_destroy(srctrl_writer* writer);
+
+/**
+ * Provides the message of the last error that occurred on this writer. The message is owned by the writer and stays
+ * valid until the next call using the same writer.
+ */
+int srctrl_writer_get_last_error(srctrl_writer* writer, const char** message, size_t* messageLength);
+int srctrl_writer_clear_last_error(srctrl_writer* writer);
+
+int srctrl_open(srctrl_writer* writer, const char* databaseFilePath, size_t databaseFilePathLength);
+int srctrl_close(srctrl_writer* writer);
+int srctrl_clear(srctrl_writer* writer);
+int srctrl_is_empty(srctrl_writer* writer, int* isEmpty);
+int srctrl_is_compatible(srctrl_writer* writer, int* isCompatible);
+int srctrl_get_loaded_database_version(srctrl_writer* writer, int* databaseVersion);
+int srctrl_begin_transaction(srctrl_writer* writer);
+int srctrl_commit_transaction(srctrl_writer* writer);
+int srctrl_rollback_transaction(srctrl_writer* writer);
+int srctrl_optimize_database_memory(srctrl_writer* writer);
+
+int srctrl_record_symbol(srctrl_writer* writer, const srctrl_symbol* symbol, int* symbolId);
+int srctrl_record_symbol_definition_kind(srctrl_writer* writer, int symbolId, int definitionKind);
+int srctrl_record_symbol_kind(srctrl_writer* writer, int symbolId, int symbolKind);
+int srctrl_record_symbol_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+int srctrl_record_symbol_scope_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+int srctrl_record_symbol_signature_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+int srctrl_record_reference(
+	srctrl_writer* writer, int contextSymbolId, int referencedSymbolId, int referenceKind, int* referenceId);
+int srctrl_record_reference_location(
+	srctrl_writer* writer, int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+int srctrl_record_reference_is_ambiguous(srctrl_writer* writer, int referenceId);
+int srctrl_record_reference_to_unsolved_symbol(
+	srctrl_writer* writer,
+	int contextSymbolId,
+	int referenceKind,
+	int fileId,
+	int startLine,
+	int startColumn,
+	int endLine,
+	int endColumn,
+	int* referenceId);
+int srctrl_record_qualifier_location(
+	srctrl_writer* writer, int referencedSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+int srctrl_record_file(srctrl_writer* writer, const char* filePath, size_t filePathLength, int* fileId);
+int srctrl_record_file_language(
+	srctrl_writer* writer, int fileId, const char* languageIdentifier, size_t languageIdentifierLength);
+
+int srctrl_record_local_symbol(srctrl_writer* writer, const char* name, size_t nameLength, int* localSymbolId);
+int srctrl_record_local_symbol_location(
+	srctrl_writer* writer, int localSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+int srctrl_record_atomic_source_range(
+	srctrl_writer* writer, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+int srctrl_record_error(
+	srctrl_writer* writer,
+	const char* message,
+	size_t messageLength,
+	int fatal,
+	int fileId,
+	int startLine,
+	int startColumn,
+	int endLine,
+	int endColumn);
+
+/**
+ * Batch functions
+ *
+ *  - srctrl_record_symbols: records symbolCount symbols and writes their ids to symbolIds.
+ *  - srctrl_record_symbol_locations / srctrl_record_reference_locations: rows of 6 integers consisting of the
+ *    symbol or reference id, fileId, startLine, startColumn, endLine and endColumn.
+ *  - srctrl_record_references: rows of 3 integers consisting of contextSymbolId, referencedSymbolId and
+ *    referenceKind. The ids of the references are written to referenceIds.
+ */
+int srctrl_record_symbols(srctrl_writer* writer, const srctrl_symbol* symbols, size_t symbolCount, int* symbolIds);
+int srctrl_record_symbol_locations(srctrl_writer* writer, const int* rows, size_t rowCount);
+int srctrl_record_references(srctrl_writer* writer, const int* rows, size_t rowCount, int* referenceIds);
+int srctrl_record_reference_locations(srctrl_writer* writer, const int* rows, size_t rowCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOURCETRAIL_SRCTRLDB_C_H */
@@ -17,21 +17,31 @@
 #ifndef SOURCETRAIL_SRCTRLDB_WRITER_H
 #define SOURCETRAIL_SRCTRLDB_WRITER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "DefinitionKind.h"
 #include "EdgeKind.h"
 #include "ElementComponentKind.h"
 #include "LocationKind.h"
 #include "NameHierarchy.h"
+#include "NameHierarchyBuilder.h"
 #include "ReferenceKind.h"
 #include "SourceRange.h"
+#include "StorageStatus.h"
 #include "SymbolKind.h"
+#include "WriterStatistics.h"
 
 namespace sourcetrail
 {
 class DatabaseStorage;
+class OperationJournal;
+class StatisticsCounters;
+class TraceRecorder;
 
 /**
  * SourcetrailDBWriter
@@ -127,6 +137,71 @@ public:
 	 */
 	bool close();
 
+	/**
+	 * Opens an append-only ingest log instead of a Sourcetrail database
+	 *
+	 * While an ingest log is open, all recorded data is appended to a memory mapped log file instead of being
+	 * inserted into a database. The ids are assigned in memory and symbols, references, files, local symbols and
+	 * errors are deduplicated in memory, so the returned ids are the ones that materializeIngestLog() writes to the
+	 * database. Transactions are not needed and rollbackTransaction(), updateNameIndex() and updateLocationIndex()
+	 * fail. Call close() to finish the log before materializing it.
+	 *
+	 *  param: ingestLogFilePath - path of the ingest log file. An existing file is overwritten.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: materializeIngestLog(const std::string& ingestLogFilePath)
+	 */
+	bool openIngestLog(const std::string& ingestLogFilePath);
+
+	/**
+	 * Opens a Sourcetrail database that is kept in memory and written to the database file by close()
+	 *
+	 * This is meant for building a database once, e.g. on a CI server. If the database file exists, its contents are
+	 * loaded into memory first. While recording, no data is written to disk. close() copies the database to the file
+	 * with the SQLite online backup API. If the size of the database exceeds the memory limit after committing a
+	 * transaction, the database is copied to the file at that point and recording continues on disk as after open().
+	 *
+	 *  param: databaseFilePath - absolute file path of the database file written by close()
+	 *  param: memoryLimit - number of bytes the in-memory database may use. 0 for no limit.
+	 *  param: vacuum - if true, close() rebuilds the written file without unused pages, like optimizeDatabaseMemory()
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: open(const std::string& databaseFilePath)
+	 */
+	bool openInMemory(const std::string& databaseFilePath, size_t memoryLimit = 0, bool vacuum = false);
+
+	/**
+	 * Writes the contents of an ingest log into the currently open database
+	 *
+	 * Duplicate source locations are merged and all rows are inserted with their final ids in one transaction,
+	 * before the lookup indices of the database are created. The content of the recorded files is read during this
+	 * call. The open database has to be empty, e.g. after opening a new database file or calling clear().
+	 *
+	 *  param: ingestLogFilePath - path of an ingest log that was written with openIngestLog() and closed
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: openIngestLog(const std::string& ingestLogFilePath)
+	 */
+	bool materializeIngestLog(const std::string& ingestLogFilePath);
+
+	/**
+	 * Continues an ingest log that has not been materialized yet, e.g. after the indexer crashed
+	 *
+	 * All records written after the last call to recordFileCommitted() are discarded and the ids and deduplication
+	 * state of the remaining records are restored, so recording continues with the same ids as before. Use
+	 * getCommittedFilePaths() to find the files that do not need to be recorded again.
+	 *
+	 *  param: ingestLogFilePath - path of an existing ingest log that was written with openIngestLog()
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: openIngestLog(const std::string& ingestLogFilePath)
+	 */
+	bool resumeIngestLog(const std::string& ingestLogFilePath);
+
 	/**
 	 * Clears the currently open Sourcetrail database
 	 *
@@ -196,6 +271,200 @@ public:
 	 */
 	bool optimizeDatabaseMemory();
 
+	/**
+	 * Stores the source locations and occurrences of each file next to each other in the open database
+	 *
+	 * A parallel indexer records the locations of many files in turns, so loading the locations of one file reads
+	 * pages from all over the database. This method rewrites the source locations sorted by file and start line, then
+	 * rewrites the occurrences in the same order and reduces the database like optimizeDatabaseMemory(). The ids of
+	 * recorded symbols, references, files and other elements don't change. The internal ids of the source locations
+	 * are renumbered. Call this method outside of a transaction after recording all data.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: optimizeDatabaseMemory()
+	 */
+	bool optimizeDatabaseLocality();
+
+	/**
+	 * Gathers statistics about the tables and indices of the open database for the SQLite query planner
+	 *
+	 * Runs ANALYZE and PRAGMA optimize. The statistics are stored in the database, so readers like Sourcetrail can
+	 * choose better query plans for large tables. Call this method once after recording all data, because ANALYZE
+	 * reads every table and index of the database.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: setAnalyzeOnCloseEnabled(bool enabled)
+	 */
+	bool analyzeDatabase();
+
+	/**
+	 * Provides the statistics collected by this writer since its creation or the last call to resetStatistics()
+	 *
+	 * The statistics contain call counts and latencies of all methods of this interface, the number of rows that
+	 * were inserted or deduplicated per table, the stored file content size and the durations of transaction
+	 * commits. They are only collected if SourcetrailDB is built with the CMake option ENABLE_WRITER_STATISTICS.
+	 *
+	 *  note: This method may be called from another thread while the writer is in use, e.g. to export the statistics
+	 *    periodically. The returned values are not synchronized with each other.
+	 *
+	 *  return: snapshot of the statistics
+	 */
+	WriterStatistics getStatistics() const;
+	void resetStatistics();
+
+	/**
+	 * Starts writing a trace of this writer's work to a file
+	 *
+	 * The trace uses the Chrome trace event format and can be opened with Perfetto (https://ui.perfetto.dev) or
+	 * chrome://tracing. It contains spans for open(), close(), recordFile() (split into reading the file, counting
+	 * its lines and inserting it), transactions, index creation, optimizeDatabaseMemory() and every executed SQL
+	 * statement. Spans are buffered per thread and written by a background thread. Tracing may be started before
+	 * open() to include opening the database.
+	 *
+	 *  param: traceFilePath - path of the trace file. An existing file is overwritten.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: stopTracing()
+	 */
+	bool startTracing(const std::string& traceFilePath);
+
+	/**
+	 * Stops tracing and writes all buffered spans to the trace file
+	 *
+	 * Tracing is also stopped when the writer is destroyed.
+	 *
+	 *  see: startTracing(const std::string& traceFilePath)
+	 */
+	void stopTracing();
+
+	/**
+	 * Starts writing every call of this interface to a binary operation journal
+	 *
+	 * The journal stores the arguments and returned ids of all calls that modify the database. It can be replayed
+	 * against a fresh database with the srctrldb_replay tool, e.g. to benchmark changes of SourcetrailDB with the
+	 * workload of a real indexer. The content of recorded files is not part of the journal.
+	 *
+	 *  param: journalFilePath - path of the journal file. An existing file is overwritten.
+	 *  param: anonymize - if true, symbol names, file paths, local symbol names and error messages are replaced by
+	 *    tokens of the same length, so the journal can be shared without revealing the indexed source code.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: stopJournal()
+	 */
+	bool startJournal(const std::string& journalFilePath, bool anonymize);
+
+	/**
+	 * Stops writing the operation journal and flushes it to disk
+	 *
+	 * The journal is also stopped when the writer is destroyed.
+	 *
+	 *  see: startJournal(const std::string& journalFilePath, bool anonymize)
+	 */
+	void stopJournal();
+
+	/**
+	 * Enables or disables updating the symbol name search index when the database gets closed
+	 *
+	 * The name search index is an optional table that maps the lowercase name of each symbol's last name element and
+	 * the camel case and underscore separated tokens of that name to the symbol's id. Sourcetrail ignores this table.
+	 *
+	 *  param: enabled - if true, close() calls updateNameIndex() before closing the database. Disabled by default.
+	 *
+	 *  see: updateNameIndex()
+	 */
+	void setNameIndexEnabled(bool enabled);
+
+	/**
+	 * Enables or disables the integer hash key columns of the node and error tables
+	 *
+	 * With hash keys, the node's serialized name and the error message are stored together with their 64 bit hash,
+	 * and the lookups of already recorded nodes and errors use an index on the hash instead of an index on the full
+	 * text. That makes the index much smaller and the lookups faster. Sourcetrail ignores the extra columns.
+	 *
+	 *  param: enabled - if true, open() and clear() add the hash key columns to the database. A database that already
+	 *         contains hash key columns keeps them regardless of this setting. Disabled by default.
+	 */
+	void setHashKeysEnabled(bool enabled);
+
+	/**
+	 * Enables or disables building the database in a temporary file that replaces the database file on close()
+	 *
+	 * The temporary file is located next to the database file and has the additional extension ".tmp". It starts as a
+	 * copy of the database file if that exists and is written without journaling, which makes recording faster.
+	 * close() updates the enabled indices, runs ANALYZE, flushes the temporary file to disk and renames it to the
+	 * database file, so other processes never see a partially written database, not even after a power loss. If the
+	 * writer is not closed, the database file remains unchanged. Transactions may still be rolled back, but the
+	 * temporary file may be corrupt after a crash.
+	 *
+	 *  param: enabled - if true, open() and openInMemory() build the database in a temporary file. Disabled by default.
+	 */
+	void setAtomicBuildEnabled(bool enabled);
+
+	/**
+	 * Enables or disables clearing the database by replacing the database file with a new one
+	 *
+	 * By default, clear() drops all tables, which takes longer the more data the database contains and leaves the
+	 * file at its previous size. Replacing the file takes the same time for every database. Processes that still read
+	 * the previous file may keep reading it until they reopen the database. During a transaction, clear() always drops
+	 * the tables.
+	 *
+	 *  param: enabled - if true, clear() replaces the database file. Disabled by default.
+	 *
+	 *  see: clear()
+	 */
+	void setRecreateOnClearEnabled(bool enabled);
+
+	/**
+	 * Enables or disables calling analyzeDatabase() when the database gets closed
+	 *
+	 *  param: enabled - if true, close() calls analyzeDatabase() after updating the enabled indices. Atomic builds
+	 *         always do so. Disabled by default.
+	 *
+	 *  see: analyzeDatabase()
+	 *  see: setAtomicBuildEnabled(bool enabled)
+	 */
+	void setAnalyzeOnCloseEnabled(bool enabled);
+
+	/**
+	 * Adds all symbols that have been recorded since the last update to the symbol name search index
+	 *
+	 * The index is created on first use. Updating is incremental, so this method may be called repeatedly while
+	 * recording, e.g. after each indexed file. Use DatabaseStorage::findNodeIdsByNamePrefix() and
+	 * DatabaseStorage::findNodeIdsByNameSubstring() to query the index.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: setNameIndexEnabled(bool enabled)
+	 */
+	bool updateNameIndex();
+
+	/**
+	 * Enables or disables updating the source location index when the database gets closed
+	 *
+	 * The source location index is an optional table that allows to quickly look up all source locations covering a
+	 * position in a file (e.g. for hover queries of editor integrations). Sourcetrail ignores this table.
+	 *
+	 *  param: enabled - if true, close() calls updateLocationIndex() before closing the database. Disabled by default.
+	 *
+	 *  see: updateLocationIndex()
+	 */
+	void setLocationIndexEnabled(bool enabled);
+
+	/**
+	 * Adds all source locations that have been recorded since the last update to the source location index
+	 *
+	 * The index is created on first use and updated incrementally. Use DatabaseStorage::getLocationsAt() to query it.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: setLocationIndexEnabled(bool enabled)
+	 */
+	bool updateLocationIndex();
+
 	/**
 	 * Stores a symbol to the database
 	 *
@@ -211,6 +480,38 @@ public:
 	 */
 	int recordSymbol(const NameHierarchy& nameHierarchy);
 
+	/**
+	 * Creates a builder for symbol names that shares its string pool with this writer
+	 *
+	 * Reuse the builder for all symbols. Recording a symbol from a builder of this writer looks up the ids of the
+	 * symbol and its parents in memory if they have been recorded before, which avoids all database lookups and
+	 * memory allocations for names that repeat, e.g. namespaces and classes. The memory used for the lookup grows with
+	 * the number of recorded symbols and is released when the database gets closed, cleared or a transaction is
+	 * rolled back.
+	 *
+	 *  param: nameDelimiter - delimiter added between name elements
+	 *
+	 *  return: builder without name elements
+	 *
+	 *  see: NameHierarchyBuilder
+	 */
+	NameHierarchyBuilder createNameHierarchyBuilder(const std::string& nameDelimiter = "::");
+
+	/**
+	 * Stores a symbol to the database
+	 *
+	 * Same as recordSymbol(const NameHierarchy& nameHierarchy), but reads the name from a builder. Builders that have
+	 * not been created by this writer are supported, but do not benefit from the in memory lookup of symbol ids.
+	 *
+	 *  param: nameHierarchy - the name of the symbol to store.
+	 *
+	 *  return: symbolId - integer id of the stored symbol. 0 on failure. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: createNameHierarchyBuilder(const std::string& nameDelimiter)
+	 */
+	int recordSymbol(const NameHierarchyBuilder& nameHierarchy);
+
 	/**
 	 * Stores a definition kind for a specific symbol to the database
 	 *
@@ -265,6 +566,23 @@ public:
 	 */
 	bool recordSymbolLocation(int symbolId, const SourceRange& location);
 
+	/**
+	 * Stores locations for multiple symbols to the database
+	 *
+	 * Bulk version of recordSymbolLocation() that records all rows in one call, which avoids per-call overhead when
+	 * used from language bindings.
+	 *
+	 *  param: rows - pointer to rowCount * 6 integers. Each row consists of symbolId, fileId, startLine, startColumn,
+	 *    endLine and endColumn.
+	 *  param: rowCount - number of rows to record.
+	 *
+	 *  return: true if all rows were recorded. false on failure, the remaining rows are skipped then. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: recordSymbolLocation(int symbolId, const SourceRange& location)
+	 */
+	bool recordSymbolLocations(const int* rows, size_t rowCount);
+
 	/**
 	 * Stores a scope location for a specific symbol to the database
 	 *
@@ -330,6 +648,24 @@ public:
 	 */
 	int recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind);
 
+	/**
+	 * Stores multiple references between symbols to the database
+	 *
+	 * Bulk version of recordReference() that records all rows in one call and writes the ids of the stored
+	 * references to a caller provided array.
+	 *
+	 *  param: rows - pointer to rowCount * 3 integers. Each row consists of contextSymbolId, referencedSymbolId and
+	 *    the integer value of the ReferenceKind.
+	 *  param: rowCount - number of rows to record.
+	 *  param: referenceIds - pointer to rowCount integers that receive the referenceId of each row.
+	 *
+	 *  return: true if all rows were recorded. false on failure, the remaining rows are skipped then. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+	 */
+	bool recordReferences(const int* rows, size_t rowCount, int* referenceIds);
+
 	/**
 	 * Stores a location for a specific reference to the database
 	 *
@@ -350,6 +686,22 @@ public:
 	 */
 	bool recordReferenceLocation(int referenceId, const SourceRange& location);
 
+	/**
+	 * Stores locations for multiple references to the database
+	 *
+	 * Bulk version of recordReferenceLocation().
+	 *
+	 *  param: rows - pointer to rowCount * 6 integers. Each row consists of referenceId, fileId, startLine,
+	 *    startColumn, endLine and endColumn.
+	 *  param: rowCount - number of rows to record.
+	 *
+	 *  return: true if all rows were recorded. false on failure, the remaining rows are skipped then. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: recordReferenceLocation(int referenceId, const SourceRange& location)
+	 */
+	bool recordReferenceLocations(const int* rows, size_t rowCount);
+
 	/**
 	 * Marks a reference that is stored in the database as "ambiguous"
 	 *
@@ -434,6 +786,29 @@ public:
 	 */
 	bool recordFileLanguage(int fileId, const std::string& languageIdentifier);
 
+	/**
+	 * Marks all data of a file as recorded completely
+	 *
+	 * The committed files are stored in the database with the next commitTransaction() call, or immediately if no
+	 * transaction is running, so they are only persisted together with the data that has been recorded for them. An
+	 * open ingest log is flushed to disk instead. After a crash, an indexer can reopen the database (or resume the
+	 * ingest log) and skip all files returned by getCommittedFilePaths().
+	 *
+	 *  param: fileId - the id of the file that has been recorded completely
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: getCommittedFilePaths()
+	 */
+	bool recordFileCommitted(int fileId);
+
+	/**
+	 * Provides the paths of all files that have been marked with recordFileCommitted()
+	 *
+	 *  return: paths of the committed files. Empty on failure, getLastError() provides the error message.
+	 */
+	std::vector<std::string> getCommittedFilePaths() const;
+
 	/**
 	 * Stores a local symbol to the database
 	 *
@@ -502,22 +877,68 @@ public:
 	bool recordError(const std::string& message, bool fatal, const SourceRange& location);
 
 private:
+	bool openProject(const std::string& databaseFilePath, bool inMemory, size_t memoryLimit, bool vacuum);
 	void openDatabase();
 	void closeDatabase();
+	// continues recording to the database file if the in-memory database exceeds the memory limit
+	void checkMemoryLimit();
+	// the temporary file during an atomic build, the database file otherwise
+	const std::string& getStorageFilePath() const;
 	void setupDatabaseTables();
 	void clearDatabaseTables();
 	void createOrResetProjectFile();
 	void updateProjectSettingsText();
-	int addNodeHierarchy(const NameHierarchy& nameHierarchy);
+	// the add methods report SQLite errors by their status and throw SourcetrailException for all other errors
+	StorageStatus addNodeHierarchy(const NameHierarchy& nameHierarchy, int& nodeId);
 	int addFile(const std::string& filePath);
-	int addEdge(int sourceId, int targetId, EdgeKind edgeKind);
-	void addSourceLocation(int elementId, const SourceRange& location, LocationKind kind);
+	StorageStatus addEdge(int sourceId, int targetId, EdgeKind edgeKind, int& edgeId);
+	StorageStatus addSourceLocation(int elementId, const SourceRange& location, LocationKind kind);
+	StorageStatus addSourceLocations(const int* rows, size_t rowCount, LocationKind kind, size_t& failedRow);
+	StorageStatus addNodeHierarchy(const NameHierarchyBuilder& nameHierarchy, int& nodeId);
 	void addElementComponent(int elementId, ElementComponentKind kind, const std::string& data);
+	// returns false and stores the status as last error if it is no success
+	bool checkStatus(const StorageStatus& status, const char* rowKind = nullptr, size_t row = 0) const;
+
+	// identifies a node by its parent and the pooled strings of its last name element
+	struct NodeIdCacheKey
+	{
+		bool operator==(const NodeIdCacheKey& other) const;
+
+		int parentNodeId;
+		uint32_t nameDelimiterId;
+		uint32_t prefixId;
+		uint32_t nameId;
+		uint32_t postfixId;
+	};
+
+	struct NodeIdCacheKeyHash
+	{
+		size_t operator()(const NodeIdCacheKey& key) const;
+	};
 
 	std::string m_projectFilePath;
 	std::string m_databaseFilePath;
+	std::string m_temporaryFilePath;
+	std::unique_ptr<StatisticsCounters> m_statistics;
+	std::unique_ptr<TraceRecorder> m_trace;
+	std::unique_ptr<OperationJournal> m_journal;
 	std::unique_ptr<DatabaseStorage> m_storage;
 	mutable std::string m_lastError;
+	mutable StorageStatus m_lastErrorStatus;
+	mutable const char* m_lastErrorRowKind;
+	mutable size_t m_lastErrorRow;
+	bool m_nameIndexEnabled;
+	bool m_hashKeysEnabled;
+	bool m_locationIndexEnabled;
+	bool m_atomicBuildEnabled;
+	bool m_recreateOnClearEnabled;
+	bool m_analyzeOnCloseEnabled;
+	bool m_inMemory;
+	size_t m_memoryLimit;
+	bool m_vacuumOnClose;
+	std::shared_ptr<NameStringPool> m_namePool;
+	std::unordered_map<NodeIdCacheKey, int, NodeIdCacheKeyHash> m_nodeIdCache;
+	std::string m_serializedNameBuffer;
 };
 }	 // namespace sourcetrail
 
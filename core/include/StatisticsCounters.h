@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_STATISTICS_COUNTERS_H
+#define SOURCETRAIL_STATISTICS_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "WriterStatistics.h"
+
+namespace sourcetrail
+{
+/**
+ * INTERNAL: Class holding the counters that are reported by SourcetrailDBWriter::getStatistics().
+ *
+ * All counters are relaxed atomics, so a snapshot can be taken from another thread while the writer is busy. The
+ * snapshot is not synchronized across counters.
+ *
+ * The counters are only updated through the SOURCETRAIL_STATISTICS_* macros, which are compiled out unless
+ * SOURCETRAIL_ENABLE_STATISTICS is defined.
+ */
+class StatisticsCounters
+{
+public:
+	class DurationCounter
+	{
+	public:
+		DurationCounter();
+		void add(uint64_t nanoseconds);
+		void reset();
+		WriterStatistics::Duration get() const;
+
+	private:
+		std::atomic<uint64_t> m_count;
+		std::atomic<uint64_t> m_totalNanoseconds;
+		std::atomic<uint64_t> m_maxNanoseconds;
+	};
+
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(DurationCounter* counter);
+		~ScopedTimer();
+
+	private:
+		DurationCounter* m_counter;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	StatisticsCounters();
+
+	DurationCounter* getOperationCounter(WriterOperation operation);
+	DurationCounter* getCommitCounter();
+
+	void addRow(WriterTable table, bool inserted);
+	void addFileContentBytes(uint64_t byteCount);
+
+	void reset();
+	WriterStatistics getStatistics() const;
+
+private:
+	StatisticsCounters(const StatisticsCounters&) = delete;
+	StatisticsCounters& operator=(const StatisticsCounters&) = delete;
+
+	DurationCounter m_operations[static_cast<int>(WriterOperation::COUNT)];
+	DurationCounter m_commits;
+	std::atomic<uint64_t> m_insertedRows[static_cast<int>(WriterTable::COUNT)];
+	std::atomic<uint64_t> m_deduplicatedRows[static_cast<int>(WriterTable::COUNT)];
+	std::atomic<uint64_t> m_fileContentByteCount;
+};
+}	 // namespace sourcetrail
+
+#ifdef SOURCETRAIL_ENABLE_STATISTICS
+#	define SOURCETRAIL_STATISTICS_MEASURE_OPERATION(counters, operation)                                              \
+		const sourcetrail::StatisticsCounters::ScopedTimer statisticsOperationTimer(                                   \
+			(counters) ? (counters)->getOperationCounter(operation) : nullptr)
+#	define SOURCETRAIL_STATISTICS_MEASURE_COMMIT(counters)                                                             \
+		const sourcetrail::StatisticsCounters::ScopedTimer statisticsCommitTimer(                                      \
+			(counters) ? (counters)->getCommitCounter() : nullptr)
+#	define SOURCETRAIL_STATISTICS_ADD_ROW(counters, table, inserted)                                                   \
+		do                                                                                                             \
+		{                                                                                                              \
+			if (counters)                                                                                              \
+			{                                                                                                          \
+				(counters)->addRow(table, inserted);                                                                   \
+			}                                                                                                          \
+		} while (0)
+#	define SOURCETRAIL_STATISTICS_ADD_FILE_CONTENT_BYTES(counters, byteCount)                                          \
+		do                                                                                                             \
+		{                                                                                                              \
+			if (counters)                                                                                              \
+			{                                                                                                          \
+				(counters)->addFileContentBytes(byteCount);                                                            \
+			}                                                                                                          \
+		} while (0)
+#else
+#	define SOURCETRAIL_STATISTICS_MEASURE_OPERATION(counters, operation)
+#	define SOURCETRAIL_STATISTICS_MEASURE_COMMIT(counters)
+// evaluates the trivial condition, so variables that only exist for it are not reported as unused
+#	define SOURCETRAIL_STATISTICS_ADD_ROW(counters, table, inserted) static_cast<void>(inserted)
+#	define SOURCETRAIL_STATISTICS_ADD_FILE_CONTENT_BYTES(counters, byteCount)
+#endif
+
+#endif	  // SOURCETRAIL_STATISTICS_COUNTERS_H
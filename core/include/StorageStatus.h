@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_STORAGE_STATUS_H
+#define SOURCETRAIL_STORAGE_STATUS_H
+
+#include <cstdint>
+
+namespace sourcetrail
+{
+enum class StorageStatement : uint8_t
+{
+	NONE,
+	INSERT_ELEMENT,
+	FIND_NODE,
+	INSERT_NODE,
+	SET_NODE_TYPE,
+	INSERT_SYMBOL,
+	FIND_EDGE,
+	INSERT_EDGE,
+	FIND_LOCAL_SYMBOL,
+	INSERT_LOCAL_SYMBOL,
+	FIND_SOURCE_LOCATION,
+	INSERT_SOURCE_LOCATION,
+	INSERT_OCCURRENCE
+};
+
+/**
+ * INTERNAL: Struct holding the result of a DatabaseStorage method that reports failures without throwing.
+ *
+ * Only the failed statement and the SQLite result code are stored. The error message is built by
+ * DatabaseStorage::getErrorMessage() once it is requested.
+ */
+struct StorageStatus
+{
+	StorageStatus(): statement(StorageStatement::NONE), resultCode(0) {}
+
+	StorageStatus(StorageStatement statement, int resultCode): statement(statement), resultCode(resultCode) {}
+
+	bool isOk() const
+	{
+		return resultCode == 0;
+	}
+
+	StorageStatement statement;
+	int resultCode;	   // SQLite result code, 0 (SQLITE_OK) on success
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_STORAGE_STATUS_H
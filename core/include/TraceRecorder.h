@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_TRACE_RECORDER_H
+#define SOURCETRAIL_TRACE_RECORDER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sourcetrail
+{
+/**
+ * INTERNAL: Class writing spans to a file in the Chrome trace event format.
+ *
+ * The file can be opened with Perfetto (https://ui.perfetto.dev) or chrome://tracing. Every thread records its spans
+ * into its own buffer. Full buffers are handed to a background thread that serializes them to the file, so recording
+ * a span does not wait for file I/O. The remaining buffered spans are written when the recorder is destroyed.
+ */
+class TraceRecorder
+{
+public:
+	/**
+	 * Records the span from its construction to its destruction. Does nothing if the recorder is nullptr.
+	 *
+	 * The name needs to stay valid until the scope is destroyed.
+	 */
+	class Scope
+	{
+	public:
+		Scope(TraceRecorder* recorder, const char* category, const char* name);
+		~Scope();
+
+	private:
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		TraceRecorder* m_recorder;
+		const char* m_category;
+		const char* m_name;
+		uint64_t m_startNanoseconds;
+	};
+
+	// throws SourcetrailException if the trace file cannot be created
+	explicit TraceRecorder(const std::string& traceFilePath);
+	~TraceRecorder();
+
+	// nanoseconds since the construction of this recorder
+	uint64_t now() const;
+
+	void addSpan(const char* category, const std::string& name, uint64_t startNanoseconds, uint64_t endNanoseconds);
+
+private:
+	struct Event
+	{
+		std::string name;
+		const char* category;
+		uint64_t startNanoseconds;
+		uint64_t durationNanoseconds;
+		uint32_t threadId;
+	};
+
+	struct ThreadBuffer
+	{
+		std::mutex mutex;
+		std::vector<Event> events;
+		uint32_t threadId;
+	};
+
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+	ThreadBuffer* getThreadBuffer();
+	void submit(std::vector<Event>&& events);
+	void runFlushThread();
+	void writeEvents(const std::vector<Event>& events);
+
+	const uint64_t m_serialNumber;
+	const std::chrono::steady_clock::time_point m_startTime;
+	std::ofstream m_file;
+	bool m_firstEventWritten;
+
+	std::mutex m_threadBuffersMutex;
+	std::map<std::thread::id, std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	std::deque<std::vector<Event>> m_queue;
+	bool m_stopping;
+	std::thread m_flushThread;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_TRACE_RECORDER_H
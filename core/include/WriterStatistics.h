@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_WRITER_STATISTICS_H
+#define SOURCETRAIL_WRITER_STATISTICS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sourcetrail
+{
+/**
+ * Enum of the SourcetrailDBWriter methods that are measured by the writer statistics.
+ */
+enum class WriterOperation
+{
+	OPEN,
+	CLOSE,
+	CLEAR,
+	BEGIN_TRANSACTION,
+	COMMIT_TRANSACTION,
+	ROLLBACK_TRANSACTION,
+	OPTIMIZE_DATABASE_MEMORY,
+	RECORD_SYMBOL,
+	RECORD_SYMBOL_DEFINITION_KIND,
+	RECORD_SYMBOL_KIND,
+	RECORD_SYMBOL_LOCATION,
+	RECORD_SYMBOL_LOCATIONS,
+	RECORD_SYMBOL_SCOPE_LOCATION,
+	RECORD_SYMBOL_SIGNATURE_LOCATION,
+	RECORD_REFERENCE,
+	RECORD_REFERENCES,
+	RECORD_REFERENCE_LOCATION,
+	RECORD_REFERENCE_LOCATIONS,
+	RECORD_REFERENCE_IS_AMBIGUOUS,
+	RECORD_REFERENCE_TO_UNSOLVED_SYMBOL,
+	RECORD_QUALIFIER_LOCATION,
+	RECORD_FILE,
+	RECORD_FILE_LANGUAGE,
+	RECORD_LOCAL_SYMBOL,
+	RECORD_LOCAL_SYMBOL_LOCATION,
+	RECORD_ATOMIC_SOURCE_RANGE,
+	RECORD_ERROR,
+	OPEN_INGEST_LOG,
+	MATERIALIZE_INGEST_LOG,
+	RESUME_INGEST_LOG,
+	RECORD_FILE_COMMITTED,
+	OPEN_IN_MEMORY,
+	ANALYZE_DATABASE,
+	OPTIMIZE_DATABASE_LOCALITY,
+	COUNT
+};
+
+/**
+ * Enum of the database tables for which the writer statistics count inserted and deduplicated rows.
+ */
+enum class WriterTable
+{
+	NODE,
+	SYMBOL,
+	EDGE,
+	FILE,
+	LOCAL_SYMBOL,
+	SOURCE_LOCATION,
+	OCCURRENCE,
+	ELEMENT_COMPONENT,
+	ERROR_ENTRY,
+	COUNT
+};
+
+/**
+ * Snapshot of the statistics collected by a SourcetrailDBWriter.
+ *
+ * Statistics are only collected if SourcetrailDB is built with SOURCETRAIL_ENABLE_STATISTICS (CMake option
+ * ENABLE_WRITER_STATISTICS). Otherwise enabled is false and all values are 0.
+ *
+ *  see: SourcetrailDBWriter::getStatistics()
+ */
+struct WriterStatistics
+{
+	struct Duration
+	{
+		uint64_t count;
+		uint64_t totalNanoseconds;
+		uint64_t maxNanoseconds;
+	};
+
+	struct Operation
+	{
+		std::string name;
+		Duration duration;
+	};
+
+	struct Table
+	{
+		std::string name;
+		uint64_t insertedRowCount;
+		uint64_t deduplicatedRowCount;
+	};
+
+	bool enabled;
+
+	// indexed by WriterOperation
+	std::vector<Operation> operations;
+
+	// indexed by WriterTable
+	std::vector<Table> tables;
+
+	// commits of transactions, including the implicit ones of the optional indices
+	Duration commits;
+
+	// size of the file content stored by recordFile()
+	uint64_t fileContentByteCount;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_WRITER_STATISTICS_H
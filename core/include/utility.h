@@ -17,17 +17,28 @@
 #ifndef SOURCETRAIL_UTILITY_H
 #define SOURCETRAIL_UTILITY_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <time.h>
+#include <vector>
 
 namespace sourcetrail
 {
 namespace utility
 {
 bool getFileExists(const std::string& filePath);
+// Moves the file to the new path, an existing file at that path is replaced atomically. The content of the file is
+// flushed to disk before and, on POSIX systems, the directory after the rename, so the replacement survives a crash.
+bool replaceFile(const std::string& filePath, const std::string& newFilePath);
 std::string getFileContent(const std::string& filePath);
 std::string getDateTimeString(const time_t& time);
 int getLineCount(const std::string s);
+std::string toLowerCase(const std::string& s);
+std::vector<std::string> getLowerCaseNameTokens(const std::string& name);
+// XXH64 of the string with seed 0, independent of the byte order of the machine
+uint64_t getHash64(const std::string& s);
+uint64_t getHash64(const char* data, size_t size);
 }	 // namespace utility
 }	 // namespace sourcetrail
 
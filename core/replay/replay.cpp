@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays an operation journal written by SourcetrailDBWriter::startJournal() against a fresh database and reports
+// the elapsed time.
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "OperationJournal.h"
+#include "SourcetrailDBWriter.h"
+#include "SourcetrailException.h"
+
+namespace
+{
+struct ReplayOptions
+{
+	std::string journalPath;
+	std::string databasePath = "replay.srctrldb";
+	std::string traceFilePath;
+};
+
+void printUsage()
+{
+	std::cout << "usage: srctrldb_replay --journal=<path> [options]\n"
+			  << "  --journal=<path>                operation journal to replay\n"
+			  << "  --database=<path>               database file to write, replaced if it exists (default: replay.srctrldb)\n"
+			  << "  --trace=<path>                  write a Chrome trace event file of the replay (default: off)\n";
+}
+
+bool parseOptions(int argc, const char* argv[], ReplayOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		const size_t separator = argument.find('=');
+		if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos)
+		{
+			return false;
+		}
+
+		const std::string key = argument.substr(2, separator - 2);
+		const std::string value = argument.substr(separator + 1);
+		if (key == "journal")
+		{
+			options.journalPath = value;
+		}
+		else if (key == "database")
+		{
+			options.databasePath = value;
+		}
+		else if (key == "trace")
+		{
+			options.traceFilePath = value;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !options.journalPath.empty() && !options.databasePath.empty();
+}
+
+double getSecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	ReplayOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	try
+	{
+		const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+		sourcetrail::OperationJournalReader reader(options.journalPath);
+		const double loadSeconds = getSecondsSince(loadStart);
+
+		// replay against a fresh database
+		std::remove(options.databasePath.c_str());
+
+		sourcetrail::SourcetrailDBWriter writer;
+		if (!options.traceFilePath.empty() && !writer.startTracing(options.traceFilePath))
+		{
+			std::cerr << "ERROR: " << writer.getLastError() << std::endl;
+			return 1;
+		}
+
+		const std::chrono::steady_clock::time_point replayStart = std::chrono::steady_clock::now();
+		const sourcetrail::OperationJournalReplayResult result =
+			sourcetrail::replayOperationJournal(reader, options.databasePath, writer);
+		const double replaySeconds = getSecondsSince(replayStart);
+		writer.stopTracing();
+
+		std::cout << "journal: " << options.journalPath << " (" << reader.getByteCount() << " bytes, loaded in "
+				  << std::fixed << std::setprecision(3) << loadSeconds << " s)" << std::endl;
+		std::cout << "operations: " << result.operationCount << ", failed: " << result.failedOperationCount
+				  << std::endl;
+		std::cout << "replay: " << replaySeconds << " s, " << std::setprecision(0)
+				  << (replaySeconds > 0.0 ? result.operationCount / replaySeconds : 0.0) << " ops/sec" << std::endl;
+		if (result.failedOperationCount > 0)
+		{
+			std::cout << "first error: " << result.firstError << std::endl;
+		}
+	}
+	catch (const sourcetrail::SourcetrailException& e)
+	{
+		std::cerr << "ERROR: " << e.getMessage() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -16,16 +16,48 @@
 
 #include "DatabaseStorage.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
 #include <vector>
 
+#include "IngestLog.h"
+#include "NameHierarchy.h"
 #include "NodeKind.h"
 #include "SourcetrailException.h"
+#include "StatisticsCounters.h"
 #include "StorageFile.h"
 #include "StorageNode.h"
 #include "StorageSymbol.h"
+#include "TraceRecorder.h"
 #include "utility.h"
 #include "version.h"
 
+namespace
+{
+sqlite_int64 getHashKey(const std::string& text)
+{
+	return static_cast<sqlite_int64>(sourcetrail::utility::getHash64(text));
+}
+}	 // namespace
+
+namespace
+{
+int getLineSpanLevel(int startLine, int endLine)
+{
+	// locations on level L span at most 2^L - 1 lines beyond their start line
+	int span = endLine > startLine ? endLine - startLine : 0;
+	int level = 0;
+	while (span > 0)
+	{
+		span >>= 1;
+		level++;
+	}
+	return level;
+}
+}	 // namespace
+
 namespace sourcetrail
 {
 // --- Public Interface ---
@@ -35,11 +67,66 @@ int DatabaseStorage::getSupportedDatabaseVersion()
 	return DATABASE_VERSION;
 }
 
+std::string DatabaseStorage::getErrorMessage(const StorageStatus& status)
+{
+	if (status.isOk())
+	{
+		return "";
+	}
+
+	const char* statementName = "";
+	switch (status.statement)
+	{
+	case StorageStatement::NONE:
+		break;
+	case StorageStatement::INSERT_ELEMENT:
+		statementName = "insert element";
+		break;
+	case StorageStatement::FIND_NODE:
+		statementName = "find node";
+		break;
+	case StorageStatement::INSERT_NODE:
+		statementName = "insert node";
+		break;
+	case StorageStatement::SET_NODE_TYPE:
+		statementName = "set node type";
+		break;
+	case StorageStatement::INSERT_SYMBOL:
+		statementName = "insert symbol";
+		break;
+	case StorageStatement::FIND_EDGE:
+		statementName = "find edge";
+		break;
+	case StorageStatement::INSERT_EDGE:
+		statementName = "insert edge";
+		break;
+	case StorageStatement::FIND_LOCAL_SYMBOL:
+		statementName = "find local symbol";
+		break;
+	case StorageStatement::INSERT_LOCAL_SYMBOL:
+		statementName = "insert local symbol";
+		break;
+	case StorageStatement::FIND_SOURCE_LOCATION:
+		statementName = "find source location";
+		break;
+	case StorageStatement::INSERT_SOURCE_LOCATION:
+		statementName = "insert source location";
+		break;
+	case StorageStatement::INSERT_OCCURRENCE:
+		statementName = "insert occurrence";
+		break;
+	}
+
+	return "Failed to execute statement \"" + std::string(statementName) + "\" with message \"" +
+		CppSQLite3Exception::errorCodeAsString(status.resultCode) + ": " + sqlite3_errstr(status.resultCode) + "\".";
+}
+
 std::unique_ptr<DatabaseStorage> DatabaseStorage::openDatabase(const std::string& dbFilePath)
 {
 	try
 	{
 		std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
+		storage->m_databaseFilePath = dbFilePath;
 		storage->m_database.open(dbFilePath.c_str());
 		storage->executeStatement("PRAGMA foreign_keys=ON;");
 		return std::move(storage);
@@ -50,6 +137,68 @@ std::unique_ptr<DatabaseStorage> DatabaseStorage::openDatabase(const std::string
 	}
 }
 
+std::unique_ptr<DatabaseStorage> DatabaseStorage::openInMemoryDatabase(const std::string& dbFilePath)
+{
+	try
+	{
+		std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
+		storage->m_inMemory = true;
+		storage->m_database.open(":memory:");
+		if (utility::getFileExists(dbFilePath))
+		{
+			storage->m_database.restoreFrom(dbFilePath.c_str());
+		}
+		storage->executeStatement("PRAGMA foreign_keys=ON;");
+		return storage;
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException(
+			"Failed to load database \"" + dbFilePath + "\" into memory with message \"" + e.errorMessage() + "\".");
+	}
+}
+
+std::unique_ptr<DatabaseStorage> DatabaseStorage::openTemporaryDatabase(
+	const std::string& dbFilePath, const std::string& temporaryFilePath)
+{
+	// a temporary file left behind by an interrupted build is discarded
+	std::remove(temporaryFilePath.c_str());
+
+	try
+	{
+		std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
+		storage->m_databaseFilePath = temporaryFilePath;
+		storage->m_database.open(temporaryFilePath.c_str());
+		if (utility::getFileExists(dbFilePath))
+		{
+			storage->m_database.restoreFrom(dbFilePath.c_str());
+		}
+		storage->executeStatement("PRAGMA foreign_keys=ON;");
+		storage->setJournalingEnabled(false);
+		return storage;
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException(
+			"Failed to copy database \"" + dbFilePath + "\" to \"" + temporaryFilePath + "\" with message \"" +
+			e.errorMessage() + "\".");
+	}
+}
+
+std::unique_ptr<DatabaseStorage> DatabaseStorage::openIngestLog(const std::string& ingestLogFilePath)
+{
+	std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
+	storage->m_ingestLog = IngestLog::create(ingestLogFilePath);
+	return storage;
+}
+
+std::unique_ptr<DatabaseStorage> DatabaseStorage::resumeIngestLog(const std::string& ingestLogFilePath)
+{
+	std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
+	storage->m_ingestLog = IngestLog::resume(ingestLogFilePath);
+	return storage;
+}
+
 DatabaseStorage::~DatabaseStorage()
 {
 	clearPrecompiledStatements();
@@ -59,6 +208,11 @@ DatabaseStorage::~DatabaseStorage()
 
 void DatabaseStorage::setupDatabase()
 {
+	if (m_ingestLog)
+	{
+		return;
+	}
+
 	executeStatement("PRAGMA foreign_keys=ON;");
 
 	if (!isCompatible())
@@ -68,6 +222,8 @@ void DatabaseStorage::setupDatabase()
 
 	setupTables();
 
+	setupHashKeys();
+
 	setupIndices();
 
 	setupPrecompiledStatements();
@@ -77,6 +233,12 @@ void DatabaseStorage::setupDatabase()
 
 void DatabaseStorage::clearDatabase()
 {
+	if (m_ingestLog)
+	{
+		m_ingestLog->clear();
+		return;
+	}
+
 	executeStatement("PRAGMA foreign_keys=OFF;");
 
 	clearPrecompiledStatements();
@@ -86,13 +248,305 @@ void DatabaseStorage::clearDatabase()
 	setupDatabase();
 }
 
+void DatabaseStorage::recreateDatabase()
+{
+	if (m_ingestLog || m_transactionActive)
+	{
+		clearDatabase();
+		return;
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "recreate database");
+
+	try
+	{
+		clearPrecompiledStatements();
+		m_database.close();
+
+		// other processes that still read the removed file keep their view of it
+		bool removed = true;
+		if (!m_inMemory && std::remove(m_databaseFilePath.c_str()) != 0)
+		{
+			removed = !utility::getFileExists(m_databaseFilePath);
+		}
+
+		m_database.open(m_inMemory ? ":memory:" : m_databaseFilePath.c_str());
+		executeStatement("PRAGMA foreign_keys=ON;");
+		if (!m_journalingEnabled)
+		{
+			setJournalingEnabled(false);
+		}
+
+		if (!removed)
+		{
+			clearDatabase();
+			return;
+		}
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException(
+			"Failed to recreate database \"" + m_databaseFilePath + "\" with message \"" + e.errorMessage() + "\".");
+	}
+
+	setupDatabase();
+}
+
+bool DatabaseStorage::isIngestLog() const
+{
+	return m_ingestLog != nullptr;
+}
+
+bool DatabaseStorage::isInMemory() const
+{
+	return m_inMemory;
+}
+
+size_t DatabaseStorage::getDatabaseSize() const
+{
+	if (m_ingestLog)
+	{
+		return 0;
+	}
+
+	const sqlite_int64 pageCount = executeQuery("PRAGMA page_count;").getInt64Field(0, 0);
+	const sqlite_int64 pageSize = executeQuery("PRAGMA page_size;").getInt64Field(0, 0);
+	return static_cast<size_t>(pageCount * pageSize);
+}
+
+void DatabaseStorage::backupToFile(const std::string& filePath, bool vacuum)
+{
+	if (m_ingestLog)
+	{
+		throw SourcetrailException("Unable to back up an ingest log.");
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "back up database");
+
+	if (m_transactionActive)
+	{
+		rollbackTransaction();
+	}
+
+	try
+	{
+		m_database.backupTo(filePath.c_str());
+
+		if (vacuum)
+		{
+			CppSQLite3DB fileDatabase;
+			fileDatabase.open(filePath.c_str());
+			fileDatabase.execDML("VACUUM;");
+			fileDatabase.close();
+		}
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException(
+			"Failed to back up database to \"" + filePath + "\" with message \"" + e.errorMessage() + "\".");
+	}
+}
+
+void DatabaseStorage::setJournalingEnabled(bool enabled)
+{
+	if (m_ingestLog || m_inMemory)
+	{
+		return;
+	}
+
+	m_journalingEnabled = enabled;
+	if (enabled)
+	{
+		executeStatement("PRAGMA journal_mode=DELETE;");
+		executeStatement("PRAGMA synchronous=FULL;");
+	}
+	else
+	{
+		executeStatement("PRAGMA journal_mode=MEMORY;");
+		executeStatement("PRAGMA synchronous=OFF;");
+	}
+}
+
+void DatabaseStorage::analyze()
+{
+	if (m_ingestLog)
+	{
+		return;
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "analyze");
+	executeStatement("ANALYZE;");
+	executeStatement("PRAGMA optimize;");
+}
+
+void DatabaseStorage::materializeIngestLog(const std::string& ingestLogFilePath)
+{
+	if (m_ingestLog)
+	{
+		throw SourcetrailException("Unable to materialize an ingest log into another ingest log.");
+	}
+
+	if (!executeQuery("SELECT id FROM element LIMIT 1;").eof())
+	{
+		throw SourcetrailException("Unable to materialize an ingest log into a database that is not empty.");
+	}
+
+	const IngestLogContents contents = IngestLog::load(ingestLogFilePath);
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "materialize ingest log");
+
+	// the rows are inserted with their final ids, so the lookup indices are only needed afterwards
+	dropIndices();
+	beginTransaction();
+	try
+	{
+		CppSQLite3Statement insertElementStatement = compileStatement("INSERT INTO element(id) VALUES(?);");
+		for (int elementId: contents.elementIds)
+		{
+			insertElementStatement.bind(1, elementId);
+			executeStatement(insertElementStatement);
+			insertElementStatement.reset();
+		}
+		insertElementStatement.finalize();
+
+		for (const StorageNode& node: contents.nodes)
+		{
+			m_insertNodeStatement.bind(1, node.id);
+			m_insertNodeStatement.bind(2, node.nodeKind);
+			m_insertNodeStatement.bind(3, node.serializedName.c_str());
+			if (m_hashKeysEnabled)
+			{
+				m_insertNodeStatement.bind(4, getHashKey(node.serializedName));
+			}
+			executeStatement(m_insertNodeStatement);
+			m_insertNodeStatement.reset();
+		}
+
+		for (const StorageSymbol& symbol: contents.symbols)
+		{
+			addSymbol(symbol);
+		}
+
+		for (const StorageFile& file: contents.files)
+		{
+			addFile(file);
+		}
+
+		for (const StorageEdge& edge: contents.edges)
+		{
+			m_insertEdgeStatement.bind(1, edge.id);
+			m_insertEdgeStatement.bind(2, edge.edgeKind);
+			m_insertEdgeStatement.bind(3, edge.sourceNodeId);
+			m_insertEdgeStatement.bind(4, edge.targetNodeId);
+			executeStatement(m_insertEdgeStatement);
+			m_insertEdgeStatement.reset();
+		}
+
+		for (const StorageLocalSymbol& localSymbol: contents.localSymbols)
+		{
+			m_insertLocalSymbolStmt.bind(1, localSymbol.id);
+			m_insertLocalSymbolStmt.bind(2, localSymbol.name.c_str());
+			executeStatement(m_insertLocalSymbolStmt);
+			m_insertLocalSymbolStmt.reset();
+		}
+
+		for (const StorageError& error: contents.errors)
+		{
+			m_insertErrorStatement.bind(1, error.id);
+			m_insertErrorStatement.bind(2, error.message.c_str());
+			m_insertErrorStatement.bind(3, error.fatal);
+			m_insertErrorStatement.bind(4, error.indexed);
+			m_insertErrorStatement.bind(5, error.translationUnit.c_str());
+			if (m_hashKeysEnabled)
+			{
+				m_insertErrorStatement.bind(6, getHashKey(error.message));
+			}
+			executeStatement(m_insertErrorStatement);
+			m_insertErrorStatement.reset();
+		}
+
+		CppSQLite3Statement insertSourceLocationStatement = compileStatement(
+			"INSERT INTO source_location("
+			"id, file_node_id, start_line, start_column, end_line, end_column, type) "
+			"VALUES(?, ?, ?, ?, ?, ?, ?);");
+		for (const StorageSourceLocation& sourceLocation: contents.sourceLocations)
+		{
+			insertSourceLocationStatement.bind(1, sourceLocation.id);
+			insertSourceLocationStatement.bind(2, sourceLocation.fileNodeId);
+			insertSourceLocationStatement.bind(3, sourceLocation.startLineNumber);
+			insertSourceLocationStatement.bind(4, sourceLocation.startColumnNumber);
+			insertSourceLocationStatement.bind(5, sourceLocation.endLineNumber);
+			insertSourceLocationStatement.bind(6, sourceLocation.endColumnNumber);
+			insertSourceLocationStatement.bind(7, sourceLocation.locationKind);
+			executeStatement(insertSourceLocationStatement);
+			insertSourceLocationStatement.reset();
+		}
+		insertSourceLocationStatement.finalize();
+
+		for (const StorageOccurrence& occurrence: contents.occurrences)
+		{
+			addOccurrence(occurrence);
+		}
+
+		for (const StorageElementComponentData& elementComponent: contents.elementComponents)
+		{
+			addElementComponent(elementComponent);
+		}
+
+		for (int fileId: contents.committedFileIds)
+		{
+			addCommittedFile(fileId);
+		}
+
+		commitTransaction();
+	}
+	catch (const SourcetrailException&)
+	{
+		rollbackTransaction();
+		setupIndices();
+		throw;
+	}
+
+	setupIndices();
+}
+
+void DatabaseStorage::setStatisticsCounters(StatisticsCounters* counters)
+{
+	m_statistics = counters;
+}
+
+void DatabaseStorage::setTraceRecorder(TraceRecorder* recorder)
+{
+	m_trace = recorder;
+}
+
+void DatabaseStorage::setHashKeysEnabled(bool enabled)
+{
+	m_hashKeysEnabled = enabled;
+}
+
+bool DatabaseStorage::getHashKeysEnabled() const
+{
+	return m_hashKeysEnabled;
+}
+
 void DatabaseStorage::setProjectSettingsText(const std::string& text)
 {
+	if (m_ingestLog)
+	{
+		return;
+	}
+
 	insertOrUpdateMetaValue("project_settings", text);
 }
 
 bool DatabaseStorage::isEmpty() const
 {
+	if (m_ingestLog)
+	{
+		return m_ingestLog->isEmpty();
+	}
+
 	const std::string tableName = "meta";
 	CppSQLite3Query q = executeQuery("SELECT name FROM sqlite_master WHERE type='table' AND name='" + tableName + "';");
 
@@ -106,6 +560,11 @@ bool DatabaseStorage::isEmpty() const
 
 bool DatabaseStorage::isCompatible() const
 {
+	if (m_ingestLog)
+	{
+		return true;
+	}
+
 	if (isEmpty())
 	{
 		return true;
@@ -116,6 +575,11 @@ bool DatabaseStorage::isCompatible() const
 
 int DatabaseStorage::getLoadedDatabaseVersion() const
 {
+	if (m_ingestLog)
+	{
+		return getSupportedDatabaseVersion();
+	}
+
 	if (isEmpty())
 	{
 		throw SourcetrailException("Unable to determine version of an empty database.");
@@ -131,255 +595,930 @@ int DatabaseStorage::getLoadedDatabaseVersion() const
 
 void DatabaseStorage::beginTransaction()
 {
+	if (m_ingestLog)
+	{
+		return;
+	}
+
 	executeStatement("BEGIN TRANSACTION;");
+	m_transactionActive = true;
+	if (m_trace)
+	{
+		m_transactionStartNanoseconds = m_trace->now();
+	}
 }
 
 void DatabaseStorage::commitTransaction()
 {
+	if (m_ingestLog)
+	{
+		return;
+	}
+
+	SOURCETRAIL_STATISTICS_MEASURE_COMMIT(m_statistics);
 	executeStatement("COMMIT TRANSACTION;");
+	m_transactionActive = false;
+	if (m_trace)
+	{
+		m_trace->addSpan("transaction", "transaction", m_transactionStartNanoseconds, m_trace->now());
+	}
 }
 
 void DatabaseStorage::rollbackTransaction()
 {
+	if (m_ingestLog)
+	{
+		throw SourcetrailException("Unable to rollback a transaction of an ingest log.");
+	}
+
 	executeStatement("ROLLBACK TRANSACTION;");
+	m_transactionActive = false;
+	if (m_trace)
+	{
+		m_trace->addSpan("transaction", "transaction (rolled back)", m_transactionStartNanoseconds, m_trace->now());
+	}
 }
 
 void DatabaseStorage::optimizeDatabaseMemory()
 {
+	if (m_ingestLog)
+	{
+		return;
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "vacuum");
 	executeStatement("VACUUM;");
 }
 
+void DatabaseStorage::optimizeDatabaseLocality()
+{
+	if (m_ingestLog)
+	{
+		throw SourcetrailException("Unable to optimize the locality of an ingest log.");
+	}
+
+	if (m_transactionActive)
+	{
+		throw SourcetrailException("Unable to optimize database locality during a transaction.");
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "cluster locations by file");
+
+	const bool hasLocationIndex = m_database.tableExists("source_location_interval");
+
+	// the rows are deleted and inserted again, which must not cascade to the occurrences
+	executeStatement("PRAGMA foreign_keys=OFF;");
+	executeStatement("SAVEPOINT cluster_locations;");
+	try
+	{
+		// the rowid of this table is the new id of each source location
+		executeStatement(
+			"CREATE TEMP TABLE source_location_order(id INTEGER PRIMARY KEY, old_id INTEGER NOT NULL);");
+		executeStatement(
+			"INSERT INTO temp.source_location_order(old_id) SELECT id FROM main.source_location "
+			"ORDER BY file_node_id, start_line, start_column, end_line, end_column, type, id;");
+		executeStatement("CREATE INDEX temp.source_location_order_old_id_index ON source_location_order(old_id);");
+
+		executeStatement(
+			"CREATE TEMP TABLE source_location_sorted AS "
+			"SELECT o.id AS id, s.file_node_id AS file_node_id, s.start_line AS start_line, "
+			"s.start_column AS start_column, s.end_line AS end_line, s.end_column AS end_column, s.type AS type "
+			"FROM temp.source_location_order o INNER JOIN main.source_location s ON s.id = o.old_id;");
+		executeStatement(
+			"CREATE TEMP TABLE occurrence_sorted AS "
+			"SELECT c.element_id AS element_id, o.id AS source_location_id "
+			"FROM main.occurrence c INNER JOIN temp.source_location_order o ON o.old_id = c.source_location_id;");
+
+		executeStatement("DELETE FROM main.occurrence;");
+		executeStatement("DELETE FROM main.source_location;");
+		executeStatement(
+			"INSERT INTO main.source_location(id, file_node_id, start_line, start_column, end_line, end_column, type) "
+			"SELECT id, file_node_id, start_line, start_column, end_line, end_column, type "
+			"FROM temp.source_location_sorted ORDER BY id;");
+		executeStatement(
+			"INSERT INTO main.occurrence(element_id, source_location_id) "
+			"SELECT element_id, source_location_id FROM temp.occurrence_sorted ORDER BY source_location_id, element_id;");
+
+		// the location index refers to the old ids and is rebuilt below
+		if (hasLocationIndex)
+		{
+			executeStatement("DELETE FROM main.source_location_interval;");
+			executeStatement(
+				"DELETE FROM main.meta WHERE key IN ('location_index_last_location_id', 'location_index_max_level');");
+		}
+
+		executeStatement("DROP TABLE temp.occurrence_sorted;");
+		executeStatement("DROP TABLE temp.source_location_sorted;");
+		executeStatement("DROP TABLE temp.source_location_order;");
+	}
+	catch (const SourcetrailException&)
+	{
+		executeStatement("ROLLBACK TO SAVEPOINT cluster_locations;");
+		executeStatement("RELEASE SAVEPOINT cluster_locations;");
+		executeStatement("PRAGMA foreign_keys=ON;");
+		throw;
+	}
+	executeStatement("RELEASE SAVEPOINT cluster_locations;");
+	executeStatement("PRAGMA foreign_keys=ON;");
+
+	if (hasLocationIndex)
+	{
+		updateLocationIndex();
+	}
+
+	optimizeDatabaseMemory();
+}
+
 int DatabaseStorage::addElementComponent(const StorageElementComponentData& storageElementComponentData)
 {
+	if (m_ingestLog)
+	{
+		return m_ingestLog->addElementComponent(storageElementComponentData);
+	}
+
 	m_insertElementComponentStatement.bind(1, storageElementComponentData.elementId);
 	m_insertElementComponentStatement.bind(2, storageElementComponentData.componentKind);
 	m_insertElementComponentStatement.bind(3, storageElementComponentData.data.c_str());
 	executeStatement(m_insertElementComponentStatement);
 	const int id = static_cast<int>(m_database.lastRowId());
 	m_insertElementComponentStatement.reset();
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::ELEMENT_COMPONENT, true);
+	return id;
+}
+
+int DatabaseStorage::addNode(const StorageNodeData& storageNodeData)
+{
+	int id = 0;
+	throwIfFailed(tryAddNode(storageNodeData, id));
+	return id;
+}
+
+StorageStatus DatabaseStorage::tryAddNode(const StorageNodeData& storageNodeData, int& id)
+{
+	return tryAddNode(storageNodeData.nodeKind, storageNodeData.serializedName, id);
+}
+
+StorageStatus DatabaseStorage::tryAddNode(int nodeKind, const std::string& serializedName, int& id)
+{
+	if (m_ingestLog)
+	{
+		id = m_ingestLog->addNode(nodeKind, serializedName);
+		return StorageStatus();
+	}
+
+	const sqlite_int64 serializedNameHash = m_hashKeysEnabled ? getHashKey(serializedName) : 0;
+	if (m_hashKeysEnabled)
+	{
+		m_findNodeStatement.bind(1, serializedNameHash);
+		m_findNodeStatement.bind(2, serializedName.c_str());
+	}
+	else
+	{
+		m_findNodeStatement.bind(1, serializedName.c_str());
+	}
+	StorageStatus status = tryFindId(m_findNodeStatement, StorageStatement::FIND_NODE, id);
+	if (!status.isOk())
+	{
+		return status;
+	}
+
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::NODE, id == 0);
+
+	// FIXME: update node nodeKind here
+
+	if (id == 0)
+	{
+		status = tryInsertElement(id);
+		if (!status.isOk())
+		{
+			return status;
+		}
+
+		m_insertNodeStatement.bind(1, id);
+		m_insertNodeStatement.bind(2, nodeKind);
+		m_insertNodeStatement.bind(3, serializedName.c_str());
+		if (m_hashKeysEnabled)
+		{
+			m_insertNodeStatement.bind(4, serializedNameHash);
+		}
+		status = tryExecuteStatement(m_insertNodeStatement, StorageStatement::INSERT_NODE);
+	}
+	return status;
+}
+
+void DatabaseStorage::addSymbol(const StorageSymbol& storageSymbol)
+{
+	throwIfFailed(tryAddSymbol(storageSymbol));
+}
+
+StorageStatus DatabaseStorage::tryAddSymbol(const StorageSymbol& storageSymbol)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->addSymbol(storageSymbol);
+		return StorageStatus();
+	}
+
+	m_insertSymbolStatement.bind(1, storageSymbol.id);
+	m_insertSymbolStatement.bind(2, storageSymbol.definitionKind);
+	int changedRowCount = 0;
+	const StorageStatus status = tryExecuteStatement(
+		m_insertSymbolStatement, StorageStatement::INSERT_SYMBOL, &changedRowCount);
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::SYMBOL, changedRowCount > 0);
+	return status;
+}
+
+void DatabaseStorage::addFile(const StorageFile& storageFile)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->addFile(storageFile);
+		return;
+	}
+
+	{
+		m_findFileStatement.bind(1, storageFile.id);
+		CppSQLite3Query q = executeQuery(m_findFileStatement);
+		bool exists = !q.eof();
+		m_findFileStatement.reset();
+		SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::FILE, !exists);
+		if (exists)
+		{
+			return;
+		}
+	}
+
+	std::string content = "";
+	{
+		const TraceRecorder::Scope traceScope(m_trace, "storage", "read file");
+		if (utility::getFileExists(storageFile.filePath))
+		{
+			content = utility::getFileContent(storageFile.filePath);
+		}
+	}
+
+	int lineCount = 0;
+	{
+		const TraceRecorder::Scope traceScope(m_trace, "storage", "count lines");
+		lineCount = utility::getLineCount(content);
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "insert file");
+	{
+		m_insertFileStatement.bind(1, storageFile.id);
+		m_insertFileStatement.bind(2, storageFile.filePath.c_str());
+		m_insertFileStatement.bind(3, storageFile.languageIdentifier.c_str());
+		m_insertFileStatement.bind(4, storageFile.modificationTime.c_str());
+		m_insertFileStatement.bind(5, storageFile.indexed);
+		m_insertFileStatement.bind(6, storageFile.complete);
+		m_insertFileStatement.bind(7, lineCount);
+		executeStatement(m_insertFileStatement);
+		m_insertFileStatement.reset();
+	}
+
+	if (!content.empty())
+	{
+		m_insertFileContentStatement.bind(1, storageFile.id);
+		m_insertFileContentStatement.bind(2, content.c_str());
+		executeStatement(m_insertFileContentStatement);
+		m_insertFileContentStatement.reset();
+		SOURCETRAIL_STATISTICS_ADD_FILE_CONTENT_BYTES(m_statistics, content.size());
+	}
+}
+
+int DatabaseStorage::addEdge(const StorageEdgeData& storageEdgeData)
+{
+	int id = 0;
+	throwIfFailed(tryAddEdge(storageEdgeData, id));
+	return id;
+}
+
+StorageStatus DatabaseStorage::tryAddEdge(const StorageEdgeData& storageEdgeData, int& id)
+{
+	if (m_ingestLog)
+	{
+		id = m_ingestLog->addEdge(storageEdgeData);
+		return StorageStatus();
+	}
+
+	m_findEdgeStatement.bind(1, storageEdgeData.sourceNodeId);
+	m_findEdgeStatement.bind(2, storageEdgeData.targetNodeId);
+	m_findEdgeStatement.bind(3, storageEdgeData.edgeKind);
+	StorageStatus status = tryFindId(m_findEdgeStatement, StorageStatement::FIND_EDGE, id);
+	if (!status.isOk())
+	{
+		return status;
+	}
+
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::EDGE, id == 0);
+	if (id == 0)
+	{
+		status = tryInsertElement(id);
+		if (!status.isOk())
+		{
+			return status;
+		}
+
+		m_insertEdgeStatement.bind(1, id);
+		m_insertEdgeStatement.bind(2, storageEdgeData.edgeKind);
+		m_insertEdgeStatement.bind(3, storageEdgeData.sourceNodeId);
+		m_insertEdgeStatement.bind(4, storageEdgeData.targetNodeId);
+		status = tryExecuteStatement(m_insertEdgeStatement, StorageStatement::INSERT_EDGE);
+	}
+	return status;
+}
+
+int DatabaseStorage::addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData)
+{
+	int id = 0;
+	throwIfFailed(tryAddLocalSymbol(storageLocalSymbolData, id));
+	return id;
+}
+
+StorageStatus DatabaseStorage::tryAddLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData, int& id)
+{
+	if (m_ingestLog)
+	{
+		id = m_ingestLog->addLocalSymbol(storageLocalSymbolData);
+		return StorageStatus();
+	}
+
+	m_findLocalSymbolStmt.bind(1, storageLocalSymbolData.name.c_str());
+	StorageStatus status = tryFindId(m_findLocalSymbolStmt, StorageStatement::FIND_LOCAL_SYMBOL, id);
+	if (!status.isOk())
+	{
+		return status;
+	}
+
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::LOCAL_SYMBOL, id == 0);
+	if (id == 0)
+	{
+		status = tryInsertElement(id);
+		if (!status.isOk())
+		{
+			return status;
+		}
+
+		m_insertLocalSymbolStmt.bind(1, id);
+		m_insertLocalSymbolStmt.bind(2, storageLocalSymbolData.name.c_str());
+		status = tryExecuteStatement(m_insertLocalSymbolStmt, StorageStatement::INSERT_LOCAL_SYMBOL);
+	}
+	return status;
+}
+
+int DatabaseStorage::addSourceLocation(const StorageSourceLocationData& storageSourceLocationData)
+{
+	int id = 0;
+	throwIfFailed(tryAddSourceLocation(storageSourceLocationData, id));
+	return id;
+}
+
+StorageStatus DatabaseStorage::tryAddSourceLocation(const StorageSourceLocationData& storageSourceLocationData, int& id)
+{
+	if (m_ingestLog)
+	{
+		id = m_ingestLog->addSourceLocation(storageSourceLocationData);
+		return StorageStatus();
+	}
+
+	m_findSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
+	m_findSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
+	m_findSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
+	m_findSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
+	m_findSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
+	m_findSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
+	StorageStatus status = tryFindId(m_findSourceLocationStmt, StorageStatement::FIND_SOURCE_LOCATION, id);
+	if (!status.isOk())
+	{
+		return status;
+	}
+
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::SOURCE_LOCATION, id == 0);
+	if (id == 0)
+	{
+		m_insertSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
+		m_insertSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
+		m_insertSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
+		m_insertSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
+		m_insertSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
+		m_insertSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
+		status = tryExecuteStatement(m_insertSourceLocationStmt, StorageStatement::INSERT_SOURCE_LOCATION);
+		if (status.isOk())
+		{
+			id = static_cast<int>(m_database.lastRowId());
+		}
+	}
+	return status;
+}
+
+void DatabaseStorage::addOccurrence(const StorageOccurrence& storageOccurrence)
+{
+	throwIfFailed(tryAddOccurrence(storageOccurrence));
+}
+
+StorageStatus DatabaseStorage::tryAddOccurrence(const StorageOccurrence& storageOccurrence)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->addOccurrence(storageOccurrence);
+		return StorageStatus();
+	}
+
+	m_insertOccurenceStmt.bind(1, storageOccurrence.elementId);
+	m_insertOccurenceStmt.bind(2, storageOccurrence.sourceLocationId);
+	int changedRowCount = 0;
+	const StorageStatus status = tryExecuteStatement(
+		m_insertOccurenceStmt, StorageStatement::INSERT_OCCURRENCE, &changedRowCount);
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::OCCURRENCE, changedRowCount > 0);
+	return status;
+}
+
+int DatabaseStorage::addError(const StorageErrorData& storageErrorData)
+{
+	if (m_ingestLog)
+	{
+		return m_ingestLog->addError(storageErrorData);
+	}
+
+	const sqlite_int64 messageHash = m_hashKeysEnabled ? getHashKey(storageErrorData.message) : 0;
+	int id = 0;
+	{
+		int parameterIndex = 1;
+		if (m_hashKeysEnabled)
+		{
+			m_findErrorStatement.bind(parameterIndex++, messageHash);
+		}
+		m_findErrorStatement.bind(parameterIndex++, storageErrorData.message.c_str());
+		m_findErrorStatement.bind(parameterIndex++, storageErrorData.fatal);
+		CppSQLite3Query q = executeQuery(m_findErrorStatement);
+		if (!q.eof() && q.numFields() > 0)
+		{
+			id = q.getIntField(0, -1);
+		}
+		m_findErrorStatement.reset();
+	}
+
+	SOURCETRAIL_STATISTICS_ADD_ROW(m_statistics, WriterTable::ERROR_ENTRY, id == 0);
+	if (id == 0)
+	{
+		id = insertElement();
+
+		m_insertErrorStatement.bind(1, id);
+		m_insertErrorStatement.bind(2, storageErrorData.message.c_str());
+		m_insertErrorStatement.bind(3, storageErrorData.fatal);
+		m_insertErrorStatement.bind(4, storageErrorData.indexed);
+		m_insertErrorStatement.bind(5, storageErrorData.translationUnit.c_str());
+		if (m_hashKeysEnabled)
+		{
+			m_insertErrorStatement.bind(6, messageHash);
+		}
+		executeStatement(m_insertErrorStatement);
+		id = static_cast<int>(m_database.lastRowId());
+		m_insertErrorStatement.reset();
+	}
 	return id;
 }
 
-int DatabaseStorage::addNode(const StorageNodeData& storageNodeData)
+void DatabaseStorage::setNodeType(int nodeId, int nodeType)
+{
+	throwIfFailed(trySetNodeType(nodeId, nodeType));
+}
+
+StorageStatus DatabaseStorage::trySetNodeType(int nodeId, int nodeType)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->setNodeType(nodeId, nodeType);
+		return StorageStatus();
+	}
+
+	m_setNodeTypeStmt.bind(1, nodeType);
+	m_setNodeTypeStmt.bind(2, nodeId);
+	return tryExecuteStatement(m_setNodeTypeStmt, StorageStatement::SET_NODE_TYPE);
+}
+
+void DatabaseStorage::setFileLanguage(int fileId, const std::string& languageIdentifier)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->setFileLanguage(fileId, languageIdentifier);
+		return;
+	}
+
+	m_setFileLanguageStmt.bind(1, languageIdentifier.c_str());
+	m_setFileLanguageStmt.bind(2, fileId);
+	executeStatement(m_setFileLanguageStmt);
+	m_setFileLanguageStmt.reset();
+}
+
+void DatabaseStorage::addCommittedFile(int fileId)
+{
+	if (m_ingestLog)
+	{
+		m_ingestLog->addCommittedFile(fileId);
+		return;
+	}
+
+	m_insertCommittedFileStmt.bind(1, fileId);
+	executeStatement(m_insertCommittedFileStmt);
+	m_insertCommittedFileStmt.reset();
+}
+
+std::vector<std::string> DatabaseStorage::getCommittedFilePaths() const
+{
+	if (m_ingestLog)
+	{
+		return m_ingestLog->getCommittedFilePaths();
+	}
+
+	std::vector<std::string> filePaths;
+	CppSQLite3Query q = executeQuery(
+		"SELECT file.path FROM committed_file INNER JOIN file ON file.id = committed_file.file_id ORDER BY file.id;");
+	while (!q.eof())
+	{
+		filePaths.push_back(q.getStringField(0, ""));
+		q.nextRow();
+	}
+	return filePaths;
+}
+
+void DatabaseStorage::updateNameIndex()
 {
-	int id = 0;
+	if (m_ingestLog)
+	{
+		throw SourcetrailException("Unable to update the name index of an ingest log.");
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "update name index");
+
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS node_name_index("
+		"	token TEXT NOT NULL, "
+		"	node_id INTEGER NOT NULL, "
+		"	is_name INTEGER NOT NULL, "
+		"	PRIMARY KEY(token, node_id)"
+		") WITHOUT ROWID;");
+
+	// indices built before the names and trigrams were added get them by indexing all nodes again
+	const bool hasTrigrams = m_database.tableExists("node_name_trigram");
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS node_name("
+		"	node_id INTEGER NOT NULL, "
+		"	name TEXT NOT NULL, "
+		"	PRIMARY KEY(node_id)"
+		");");
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS node_name_trigram("
+		"	trigram TEXT NOT NULL, "
+		"	node_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(trigram, node_id)"
+		") WITHOUT ROWID;");
 
+	int lastIndexedNodeId = 0;
+	if (hasTrigrams)
 	{
-		m_findNodeStatement.bind(1, storageNodeData.serializedName.c_str());
-		CppSQLite3Query q = executeQuery(m_findNodeStatement);
+		CppSQLite3Query q = executeQuery("SELECT value FROM meta WHERE key = 'name_index_last_node_id';");
 		if (!q.eof())
 		{
-			id = q.getIntField(0, 0);
+			lastIndexedNodeId = std::stoi(q.getStringField(0, "0"));
 		}
-		m_findNodeStatement.reset();
 	}
 
-	// FIXME: update node nodeKind here
-
-	if (id == 0)
+	const bool ownTransaction = m_database.IsAutoCommitOn();
+	if (ownTransaction)
 	{
-		id = insertElement();
-
-		m_insertNodeStatement.bind(1, id);
-		m_insertNodeStatement.bind(2, storageNodeData.nodeKind);
-		m_insertNodeStatement.bind(3, storageNodeData.serializedName.c_str());
-		executeStatement(m_insertNodeStatement);
-		m_insertNodeStatement.reset();
+		beginTransaction();
 	}
-	return id;
-}
 
-void DatabaseStorage::addSymbol(const StorageSymbol& storageSymbol)
-{
-	m_insertSymbolStatement.bind(1, storageSymbol.id);
-	m_insertSymbolStatement.bind(2, storageSymbol.definitionKind);
-	executeStatement(m_insertSymbolStatement);
-	m_insertSymbolStatement.reset();
-}
+	CppSQLite3Statement insertTokenStmt = compileStatement(
+		"INSERT OR IGNORE INTO node_name_index(token, node_id, is_name) VALUES(?, ?, ?);");
+	CppSQLite3Statement insertNameStmt = compileStatement(
+		"INSERT OR IGNORE INTO node_name(node_id, name) VALUES(?, ?);");
 
-void DatabaseStorage::addFile(const StorageFile& storageFile)
-{
+	StringRef nameDelimiter;
+	std::vector<NameElementRef> nameElements;
+
+	const int firstUnindexedNodeId = lastIndexedNodeId;
+	CppSQLite3Statement findNodesStmt = compileStatement("SELECT id, serialized_name FROM node WHERE id > ? ORDER BY id;");
+	findNodesStmt.bind(1, lastIndexedNodeId);
+	CppSQLite3Query q = executeQuery(findNodesStmt);
+	while (!q.eof())
 	{
-		m_findFileStatement.bind(1, storageFile.id);
-		CppSQLite3Query q = executeQuery(m_findFileStatement);
-		bool exists = !q.eof();
-		m_findFileStatement.reset();
-		if (exists)
+		const int nodeId = q.getIntField(0, 0);
+		const char* serializedName = q.getStringField(1, "");
+
+		if (parseNameHierarchyDatabaseString(serializedName, strlen(serializedName), nameDelimiter, nameElements) &&
+			!nameElements.empty() && nameElements.back().name.size > 0)
 		{
-			return;
+			const std::string name = nameElements.back().name.toString();
+			const std::string lowerName = utility::toLowerCase(name);
+
+			insertNameStmt.bind(1, nodeId);
+			insertNameStmt.bind(2, lowerName.c_str());
+			executeStatement(insertNameStmt);
+			insertNameStmt.reset();
+
+			// the full name is inserted first, so it is kept if it coincides with one of its tokens
+			insertTokenStmt.bind(1, lowerName.c_str());
+			insertTokenStmt.bind(2, nodeId);
+			insertTokenStmt.bind(3, 1);
+			executeStatement(insertTokenStmt);
+			insertTokenStmt.reset();
+
+			for (const std::string& token: utility::getLowerCaseNameTokens(name))
+			{
+				insertTokenStmt.bind(1, token.c_str());
+				insertTokenStmt.bind(2, nodeId);
+				insertTokenStmt.bind(3, 0);
+				executeStatement(insertTokenStmt);
+				insertTokenStmt.reset();
+			}
 		}
-	}
 
-	std::string content = "";
-	if (utility::getFileExists(storageFile.filePath))
+		lastIndexedNodeId = nodeId;
+		q.nextRow();
+	}
+	findNodesStmt.reset();
+
+	// Splitting the new names into trigrams within SQLite and inserting them in key order is much faster than
+	// inserting each trigram with its own statement. substr() counts characters, not bytes.
+	CppSQLite3Statement insertTrigramsStmt = compileStatement(
+		"WITH RECURSIVE position(i) AS ("
+		"	SELECT 1 UNION ALL SELECT i + 1 FROM position "
+		"	WHERE i < (SELECT max(length(name)) FROM node_name WHERE node_id > ?1)"
+		") "
+		"INSERT OR IGNORE INTO node_name_trigram(trigram, node_id) "
+		"SELECT substr(name, i, 3), node_id FROM node_name CROSS JOIN position "
+		"WHERE node_id > ?1 AND i + 2 <= length(name) ORDER BY 1, 2;");
+	insertTrigramsStmt.bind(1, firstUnindexedNodeId);
+	executeStatement(insertTrigramsStmt);
+
+	insertOrUpdateMetaValue("name_index_last_node_id", std::to_string(lastIndexedNodeId));
+
+	if (ownTransaction)
 	{
-		content = utility::getFileContent(storageFile.filePath);
+		commitTransaction();
 	}
-	const int lineCount = utility::getLineCount(content);
+}
 
+std::vector<int> DatabaseStorage::findNodeIdsByNamePrefix(const std::string& prefix, int maxResultCount) const
+{
+	if (!m_database.tableExists("node_name_index"))
 	{
-		m_insertFileStatement.bind(1, storageFile.id);
-		m_insertFileStatement.bind(2, storageFile.filePath.c_str());
-		m_insertFileStatement.bind(3, storageFile.languageIdentifier.c_str());
-		m_insertFileStatement.bind(4, storageFile.modificationTime.c_str());
-		m_insertFileStatement.bind(5, storageFile.indexed);
-		m_insertFileStatement.bind(6, storageFile.complete);
-		m_insertFileStatement.bind(7, lineCount);
-		executeStatement(m_insertFileStatement);
-		m_insertFileStatement.reset();
+		throw SourcetrailException("Unable to search node names, because the name index has not been built.");
 	}
 
-	if (!content.empty())
+	// 0xFF never occurs in UTF-8 text, so it sorts after every token starting with the prefix
+	const std::string lowerPrefix = utility::toLowerCase(prefix);
+	const std::string upperBound = lowerPrefix + '\xff';
+
+	CppSQLite3Statement stmt = compileStatement(
+		"SELECT DISTINCT node_id FROM node_name_index WHERE token >= ? AND token < ? LIMIT ?;");
+	stmt.bind(1, lowerPrefix.c_str());
+	stmt.bind(2, upperBound.c_str());
+	stmt.bind(3, maxResultCount > 0 ? maxResultCount : -1);
+
+	std::vector<int> nodeIds;
+	CppSQLite3Query q = executeQuery(stmt);
+	while (!q.eof())
 	{
-		m_insertFileContentStatement.bind(1, storageFile.id);
-		m_insertFileContentStatement.bind(2, content.c_str());
-		executeStatement(m_insertFileContentStatement);
-		m_insertFileContentStatement.reset();
+		nodeIds.push_back(q.getIntField(0, 0));
+		q.nextRow();
 	}
+	return nodeIds;
 }
 
-int DatabaseStorage::addEdge(const StorageEdgeData& storageEdgeData)
+std::vector<int> DatabaseStorage::findNodeIdsByNameSubstring(const std::string& substring, int maxResultCount) const
 {
-	int id = 0;
+	if (!m_database.tableExists("node_name_trigram"))
+	{
+		throw SourcetrailException("Unable to search node names, because the name index has not been built.");
+	}
 
+	const std::string lowerSubstring = utility::toLowerCase(substring);
+
+	// Names containing the substring contain all of its trigrams, so only the nodes listed for its least frequent
+	// trigram need to be compared. Counting stops at a bound, so estimating the frequencies stays cheap for trigrams
+	// that occur in most names. Shorter substrings scan all names.
+	std::string rarestTrigram;
+	if (lowerSubstring.size() >= 3)
 	{
-		m_findEdgeStatement.bind(1, storageEdgeData.sourceNodeId);
-		m_findEdgeStatement.bind(2, storageEdgeData.targetNodeId);
-		m_findEdgeStatement.bind(3, storageEdgeData.edgeKind);
-		CppSQLite3Query q = executeQuery(m_findEdgeStatement);
-		if (!q.eof())
+		CppSQLite3Statement countStmt = compileStatement(
+			"SELECT COUNT(*) FROM (SELECT 1 FROM node_name_trigram WHERE trigram = ? LIMIT 10000);");
+		int rarestCount = 0;
+		// the trigrams consist of 3 UTF-8 characters, like the ones created by substr() in updateNameIndex()
+		std::vector<size_t> characterOffsets;
+		for (size_t i = 0; i < lowerSubstring.size(); i++)
+		{
+			if ((static_cast<unsigned char>(lowerSubstring[i]) & 0xC0) != 0x80)
+			{
+				characterOffsets.push_back(i);
+			}
+		}
+		characterOffsets.push_back(lowerSubstring.size());
+
+		for (size_t i = 0; i + 3 < characterOffsets.size(); i++)
 		{
-			id = q.getIntField(0, 0);
+			const std::string trigram = lowerSubstring.substr(characterOffsets[i], characterOffsets[i + 3] - characterOffsets[i]);
+			countStmt.bind(1, trigram.c_str());
+			CppSQLite3Query q = executeQuery(countStmt);
+			const int count = q.getIntField(0, 0);
+			countStmt.reset();
+
+			if (rarestTrigram.empty() || count < rarestCount)
+			{
+				rarestTrigram = trigram;
+				rarestCount = count;
+			}
+			if (count == 0)
+			{
+				return std::vector<int>();
+			}
 		}
-		m_findEdgeStatement.reset();
 	}
 
-	if (id == 0)
+	CppSQLite3Statement stmt;
+	int parameterIndex = 1;
+	if (!rarestTrigram.empty())
 	{
-		id = insertElement();
+		stmt = compileStatement(
+			"SELECT n.node_id FROM node_name_trigram t CROSS JOIN node_name n "
+			"WHERE t.trigram = ? AND n.node_id = t.node_id AND instr(n.name, ?) > 0 LIMIT ?;");
+		stmt.bind(parameterIndex++, rarestTrigram.c_str());
+	}
+	else
+	{
+		stmt = compileStatement("SELECT node_id FROM node_name WHERE instr(name, ?) > 0 LIMIT ?;");
+	}
+	stmt.bind(parameterIndex++, lowerSubstring.c_str());
+	stmt.bind(parameterIndex, maxResultCount > 0 ? maxResultCount : -1);
 
-		m_insertEdgeStatement.bind(1, id);
-		m_insertEdgeStatement.bind(2, storageEdgeData.edgeKind);
-		m_insertEdgeStatement.bind(3, storageEdgeData.sourceNodeId);
-		m_insertEdgeStatement.bind(4, storageEdgeData.targetNodeId);
-		executeStatement(m_insertEdgeStatement);
-		m_insertEdgeStatement.reset();
+	std::vector<int> nodeIds;
+	CppSQLite3Query q = executeQuery(stmt);
+	while (!q.eof())
+	{
+		nodeIds.push_back(q.getIntField(0, 0));
+		q.nextRow();
 	}
-	return id;
+	return nodeIds;
 }
 
-int DatabaseStorage::addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData)
+void DatabaseStorage::updateLocationIndex()
 {
-	int id = 0;
-
+	if (m_ingestLog)
 	{
-		m_findLocalSymbolStmt.bind(1, storageLocalSymbolData.name.c_str());
-		CppSQLite3Query q = executeQuery(m_findLocalSymbolStmt);
-		if (!q.eof())
-		{
-			id = q.getIntField(0, 0);
-		}
-		m_findLocalSymbolStmt.reset();
+		throw SourcetrailException("Unable to update the location index of an ingest log.");
 	}
 
-	if (id == 0)
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "update location index");
+
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS source_location_interval("
+		"	file_node_id INTEGER NOT NULL, "
+		"	level INTEGER NOT NULL, "
+		"	start_line INTEGER NOT NULL, "
+		"	end_line INTEGER NOT NULL, "
+		"	source_location_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(file_node_id, level, start_line, source_location_id)"
+		") WITHOUT ROWID;");
+
+	int lastIndexedLocationId = 0;
+	int maxLevel = -1;
 	{
-		id = insertElement();
+		CppSQLite3Query q = executeQuery(
+			"SELECT "
+			"(SELECT value FROM meta WHERE key = 'location_index_last_location_id'), "
+			"(SELECT value FROM meta WHERE key = 'location_index_max_level');");
+		lastIndexedLocationId = std::stoi(q.getStringField(0, "0"));
+		maxLevel = std::stoi(q.getStringField(1, "-1"));
+	}
 
-		m_insertLocalSymbolStmt.bind(1, id);
-		m_insertLocalSymbolStmt.bind(2, storageLocalSymbolData.name.c_str());
-		executeStatement(m_insertLocalSymbolStmt);
-		m_insertLocalSymbolStmt.reset();
+	const bool ownTransaction = m_database.IsAutoCommitOn();
+	if (ownTransaction)
+	{
+		beginTransaction();
 	}
-	return id;
-}
 
-int DatabaseStorage::addSourceLocation(const StorageSourceLocationData& storageSourceLocationData)
-{
-	int id = 0;
+	CppSQLite3Statement insertIntervalStmt = compileStatement(
+		"INSERT OR IGNORE INTO source_location_interval(file_node_id, level, start_line, end_line, source_location_id) "
+		"VALUES(?, ?, ?, ?, ?);");
 
+	CppSQLite3Statement findLocationsStmt = compileStatement(
+		"SELECT id, file_node_id, start_line, end_line FROM source_location WHERE id > ? ORDER BY id;");
+	findLocationsStmt.bind(1, lastIndexedLocationId);
+	CppSQLite3Query q = executeQuery(findLocationsStmt);
+	while (!q.eof())
 	{
-		m_findSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
-		m_findSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
-		m_findSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
-		m_findSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
-		m_findSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
-		m_findSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
-		CppSQLite3Query q = executeQuery(m_findSourceLocationStmt);
-		if (!q.eof())
-		{
-			id = q.getIntField(0, 0);
-		}
-		m_findSourceLocationStmt.reset();
+		const int locationId = q.getIntField(0, 0);
+		const int startLine = q.getIntField(2, 0);
+		const int endLine = q.getIntField(3, 0);
+		const int level = getLineSpanLevel(startLine, endLine);
+
+		insertIntervalStmt.bind(1, q.getIntField(1, 0));
+		insertIntervalStmt.bind(2, level);
+		insertIntervalStmt.bind(3, startLine);
+		insertIntervalStmt.bind(4, endLine);
+		insertIntervalStmt.bind(5, locationId);
+		executeStatement(insertIntervalStmt);
+		insertIntervalStmt.reset();
+
+		maxLevel = std::max(maxLevel, level);
+		lastIndexedLocationId = locationId;
+		q.nextRow();
 	}
+	findLocationsStmt.reset();
 
-	if (id == 0)
+	insertOrUpdateMetaValue("location_index_last_location_id", std::to_string(lastIndexedLocationId));
+	insertOrUpdateMetaValue("location_index_max_level", std::to_string(maxLevel));
+
+	if (ownTransaction)
 	{
-		m_insertSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
-		m_insertSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
-		m_insertSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
-		m_insertSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
-		m_insertSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
-		m_insertSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
-		executeStatement(m_insertSourceLocationStmt);
-		id = static_cast<int>(m_database.lastRowId());
-		m_insertSourceLocationStmt.reset();
+		commitTransaction();
 	}
-	return id;
 }
 
-void DatabaseStorage::addOccurrence(const StorageOccurrence& storageOccurrence)
+std::vector<StorageSourceLocation> DatabaseStorage::getLocationsAt(int fileId, int line, int column) const
 {
-	m_insertOccurenceStmt.bind(1, storageOccurrence.elementId);
-	m_insertOccurenceStmt.bind(2, storageOccurrence.sourceLocationId);
-	executeStatement(m_insertOccurenceStmt);
-	m_insertOccurenceStmt.reset();
-}
+	if (!m_database.tableExists("source_location_interval"))
+	{
+		throw SourcetrailException("Unable to find locations, because the location index has not been built.");
+	}
 
-int DatabaseStorage::addError(const StorageErrorData& storageErrorData)
-{
-	int id = 0;
+	int maxLevel = -1;
 	{
-		m_findErrorStatement.bind(1, storageErrorData.message.c_str());
-		m_findErrorStatement.bind(2, storageErrorData.fatal);
-		CppSQLite3Query q = executeQuery(m_findErrorStatement);
-		if (!q.eof() && q.numFields() > 0)
+		CppSQLite3Query q = executeQuery("SELECT value FROM meta WHERE key = 'location_index_max_level';");
+		if (!q.eof())
 		{
-			id = q.getIntField(0, -1);
+			maxLevel = std::stoi(q.getStringField(0, "-1"));
 		}
-		m_findErrorStatement.reset();
 	}
 
-	if (id == 0)
+	// one short range scan per level: a location of level L can only cover the line if it starts at most
+	// 2^L - 1 lines before it
+	CppSQLite3Statement stmt = compileStatement(
+		"SELECT s.id, s.file_node_id, s.start_line, s.start_column, s.end_line, s.end_column, s.type "
+		"FROM source_location_interval AS i JOIN source_location AS s ON s.id = i.source_location_id "
+		"WHERE i.file_node_id = ?1 AND i.level = ?2 AND i.start_line BETWEEN ?3 AND ?4 AND i.end_line >= ?4 "
+		"AND (s.start_line < ?4 OR s.start_column <= ?5) AND (s.end_line > ?4 OR s.end_column >= ?5);");
+
+	std::vector<StorageSourceLocation> sourceLocations;
+	for (int level = 0; level <= maxLevel; level++)
 	{
-		id = insertElement();
+		const long long maxSpan = (1LL << level) - 1;
+		stmt.bind(1, fileId);
+		stmt.bind(2, level);
+		stmt.bind(3, static_cast<int>(std::max<long long>(line - maxSpan, 0)));
+		stmt.bind(4, line);
+		stmt.bind(5, column);
+
+		CppSQLite3Query q = executeQuery(stmt);
+		while (!q.eof())
+		{
+			sourceLocations.emplace_back(StorageSourceLocation(
+				q.getIntField(0, 0),
+				q.getIntField(1, 0),
+				q.getIntField(2, -1),
+				q.getIntField(3, -1),
+				q.getIntField(4, -1),
+				q.getIntField(5, -1),
+				q.getIntField(6, -1)));
+			q.nextRow();
+		}
+		stmt.reset();
+	}
+	return sourceLocations;
+}
 
-		m_insertErrorStatement.bind(1, id);
-		m_insertErrorStatement.bind(2, storageErrorData.message.c_str());
-		m_insertErrorStatement.bind(3, storageErrorData.fatal);
-		m_insertErrorStatement.bind(4, storageErrorData.indexed);
-		m_insertErrorStatement.bind(5, storageErrorData.translationUnit.c_str());
-		executeStatement(m_insertErrorStatement);
-		id = static_cast<int>(m_database.lastRowId());
-		m_insertErrorStatement.reset();
+void DatabaseStorage::forEachNode(
+	const std::function<void(int nodeId, int nodeKind, const char* serializedName, size_t serializedNameSize)>& callback) const
+{
+	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node ORDER BY id;");
+	while (!q.eof())
+	{
+		const char* serializedName = q.getStringField(2, "");
+		callback(q.getIntField(0, 0), q.getIntField(1, 0), serializedName, strlen(serializedName));
+		q.nextRow();
 	}
-	return id;
 }
 
-void DatabaseStorage::setNodeType(int nodeId, int nodeType)
+void DatabaseStorage::forEachNodeKind(const std::function<void(int nodeId, int nodeKind)>& callback) const
 {
-	m_setNodeTypeStmt.bind(1, nodeType);
-	m_setNodeTypeStmt.bind(2, nodeId);
-	executeStatement(m_setNodeTypeStmt);
-	m_setNodeTypeStmt.reset();
+	CppSQLite3Query q = executeQuery("SELECT id, type FROM node ORDER BY id;");
+	while (!q.eof())
+	{
+		callback(q.getIntField(0, 0), q.getIntField(1, 0));
+		q.nextRow();
+	}
 }
 
-void DatabaseStorage::setFileLanguage(int fileId, const std::string& languageIdentifier)
+void DatabaseStorage::forEachEdge(const std::function<void(int edgeId, int sourceNodeId, int targetNodeId, int edgeKind)>& callback) const
 {
-	m_setFileLanguageStmt.bind(1, languageIdentifier.c_str());
-	m_setFileLanguageStmt.bind(2, fileId);
-	executeStatement(m_setFileLanguageStmt);
-	m_setFileLanguageStmt.reset();
+	CppSQLite3Query q = executeQuery("SELECT id, source_node_id, target_node_id, type FROM edge ORDER BY id;");
+	while (!q.eof())
+	{
+		callback(q.getIntField(0, 0), q.getIntField(1, 0), q.getIntField(2, 0), q.getIntField(3, 0));
+		q.nextRow();
+	}
 }
 
 // --- Private Interface ---
@@ -509,12 +1648,24 @@ void DatabaseStorage::setupTables()
 		"	PRIMARY KEY(id), "
 		"	FOREIGN KEY(id) REFERENCES element(id) ON DELETE CASCADE"
 		");");
+
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS committed_file("
+		"	file_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(file_id), "
+		"	FOREIGN KEY(file_id) REFERENCES file(id) ON DELETE CASCADE"
+		");");
 }
 
 void DatabaseStorage::clearTables()
 {
 	const std::vector<std::string> tableNames = {
 		"meta",
+		"committed_file",
+		"node_name_trigram",
+		"node_name",
+		"node_name_index",
+		"source_location_interval",
 		"error",
 		"component_access",
 		"occurrence",
@@ -536,7 +1687,16 @@ void DatabaseStorage::clearTables()
 
 void DatabaseStorage::setupIndices()
 {
-	executeStatement("CREATE INDEX IF NOT EXISTS node_serialized_name_index ON node(serialized_name);");
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "create indices");
+
+	if (m_hashKeysEnabled)
+	{
+		executeStatement("CREATE INDEX IF NOT EXISTS node_serialized_name_hash_index ON node(serialized_name_hash);");
+	}
+	else
+	{
+		executeStatement("CREATE INDEX IF NOT EXISTS node_serialized_name_index ON node(serialized_name);");
+	}
 
 	executeStatement("CREATE INDEX IF NOT EXISTS edge_source_target_type_index ON edge(source_node_id, target_node_id, type);");
 
@@ -546,7 +1706,117 @@ void DatabaseStorage::setupIndices()
 		"CREATE INDEX IF NOT EXISTS source_location_all_data_index "
 		"ON source_location(file_node_id, start_line, start_column, end_line, end_column, type);");
 
-	executeStatement("CREATE INDEX IF NOT EXISTS error_all_data_index ON error(message, fatal);");
+	if (m_hashKeysEnabled)
+	{
+		executeStatement("CREATE INDEX IF NOT EXISTS error_message_hash_index ON error(message_hash);");
+	}
+	else
+	{
+		executeStatement("CREATE INDEX IF NOT EXISTS error_all_data_index ON error(message, fatal);");
+	}
+}
+
+void DatabaseStorage::dropIndices()
+{
+	const std::vector<std::string> indexNames = {
+		"node_serialized_name_index",
+		"node_serialized_name_hash_index",
+		"edge_source_target_type_index",
+		"local_symbol_name_index",
+		"source_location_all_data_index",
+		"error_all_data_index",
+		"error_message_hash_index"};
+
+	for (const std::string& indexName: indexNames)
+	{
+		executeStatement("DROP INDEX IF EXISTS main." + indexName + ";");
+	}
+}
+
+void DatabaseStorage::setupHashKeys()
+{
+	// a database that already contains hash keys keeps maintaining them
+	if (hasColumn("node", "serialized_name_hash"))
+	{
+		m_hashKeysEnabled = true;
+		return;
+	}
+
+	if (!m_hashKeysEnabled)
+	{
+		return;
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace, "storage", "add hash keys");
+
+	executeStatement("SAVEPOINT add_hash_keys;");
+	try
+	{
+		executeStatement("ALTER TABLE node ADD COLUMN serialized_name_hash INTEGER;");
+		executeStatement("ALTER TABLE error ADD COLUMN message_hash INTEGER;");
+
+		std::vector<std::pair<int, sqlite_int64>> nodeHashes;
+		{
+			CppSQLite3Query q = executeQuery("SELECT id, serialized_name FROM node;");
+			for (; !q.eof(); q.nextRow())
+			{
+				nodeHashes.emplace_back(q.getIntField(0, 0), getHashKey(q.getStringField(1, "")));
+			}
+		}
+		CppSQLite3Statement setNodeHashStatement = compileStatement(
+			"UPDATE node SET serialized_name_hash = ? WHERE id == ?;");
+		for (const std::pair<int, sqlite_int64>& nodeHash: nodeHashes)
+		{
+			setNodeHashStatement.bind(1, nodeHash.second);
+			setNodeHashStatement.bind(2, nodeHash.first);
+			executeStatement(setNodeHashStatement);
+			setNodeHashStatement.reset();
+		}
+		setNodeHashStatement.finalize();
+
+		std::vector<std::pair<int, sqlite_int64>> errorHashes;
+		{
+			CppSQLite3Query q = executeQuery("SELECT id, message FROM error;");
+			for (; !q.eof(); q.nextRow())
+			{
+				errorHashes.emplace_back(q.getIntField(0, 0), getHashKey(q.getStringField(1, "")));
+			}
+		}
+		CppSQLite3Statement setErrorHashStatement = compileStatement("UPDATE error SET message_hash = ? WHERE id == ?;");
+		for (const std::pair<int, sqlite_int64>& errorHash: errorHashes)
+		{
+			setErrorHashStatement.bind(1, errorHash.second);
+			setErrorHashStatement.bind(2, errorHash.first);
+			executeStatement(setErrorHashStatement);
+			setErrorHashStatement.reset();
+		}
+		setErrorHashStatement.finalize();
+
+		// the hash key indices replace the indices on the full text
+		executeStatement("DROP INDEX IF EXISTS main.node_serialized_name_index;");
+		executeStatement("DROP INDEX IF EXISTS main.error_all_data_index;");
+	}
+	catch (const SourcetrailException&)
+	{
+		executeStatement("ROLLBACK TO SAVEPOINT add_hash_keys;");
+		executeStatement("RELEASE SAVEPOINT add_hash_keys;");
+		m_hashKeysEnabled = false;
+		throw;
+	}
+	executeStatement("RELEASE SAVEPOINT add_hash_keys;");
+}
+
+bool DatabaseStorage::hasColumn(const std::string& tableName, const std::string& columnName) const
+{
+	CppSQLite3Query q = executeQuery("PRAGMA table_info(" + tableName + ");");
+	for (; !q.eof(); q.nextRow())
+	{
+		if (columnName == q.getStringField(1, ""))
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
 void DatabaseStorage::setupPrecompiledStatements()
@@ -556,9 +1826,21 @@ void DatabaseStorage::setupPrecompiledStatements()
 	m_insertElementComponentStatement = compileStatement(
 		"INSERT INTO element_component(id, element_id, type, data) VALUES(NULL, ?, ?, ?);");
 
-	m_findNodeStatement = compileStatement("SELECT id FROM node WHERE serialized_name == ? LIMIT 1;");
+	if (m_hashKeysEnabled)
+	{
+		// the serialized name is compared as well, because different names may have the same hash
+		m_findNodeStatement = compileStatement(
+			"SELECT id FROM node WHERE serialized_name_hash == ? AND serialized_name == ? LIMIT 1;");
+
+		m_insertNodeStatement = compileStatement(
+			"INSERT INTO node(id, type, serialized_name, serialized_name_hash) VALUES(?, ?, ?, ?);");
+	}
+	else
+	{
+		m_findNodeStatement = compileStatement("SELECT id FROM node WHERE serialized_name == ? LIMIT 1;");
 
-	m_insertNodeStatement = compileStatement("INSERT INTO node(id, type, serialized_name) VALUES(?, ?, ?);");
+		m_insertNodeStatement = compileStatement("INSERT INTO node(id, type, serialized_name) VALUES(?, ?, ?);");
+	}
 
 	m_setNodeTypeStmt = compileStatement("UPDATE node SET type = ? WHERE id == ?;");
 
@@ -598,20 +1880,38 @@ void DatabaseStorage::setupPrecompiledStatements()
 
 	m_insertOccurenceStmt = compileStatement("INSERT OR IGNORE INTO occurrence(element_id, source_location_id) VALUES(?, ?);");
 
-	m_findErrorStatement = compileStatement(
-		"SELECT id FROM error WHERE "
-		"message = ? AND "
-		"fatal == ? "
-		"LIMIT 1;");
-
-	m_insertErrorStatement = compileStatement(
-		"INSERT INTO error(id, message, fatal, indexed, translation_unit) "
-		"VALUES(?, ?, ?, ?, ?);");
+	if (m_hashKeysEnabled)
+	{
+		m_findErrorStatement = compileStatement(
+			"SELECT id FROM error WHERE "
+			"message_hash == ? AND "
+			"message = ? AND "
+			"fatal == ? "
+			"LIMIT 1;");
+
+		m_insertErrorStatement = compileStatement(
+			"INSERT INTO error(id, message, fatal, indexed, translation_unit, message_hash) "
+			"VALUES(?, ?, ?, ?, ?, ?);");
+	}
+	else
+	{
+		m_findErrorStatement = compileStatement(
+			"SELECT id FROM error WHERE "
+			"message = ? AND "
+			"fatal == ? "
+			"LIMIT 1;");
+
+		m_insertErrorStatement = compileStatement(
+			"INSERT INTO error(id, message, fatal, indexed, translation_unit) "
+			"VALUES(?, ?, ?, ?, ?);");
+	}
 
 	m_insertOrUpdateMetaValueStmt = compileStatement(
 		"INSERT OR REPLACE INTO meta(id, key, value) VALUES("
 		"(SELECT id FROM meta WHERE key = ?), ?, ?"
 		");");
+
+	m_insertCommittedFileStmt = compileStatement("INSERT OR IGNORE INTO committed_file(file_id) VALUES(?);");
 }
 
 void DatabaseStorage::clearPrecompiledStatements()
@@ -636,16 +1936,23 @@ void DatabaseStorage::clearPrecompiledStatements()
 	m_findErrorStatement.finalize();
 	m_insertErrorStatement.finalize();
 	m_insertOrUpdateMetaValueStmt.finalize();
+	m_insertCommittedFileStmt.finalize();
 }
 
 int DatabaseStorage::insertElement()
 {
-	executeStatement(m_insertElementStatement);
-	const int id = static_cast<int>(m_database.lastRowId());
-	m_insertElementStatement.reset();
+	int id = 0;
+	throwIfFailed(tryInsertElement(id));
 	return id;
 }
 
+StorageStatus DatabaseStorage::tryInsertElement(int& id)
+{
+	const StorageStatus status = tryExecuteStatement(m_insertElementStatement, StorageStatement::INSERT_ELEMENT);
+	id = status.isOk() ? static_cast<int>(m_database.lastRowId()) : 0;
+	return status;
+}
+
 void DatabaseStorage::insertOrUpdateMetaValue(const std::string& key, const std::string& value)
 {
 	m_insertOrUpdateMetaValueStmt.bind(1, key.c_str());
@@ -671,6 +1978,7 @@ CppSQLite3Statement DatabaseStorage::compileStatement(const std::string& stateme
 
 void DatabaseStorage::executeStatement(const std::string& statement) const
 {
+	const TraceRecorder::Scope traceScope(m_trace, "sql", statement.c_str());
 	try
 	{
 		m_database.execDML(statement.c_str());
@@ -681,11 +1989,12 @@ void DatabaseStorage::executeStatement(const std::string& statement) const
 	}
 }
 
-void DatabaseStorage::executeStatement(CppSQLite3Statement& statement) const
+int DatabaseStorage::executeStatement(CppSQLite3Statement& statement) const
 {
+	const TraceRecorder::Scope traceScope(m_trace, "sql", "execute prepared statement");
 	try
 	{
-		statement.execDML();
+		return statement.execDML();
 	}
 	catch (CppSQLite3Exception e)
 	{
@@ -717,6 +2026,34 @@ CppSQLite3Query DatabaseStorage::executeQuery(CppSQLite3Statement& statement) co
 	}
 }
 
+StorageStatus DatabaseStorage::tryExecuteStatement(
+	CppSQLite3Statement& statement, StorageStatement statementKind, int* changedRowCount) const
+{
+	const TraceRecorder::Scope traceScope(m_trace, "sql", "execute prepared statement");
+	int rowCount = 0;
+	const int resultCode = statement.tryExecDML(rowCount);
+	if (changedRowCount)
+	{
+		*changedRowCount = rowCount;
+	}
+	return StorageStatus(resultCode == SQLITE_OK ? StorageStatement::NONE : statementKind, resultCode);
+}
+
+StorageStatus DatabaseStorage::tryFindId(CppSQLite3Statement& statement, StorageStatement statementKind, int& id) const
+{
+	bool hasRow = false;
+	const int resultCode = statement.tryExecScalar(id, hasRow);
+	return StorageStatus(resultCode == SQLITE_OK ? StorageStatement::NONE : statementKind, resultCode);
+}
+
+void DatabaseStorage::throwIfFailed(const StorageStatus& status)
+{
+	if (!status.isOk())
+	{
+		throw SourcetrailException(getErrorMessage(status));
+	}
+}
+
 template <>
 std::vector<StorageEdge> DatabaseStorage::doGetAll<StorageEdge>(const std::string& query) const
 {
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GraphSnapshot.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "DatabaseStorage.h"
+#include "MemoryMappedFile.h"
+#include "SourcetrailException.h"
+
+namespace
+{
+// The snapshot is a flat array of 32 bit words. The header is followed by the arrays in the order:
+// node ids [n], node kinds [n], offsets [n + 1], targets [e], edge kinds [e], edge ids [e]
+const int32_t SNAPSHOT_MAGIC = 0x53475253;	  // "SRGS"
+const int32_t SNAPSHOT_VERSION = 1;
+const size_t HEADER_WORD_COUNT = 4;
+
+size_t getWordCount(size_t nodeCount, size_t edgeCount)
+{
+	return HEADER_WORD_COUNT + 3 * nodeCount + 1 + 3 * edgeCount;
+}
+}	 // namespace
+
+namespace sourcetrail
+{
+std::unique_ptr<GraphSnapshot> GraphSnapshot::create(const DatabaseStorage& storage)
+{
+	std::vector<int32_t> nodeIds;
+	std::vector<int32_t> nodeKinds;
+	std::vector<int32_t> nodeIdToIndex;
+
+	storage.forEachNodeKind([&](int nodeId, int nodeKind) {
+		if (nodeId <= 0)
+		{
+			return;
+		}
+		if (static_cast<size_t>(nodeId) >= nodeIdToIndex.size())
+		{
+			nodeIdToIndex.resize(std::max(static_cast<size_t>(nodeId) + 1, nodeIdToIndex.size() * 2), -1);
+		}
+		nodeIdToIndex[nodeId] = static_cast<int32_t>(nodeIds.size());
+		nodeIds.push_back(nodeId);
+		nodeKinds.push_back(nodeKind);
+	});
+
+	const auto toNodeIndex = [&nodeIdToIndex](int nodeId) {
+		if (nodeId <= 0 || static_cast<size_t>(nodeId) >= nodeIdToIndex.size() || nodeIdToIndex[nodeId] < 0)
+		{
+			throw SourcetrailException("Unable to create graph snapshot, because edge references unknown node " + std::to_string(nodeId) + ".");
+		}
+		return nodeIdToIndex[nodeId];
+	};
+
+	std::vector<int32_t> sourceIndices;
+	std::vector<int32_t> targetIndices;
+	std::vector<int32_t> edgeKinds;
+	std::vector<int32_t> edgeIds;
+
+	storage.forEachEdge([&](int edgeId, int sourceNodeId, int targetNodeId, int edgeKind) {
+		sourceIndices.push_back(toNodeIndex(sourceNodeId));
+		targetIndices.push_back(toNodeIndex(targetNodeId));
+		edgeKinds.push_back(edgeKind);
+		edgeIds.push_back(edgeId);
+	});
+
+	const size_t nodeCount = nodeIds.size();
+	const size_t edgeCount = edgeIds.size();
+
+	std::unique_ptr<GraphSnapshot> snapshot = std::unique_ptr<GraphSnapshot>(new GraphSnapshot());
+	std::vector<int32_t>& buffer = snapshot->m_buffer;
+	buffer.resize(getWordCount(nodeCount, edgeCount), 0);
+
+	buffer[0] = SNAPSHOT_MAGIC;
+	buffer[1] = SNAPSHOT_VERSION;
+	buffer[2] = static_cast<int32_t>(nodeCount);
+	buffer[3] = static_cast<int32_t>(edgeCount);
+
+	int32_t* outNodeIds = buffer.data() + HEADER_WORD_COUNT;
+	int32_t* outNodeKinds = outNodeIds + nodeCount;
+	int32_t* outOffsets = outNodeKinds + nodeCount;
+	int32_t* outTargets = outOffsets + nodeCount + 1;
+	int32_t* outEdgeKinds = outTargets + edgeCount;
+	int32_t* outEdgeIds = outEdgeKinds + edgeCount;
+
+	std::copy(nodeIds.begin(), nodeIds.end(), outNodeIds);
+	std::copy(nodeKinds.begin(), nodeKinds.end(), outNodeKinds);
+
+	// counting sort by source index, edges of the same source keep their database order
+	for (int32_t sourceIndex: sourceIndices)
+	{
+		outOffsets[sourceIndex + 1]++;
+	}
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		outOffsets[i + 1] += outOffsets[i];
+	}
+
+	std::vector<int32_t> insertPositions(outOffsets, outOffsets + nodeCount);
+	for (size_t i = 0; i < edgeCount; i++)
+	{
+		const int32_t position = insertPositions[sourceIndices[i]]++;
+		outTargets[position] = targetIndices[i];
+		outEdgeKinds[position] = edgeKinds[i];
+		outEdgeIds[position] = edgeIds[i];
+	}
+
+	snapshot->assignArrays(buffer.data(), buffer.size());
+	return snapshot;
+}
+
+std::unique_ptr<GraphSnapshot> GraphSnapshot::load(const std::string& filePath)
+{
+	std::unique_ptr<GraphSnapshot> snapshot = std::unique_ptr<GraphSnapshot>(new GraphSnapshot());
+	snapshot->m_mappedFile = MemoryMappedFile::openReadOnly(filePath);
+
+	const size_t size = snapshot->m_mappedFile->getSize();
+	const int32_t* words = reinterpret_cast<const int32_t*>(snapshot->m_mappedFile->getData());
+
+	if (size < HEADER_WORD_COUNT * sizeof(int32_t) || words[0] != SNAPSHOT_MAGIC)
+	{
+		throw SourcetrailException("Unable to load graph snapshot, because \"" + filePath + "\" is not a graph snapshot file.");
+	}
+	if (words[1] != SNAPSHOT_VERSION)
+	{
+		throw SourcetrailException(
+			"Unable to load graph snapshot, because \"" + filePath + "\" has unsupported version " + std::to_string(words[1]) + ".");
+	}
+	if (words[2] < 0 || words[3] < 0 || size != getWordCount(words[2], words[3]) * sizeof(int32_t))
+	{
+		throw SourcetrailException("Unable to load graph snapshot, because \"" + filePath + "\" is truncated or corrupt.");
+	}
+
+	snapshot->assignArrays(words, size / sizeof(int32_t));
+	if (!snapshot->hasConsistentArrays())
+	{
+		throw SourcetrailException("Unable to load graph snapshot, because \"" + filePath + "\" is truncated or corrupt.");
+	}
+	return snapshot;
+}
+
+GraphSnapshot::~GraphSnapshot() {}
+
+void GraphSnapshot::save(const std::string& filePath) const
+{
+	std::ofstream fileStream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!fileStream.is_open())
+	{
+		throw SourcetrailException("Unable to save graph snapshot, because \"" + filePath + "\" cannot be opened for writing.");
+	}
+
+	fileStream.write(reinterpret_cast<const char*>(m_words), m_wordCount * sizeof(int32_t));
+	fileStream.close();
+
+	if (fileStream.fail())
+	{
+		throw SourcetrailException("Unable to save graph snapshot, because writing \"" + filePath + "\" failed.");
+	}
+}
+
+int GraphSnapshot::getNodeCount() const
+{
+	return m_nodeCount;
+}
+
+int GraphSnapshot::getEdgeCount() const
+{
+	return m_edgeCount;
+}
+
+int GraphSnapshot::getNodeIndex(int nodeId) const
+{
+	const int32_t* end = m_nodeIds + m_nodeCount;
+	const int32_t* it = std::lower_bound(m_nodeIds, end, nodeId);
+	if (it == end || *it != nodeId)
+	{
+		return -1;
+	}
+	return static_cast<int>(it - m_nodeIds);
+}
+
+int GraphSnapshot::getNodeId(int nodeIndex) const
+{
+	return m_nodeIds[nodeIndex];
+}
+
+int GraphSnapshot::getNodeKind(int nodeIndex) const
+{
+	return m_nodeKinds[nodeIndex];
+}
+
+const int32_t* GraphSnapshot::getNodeIds() const
+{
+	return m_nodeIds;
+}
+
+const int32_t* GraphSnapshot::getNodeKinds() const
+{
+	return m_nodeKinds;
+}
+
+const int32_t* GraphSnapshot::getOffsets() const
+{
+	return m_offsets;
+}
+
+const int32_t* GraphSnapshot::getTargets() const
+{
+	return m_targets;
+}
+
+const int32_t* GraphSnapshot::getEdgeKinds() const
+{
+	return m_edgeKinds;
+}
+
+const int32_t* GraphSnapshot::getEdgeIds() const
+{
+	return m_edgeIds;
+}
+
+GraphSnapshot::GraphSnapshot()
+	: m_words(nullptr)
+	, m_wordCount(0)
+	, m_nodeCount(0)
+	, m_edgeCount(0)
+	, m_nodeIds(nullptr)
+	, m_nodeKinds(nullptr)
+	, m_offsets(nullptr)
+	, m_targets(nullptr)
+	, m_edgeKinds(nullptr)
+	, m_edgeIds(nullptr)
+{
+}
+
+void GraphSnapshot::assignArrays(const int32_t* words, size_t wordCount)
+{
+	m_words = words;
+	m_wordCount = wordCount;
+	m_nodeCount = words[2];
+	m_edgeCount = words[3];
+	m_nodeIds = words + HEADER_WORD_COUNT;
+	m_nodeKinds = m_nodeIds + m_nodeCount;
+	m_offsets = m_nodeKinds + m_nodeCount;
+	m_targets = m_offsets + m_nodeCount + 1;
+	m_edgeKinds = m_targets + m_edgeCount;
+	m_edgeIds = m_edgeKinds + m_edgeCount;
+}
+
+bool GraphSnapshot::hasConsistentArrays() const
+{
+	for (int i = 1; i < m_nodeCount; i++)
+	{
+		if (m_nodeIds[i - 1] >= m_nodeIds[i])
+		{
+			return false;
+		}
+	}
+
+	if (m_offsets[0] != 0 || m_offsets[m_nodeCount] != m_edgeCount)
+	{
+		return false;
+	}
+	for (int i = 0; i < m_nodeCount; i++)
+	{
+		if (m_offsets[i] > m_offsets[i + 1])
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < m_edgeCount; i++)
+	{
+		if (m_targets[i] < 0 || m_targets[i] >= m_nodeCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+}	 // namespace sourcetrail
@@ -0,0 +1,677 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IngestLog.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "MemoryMappedFile.h"
+#include "SourcetrailException.h"
+
+namespace
+{
+const char INGEST_LOG_MAGIC[] = "SRCTRLIL";
+const uint32_t INGEST_LOG_VERSION = 1;
+const size_t INGEST_LOG_HEADER_SIZE = sizeof(INGEST_LOG_MAGIC) - 1 + sizeof(uint32_t);
+
+// the log file grows in steps of at least this size, so it is not remapped for every record
+const size_t INGEST_LOG_MIN_GROWTH = 16 << 20;
+
+// A record consists of its kind, the number of int values, the number of strings, the int values and the strings,
+// each with a uint32_t length prefix. A zero byte ends the log, e.g. after the file was not truncated on close.
+enum RecordKind : uint8_t
+{
+	RECORD_END = 0,
+	RECORD_NODE = 1,
+	RECORD_SET_NODE_TYPE = 2,
+	RECORD_SYMBOL = 3,
+	RECORD_FILE = 4,
+	RECORD_SET_FILE_LANGUAGE = 5,
+	RECORD_EDGE = 6,
+	RECORD_LOCAL_SYMBOL = 7,
+	RECORD_SOURCE_LOCATION = 8,
+	RECORD_OCCURRENCE = 9,
+	RECORD_ERROR = 10,
+	RECORD_ELEMENT_COMPONENT = 11,
+	RECORD_COMMITTED_FILE = 12
+};
+
+struct Record
+{
+	uint8_t kind;
+	int values[7];
+	size_t valueCount;
+	std::string texts[3];
+	size_t textCount;
+};
+
+class RecordReader
+{
+public:
+	RecordReader(const char* data, size_t size): m_data(data), m_size(size), m_position(INGEST_LOG_HEADER_SIZE) {}
+
+	bool read(Record& record)
+	{
+		if (m_position >= m_size || m_data[m_position] == RECORD_END)
+		{
+			return false;
+		}
+
+		require(3);
+		record.kind = static_cast<uint8_t>(m_data[m_position]);
+		record.valueCount = static_cast<uint8_t>(m_data[m_position + 1]);
+		record.textCount = static_cast<uint8_t>(m_data[m_position + 2]);
+		m_position += 3;
+		if (record.valueCount > 7 || record.textCount > 3)
+		{
+			throw sourcetrail::SourcetrailException("Ingest log contains an invalid record.");
+		}
+
+		require(record.valueCount * sizeof(int));
+		std::memcpy(record.values, m_data + m_position, record.valueCount * sizeof(int));
+		m_position += record.valueCount * sizeof(int);
+
+		for (size_t i = 0; i < record.textCount; i++)
+		{
+			uint32_t length = 0;
+			require(sizeof(length));
+			std::memcpy(&length, m_data + m_position, sizeof(length));
+			m_position += sizeof(length);
+
+			require(length);
+			record.texts[i].assign(m_data + m_position, length);
+			m_position += length;
+		}
+		return true;
+	}
+
+	size_t getPosition() const
+	{
+		return m_position;
+	}
+
+private:
+	void require(size_t byteCount) const
+	{
+		if (byteCount > m_size - m_position)
+		{
+			throw sourcetrail::SourcetrailException("Ingest log ends unexpectedly.");
+		}
+	}
+
+	const char* m_data;
+	size_t m_size;
+	size_t m_position;
+};
+
+void checkRecord(const Record& record, size_t valueCount, size_t textCount)
+{
+	if (record.valueCount != valueCount || record.textCount != textCount)
+	{
+		throw sourcetrail::SourcetrailException(
+			"Ingest log contains an invalid record of kind " + std::to_string(record.kind) + ".");
+	}
+}
+
+void checkHeader(const sourcetrail::MemoryMappedFile& file, const std::string& filePath)
+{
+	if (file.getSize() < INGEST_LOG_HEADER_SIZE ||
+		std::memcmp(file.getData(), INGEST_LOG_MAGIC, sizeof(INGEST_LOG_MAGIC) - 1) != 0)
+	{
+		throw sourcetrail::SourcetrailException("File \"" + filePath + "\" is no ingest log.");
+	}
+	uint32_t version = 0;
+	std::memcpy(&version, file.getData() + sizeof(INGEST_LOG_MAGIC) - 1, sizeof(version));
+	if (version != INGEST_LOG_VERSION)
+	{
+		throw sourcetrail::SourcetrailException(
+			"Ingest log \"" + filePath + "\" has unsupported version " + std::to_string(version) + ".");
+	}
+}
+
+bool isLessSourceLocation(const sourcetrail::StorageSourceLocation& a, const sourcetrail::StorageSourceLocation& b)
+{
+	if (a.fileNodeId != b.fileNodeId)
+	{
+		return a.fileNodeId < b.fileNodeId;
+	}
+	if (a.startLineNumber != b.startLineNumber)
+	{
+		return a.startLineNumber < b.startLineNumber;
+	}
+	if (a.startColumnNumber != b.startColumnNumber)
+	{
+		return a.startColumnNumber < b.startColumnNumber;
+	}
+	if (a.endLineNumber != b.endLineNumber)
+	{
+		return a.endLineNumber < b.endLineNumber;
+	}
+	if (a.endColumnNumber != b.endColumnNumber)
+	{
+		return a.endColumnNumber < b.endColumnNumber;
+	}
+	if (a.locationKind != b.locationKind)
+	{
+		return a.locationKind < b.locationKind;
+	}
+	return a.id < b.id;
+}
+
+bool isSameSourceLocation(const sourcetrail::StorageSourceLocation& a, const sourcetrail::StorageSourceLocation& b)
+{
+	return a.fileNodeId == b.fileNodeId && a.startLineNumber == b.startLineNumber &&
+		a.startColumnNumber == b.startColumnNumber && a.endLineNumber == b.endLineNumber &&
+		a.endColumnNumber == b.endColumnNumber && a.locationKind == b.locationKind;
+}
+}	 // namespace
+
+namespace sourcetrail
+{
+std::unique_ptr<IngestLog> IngestLog::create(const std::string& filePath)
+{
+	std::unique_ptr<IngestLog> log = std::unique_ptr<IngestLog>(new IngestLog());
+	log->m_file = MemoryMappedFile::createWritable(filePath);
+	log->clear();
+	return log;
+}
+
+IngestLogContents IngestLog::load(const std::string& filePath)
+{
+	std::unique_ptr<MemoryMappedFile> file = MemoryMappedFile::openReadOnly(filePath);
+	checkHeader(*file, filePath);
+
+	IngestLogContents contents;
+	std::unordered_map<int, size_t> nodeIndices;
+	std::unordered_map<int, size_t> fileIndices;
+
+	RecordReader reader(file->getData(), file->getSize());
+	Record record;
+	while (reader.read(record))
+	{
+		const int* v = record.values;
+		switch (record.kind)
+		{
+		case RECORD_NODE:
+			checkRecord(record, 2, 1);
+			nodeIndices[v[0]] = contents.nodes.size();
+			contents.nodes.push_back(StorageNode(v[0], v[1], record.texts[0]));
+			break;
+		case RECORD_SET_NODE_TYPE:
+		{
+			checkRecord(record, 2, 0);
+			std::unordered_map<int, size_t>::const_iterator it = nodeIndices.find(v[0]);
+			if (it != nodeIndices.end())
+			{
+				contents.nodes[it->second].nodeKind = v[1];
+			}
+			break;
+		}
+		case RECORD_SYMBOL:
+			checkRecord(record, 2, 0);
+			contents.symbols.push_back(StorageSymbol(v[0], v[1]));
+			break;
+		case RECORD_FILE:
+			checkRecord(record, 3, 3);
+			fileIndices[v[0]] = contents.files.size();
+			contents.files.push_back(
+				StorageFile(v[0], record.texts[0], record.texts[1], record.texts[2], v[1] != 0, v[2] != 0));
+			break;
+		case RECORD_SET_FILE_LANGUAGE:
+		{
+			checkRecord(record, 1, 1);
+			std::unordered_map<int, size_t>::const_iterator it = fileIndices.find(v[0]);
+			if (it != fileIndices.end())
+			{
+				contents.files[it->second].languageIdentifier = record.texts[0];
+			}
+			break;
+		}
+		case RECORD_EDGE:
+			checkRecord(record, 4, 0);
+			contents.edges.push_back(StorageEdge(v[0], v[2], v[3], v[1]));
+			break;
+		case RECORD_LOCAL_SYMBOL:
+			checkRecord(record, 1, 1);
+			contents.localSymbols.push_back(StorageLocalSymbol(v[0], record.texts[0]));
+			break;
+		case RECORD_SOURCE_LOCATION:
+			checkRecord(record, 7, 0);
+			contents.sourceLocations.push_back(
+				StorageSourceLocation(v[0], StorageSourceLocationData(v[1], v[2], v[3], v[4], v[5], v[6])));
+			break;
+		case RECORD_OCCURRENCE:
+			checkRecord(record, 2, 0);
+			contents.occurrences.push_back(StorageOccurrence(v[0], v[1]));
+			break;
+		case RECORD_ERROR:
+			checkRecord(record, 3, 2);
+			contents.errors.push_back(StorageError(v[0], record.texts[0], record.texts[1], v[1] != 0, v[2] != 0));
+			break;
+		case RECORD_ELEMENT_COMPONENT:
+			checkRecord(record, 2, 1);
+			contents.elementComponents.push_back(StorageElementComponentData(v[0], v[1], record.texts[0]));
+			break;
+		case RECORD_COMMITTED_FILE:
+			checkRecord(record, 1, 0);
+			contents.committedFileIds.push_back(v[0]);
+			break;
+		default:
+			throw SourcetrailException("Ingest log contains unknown record kind " + std::to_string(record.kind) + ".");
+		}
+	}
+
+	// the first definition kind of a symbol wins, like the INSERT OR IGNORE of the database
+	std::stable_sort(
+		contents.symbols.begin(), contents.symbols.end(), [](const StorageSymbol& a, const StorageSymbol& b) {
+			return a.id < b.id;
+		});
+	contents.symbols.erase(
+		std::unique(
+			contents.symbols.begin(),
+			contents.symbols.end(),
+			[](const StorageSymbol& a, const StorageSymbol& b) { return a.id == b.id; }),
+		contents.symbols.end());
+
+	// merge duplicate source locations into the one with the lowest id
+	int maxSourceLocationId = 0;
+	for (const StorageSourceLocation& sourceLocation: contents.sourceLocations)
+	{
+		maxSourceLocationId = std::max(maxSourceLocationId, sourceLocation.id);
+	}
+	std::vector<int> sourceLocationIds(maxSourceLocationId + 1, 0);
+	std::sort(contents.sourceLocations.begin(), contents.sourceLocations.end(), isLessSourceLocation);
+	size_t uniqueCount = 0;
+	for (size_t i = 0; i < contents.sourceLocations.size(); i++)
+	{
+		if (uniqueCount == 0 || !isSameSourceLocation(contents.sourceLocations[uniqueCount - 1], contents.sourceLocations[i]))
+		{
+			contents.sourceLocations[uniqueCount++] = contents.sourceLocations[i];
+		}
+		sourceLocationIds[contents.sourceLocations[i].id] = contents.sourceLocations[uniqueCount - 1].id;
+	}
+	contents.sourceLocations.resize(uniqueCount);
+
+	for (StorageOccurrence& occurrence: contents.occurrences)
+	{
+		if (occurrence.sourceLocationId > 0 && occurrence.sourceLocationId <= maxSourceLocationId)
+		{
+			occurrence.sourceLocationId = sourceLocationIds[occurrence.sourceLocationId];
+		}
+	}
+	std::sort(
+		contents.occurrences.begin(),
+		contents.occurrences.end(),
+		[](const StorageOccurrence& a, const StorageOccurrence& b) {
+			return a.elementId != b.elementId ? a.elementId < b.elementId : a.sourceLocationId < b.sourceLocationId;
+		});
+	contents.occurrences.erase(
+		std::unique(
+			contents.occurrences.begin(),
+			contents.occurrences.end(),
+			[](const StorageOccurrence& a, const StorageOccurrence& b) {
+				return a.elementId == b.elementId && a.sourceLocationId == b.sourceLocationId;
+			}),
+		contents.occurrences.end());
+
+	for (const StorageNode& node: contents.nodes)
+	{
+		contents.elementIds.push_back(node.id);
+	}
+	for (const StorageEdge& edge: contents.edges)
+	{
+		contents.elementIds.push_back(edge.id);
+	}
+	for (const StorageLocalSymbol& localSymbol: contents.localSymbols)
+	{
+		contents.elementIds.push_back(localSymbol.id);
+	}
+	for (const StorageError& error: contents.errors)
+	{
+		contents.elementIds.push_back(error.id);
+	}
+	std::sort(contents.elementIds.begin(), contents.elementIds.end());
+
+	std::sort(contents.committedFileIds.begin(), contents.committedFileIds.end());
+	contents.committedFileIds.erase(
+		std::unique(contents.committedFileIds.begin(), contents.committedFileIds.end()),
+		contents.committedFileIds.end());
+
+	return contents;
+}
+
+std::unique_ptr<IngestLog> IngestLog::resume(const std::string& filePath)
+{
+	std::unique_ptr<IngestLog> log = std::unique_ptr<IngestLog>(new IngestLog());
+	log->m_file = MemoryMappedFile::openWritable(filePath);
+	checkHeader(*log->m_file, filePath);
+
+	// the records after the last committed file may be incomplete or belong to files that have to be recorded again
+	size_t checkpointSize = INGEST_LOG_HEADER_SIZE;
+	{
+		RecordReader reader(log->m_file->getData(), log->m_file->getSize());
+		Record record;
+		try
+		{
+			while (reader.read(record))
+			{
+				if (record.kind == RECORD_COMMITTED_FILE)
+				{
+					checkpointSize = reader.getPosition();
+				}
+			}
+		}
+		catch (const SourcetrailException&)
+		{
+			// a record that was only partially written before a crash ends the log
+		}
+	}
+
+	RecordReader reader(log->m_file->getData(), checkpointSize);
+	Record record;
+	while (reader.read(record))
+	{
+		const int* v = record.values;
+		switch (record.kind)
+		{
+		case RECORD_NODE:
+			checkRecord(record, 2, 1);
+			log->m_nodeIds[record.texts[0]] = v[0];
+			log->m_nextElementId = std::max(log->m_nextElementId, v[0] + 1);
+			break;
+		case RECORD_FILE:
+			checkRecord(record, 3, 3);
+			log->m_filePaths[v[0]] = record.texts[0];
+			break;
+		case RECORD_EDGE:
+		{
+			checkRecord(record, 4, 0);
+			const EdgeKey key = {v[2], v[3], v[1]};
+			log->m_edgeIds[key] = v[0];
+			log->m_nextElementId = std::max(log->m_nextElementId, v[0] + 1);
+			break;
+		}
+		case RECORD_LOCAL_SYMBOL:
+			checkRecord(record, 1, 1);
+			log->m_localSymbolIds[record.texts[0]] = v[0];
+			log->m_nextElementId = std::max(log->m_nextElementId, v[0] + 1);
+			break;
+		case RECORD_SOURCE_LOCATION:
+			checkRecord(record, 7, 0);
+			log->m_nextSourceLocationId = std::max(log->m_nextSourceLocationId, v[0] + 1);
+			break;
+		case RECORD_ERROR:
+			checkRecord(record, 3, 2);
+			log->m_errorIds[record.texts[0] + (v[1] != 0 ? '1' : '0')] = v[0];
+			log->m_nextElementId = std::max(log->m_nextElementId, v[0] + 1);
+			break;
+		case RECORD_ELEMENT_COMPONENT:
+			checkRecord(record, 2, 1);
+			log->m_nextElementComponentId++;
+			break;
+		case RECORD_COMMITTED_FILE:
+			checkRecord(record, 1, 0);
+			log->m_committedFileIds.insert(v[0]);
+			break;
+		case RECORD_SET_NODE_TYPE:
+		case RECORD_SYMBOL:
+		case RECORD_SET_FILE_LANGUAGE:
+		case RECORD_OCCURRENCE:
+			break;
+		default:
+			throw SourcetrailException("Ingest log contains unknown record kind " + std::to_string(record.kind) + ".");
+		}
+	}
+
+	// zeroing the discarded records makes the next record follow the last committed file
+	log->m_usedSize = checkpointSize;
+	std::memset(log->m_file->getWritableData() + checkpointSize, 0, log->m_file->getSize() - checkpointSize);
+	return log;
+}
+
+IngestLog::~IngestLog()
+{
+	try
+	{
+		m_file->resize(m_usedSize);
+	}
+	catch (...)
+	{
+		// the unused space is zeroed and read as the end of the log
+	}
+}
+
+bool IngestLog::isEmpty() const
+{
+	return m_usedSize == INGEST_LOG_HEADER_SIZE;
+}
+
+void IngestLog::clear()
+{
+	// shrinking first discards the previous records, growing fills the file with zeros
+	m_file->resize(0);
+	m_file->resize(INGEST_LOG_MIN_GROWTH);
+	std::memcpy(m_file->getWritableData(), INGEST_LOG_MAGIC, sizeof(INGEST_LOG_MAGIC) - 1);
+	std::memcpy(m_file->getWritableData() + sizeof(INGEST_LOG_MAGIC) - 1, &INGEST_LOG_VERSION, sizeof(INGEST_LOG_VERSION));
+	m_usedSize = INGEST_LOG_HEADER_SIZE;
+
+	m_nextElementId = 1;
+	m_nextSourceLocationId = 1;
+	m_nextElementComponentId = 1;
+	m_nodeIds.clear();
+	m_edgeIds.clear();
+	m_localSymbolIds.clear();
+	m_errorIds.clear();
+	m_filePaths.clear();
+	m_committedFileIds.clear();
+}
+
+int IngestLog::addElementComponent(const StorageElementComponentData& storageElementComponentData)
+{
+	writeRecord(
+		RECORD_ELEMENT_COMPONENT,
+		{storageElementComponentData.elementId, storageElementComponentData.componentKind},
+		{&storageElementComponentData.data});
+	return m_nextElementComponentId++;
+}
+
+int IngestLog::addNode(const StorageNodeData& storageNodeData)
+{
+	return addNode(storageNodeData.nodeKind, storageNodeData.serializedName);
+}
+
+int IngestLog::addNode(int nodeKind, const std::string& serializedName)
+{
+	// looking the name up first, emplace() would allocate a map node even for names that are already known
+	std::unordered_map<std::string, int>::const_iterator it = m_nodeIds.find(serializedName);
+	if (it != m_nodeIds.end())
+	{
+		return it->second;
+	}
+
+	m_nodeIds.emplace(serializedName, m_nextElementId);
+	writeRecord(RECORD_NODE, {m_nextElementId, nodeKind}, {&serializedName});
+	return m_nextElementId++;
+}
+
+void IngestLog::addSymbol(const StorageSymbol& storageSymbol)
+{
+	writeRecord(RECORD_SYMBOL, {storageSymbol.id, storageSymbol.definitionKind});
+}
+
+void IngestLog::addFile(const StorageFile& storageFile)
+{
+	if (m_filePaths.emplace(storageFile.id, storageFile.filePath).second)
+	{
+		writeRecord(
+			RECORD_FILE,
+			{storageFile.id, storageFile.indexed, storageFile.complete},
+			{&storageFile.filePath, &storageFile.languageIdentifier, &storageFile.modificationTime});
+	}
+}
+
+int IngestLog::addEdge(const StorageEdgeData& storageEdgeData)
+{
+	const EdgeKey key = {storageEdgeData.sourceNodeId, storageEdgeData.targetNodeId, storageEdgeData.edgeKind};
+	std::unordered_map<EdgeKey, int, EdgeKeyHash>::const_iterator it = m_edgeIds.find(key);
+	if (it != m_edgeIds.end())
+	{
+		return it->second;
+	}
+
+	m_edgeIds.emplace(key, m_nextElementId);
+	writeRecord(
+		RECORD_EDGE,
+		{m_nextElementId, storageEdgeData.edgeKind, storageEdgeData.sourceNodeId, storageEdgeData.targetNodeId});
+	return m_nextElementId++;
+}
+
+int IngestLog::addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData)
+{
+	std::pair<std::unordered_map<std::string, int>::iterator, bool> it = m_localSymbolIds.emplace(
+		storageLocalSymbolData.name, m_nextElementId);
+	if (it.second)
+	{
+		writeRecord(RECORD_LOCAL_SYMBOL, {m_nextElementId}, {&storageLocalSymbolData.name});
+		m_nextElementId++;
+	}
+	return it.first->second;
+}
+
+int IngestLog::addSourceLocation(const StorageSourceLocationData& storageSourceLocationData)
+{
+	writeRecord(
+		RECORD_SOURCE_LOCATION,
+		{m_nextSourceLocationId,
+		 storageSourceLocationData.fileNodeId,
+		 storageSourceLocationData.startLineNumber,
+		 storageSourceLocationData.startColumnNumber,
+		 storageSourceLocationData.endLineNumber,
+		 storageSourceLocationData.endColumnNumber,
+		 storageSourceLocationData.locationKind});
+	return m_nextSourceLocationId++;
+}
+
+void IngestLog::addOccurrence(const StorageOccurrence& storageOccurrence)
+{
+	writeRecord(RECORD_OCCURRENCE, {storageOccurrence.elementId, storageOccurrence.sourceLocationId});
+}
+
+int IngestLog::addError(const StorageErrorData& storageErrorData)
+{
+	const std::string key = storageErrorData.message + (storageErrorData.fatal ? '1' : '0');
+	std::pair<std::unordered_map<std::string, int>::iterator, bool> it = m_errorIds.emplace(key, m_nextElementId);
+	if (it.second)
+	{
+		writeRecord(
+			RECORD_ERROR,
+			{m_nextElementId, storageErrorData.fatal, storageErrorData.indexed},
+			{&storageErrorData.message, &storageErrorData.translationUnit});
+		m_nextElementId++;
+	}
+	return it.first->second;
+}
+
+void IngestLog::setNodeType(int nodeId, int nodeKind)
+{
+	writeRecord(RECORD_SET_NODE_TYPE, {nodeId, nodeKind});
+}
+
+void IngestLog::setFileLanguage(int fileId, const std::string& languageIdentifier)
+{
+	writeRecord(RECORD_SET_FILE_LANGUAGE, {fileId}, {&languageIdentifier});
+}
+
+void IngestLog::addCommittedFile(int fileId)
+{
+	if (m_committedFileIds.insert(fileId).second)
+	{
+		writeRecord(RECORD_COMMITTED_FILE, {fileId});
+		m_file->flush();
+	}
+}
+
+std::vector<std::string> IngestLog::getCommittedFilePaths() const
+{
+	std::vector<std::string> filePaths;
+	for (int fileId: m_committedFileIds)
+	{
+		std::unordered_map<int, std::string>::const_iterator it = m_filePaths.find(fileId);
+		if (it != m_filePaths.end())
+		{
+			filePaths.push_back(it->second);
+		}
+	}
+	return filePaths;
+}
+
+bool IngestLog::EdgeKey::operator==(const EdgeKey& other) const
+{
+	return sourceNodeId == other.sourceNodeId && targetNodeId == other.targetNodeId && edgeKind == other.edgeKind;
+}
+
+size_t IngestLog::EdgeKeyHash::operator()(const EdgeKey& key) const
+{
+	uint64_t hash = static_cast<uint32_t>(key.sourceNodeId);
+	hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.targetNodeId);
+	hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.edgeKind);
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+IngestLog::IngestLog()
+	: m_usedSize(0), m_nextElementId(1), m_nextSourceLocationId(1), m_nextElementComponentId(1)
+{
+}
+
+void IngestLog::writeRecord(
+	uint8_t recordKind, std::initializer_list<int> values, std::initializer_list<const std::string*> texts)
+{
+	size_t byteCount = 3 + values.size() * sizeof(int);
+	for (const std::string* text: texts)
+	{
+		byteCount += sizeof(uint32_t) + text->size();
+	}
+
+	// keep at least one zero byte after the last record as end marker
+	if (m_usedSize + byteCount >= m_file->getSize())
+	{
+		m_file->resize(std::max(m_file->getSize() * 2, m_usedSize + byteCount + INGEST_LOG_MIN_GROWTH));
+	}
+
+	char* data = m_file->getWritableData() + m_usedSize;
+	data[0] = static_cast<char>(recordKind);
+	data[1] = static_cast<char>(values.size());
+	data[2] = static_cast<char>(texts.size());
+	data += 3;
+
+	for (int value: values)
+	{
+		std::memcpy(data, &value, sizeof(value));
+		data += sizeof(value);
+	}
+	for (const std::string* text: texts)
+	{
+		const uint32_t length = static_cast<uint32_t>(text->size());
+		std::memcpy(data, &length, sizeof(length));
+		data += sizeof(length);
+		std::memcpy(data, text->data(), length);
+		data += length;
+	}
+
+	m_usedSize += byteCount;
+}
+}	 // namespace sourcetrail
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#include "SourcetrailException.h"
+
+namespace sourcetrail
+{
+std::unique_ptr<MemoryMappedFile> MemoryMappedFile::openReadOnly(const std::string& filePath)
+{
+	std::unique_ptr<MemoryMappedFile> file = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile());
+	file->m_filePath = filePath;
+
+#ifdef _WIN32
+	file->m_fileHandle = CreateFileA(
+		filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file->m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		file->m_fileHandle = nullptr;
+		throw SourcetrailException("Unable to open file \"" + filePath + "\" for memory mapping.");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file->m_fileHandle, &fileSize))
+	{
+		throw SourcetrailException("Unable to determine size of file \"" + filePath + "\".");
+	}
+	file->m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	file->m_fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+	if (file->m_fileDescriptor < 0)
+	{
+		throw SourcetrailException("Unable to open file \"" + filePath + "\" for memory mapping.");
+	}
+
+	struct stat fileStatus;
+	if (fstat(file->m_fileDescriptor, &fileStatus) != 0)
+	{
+		throw SourcetrailException("Unable to determine size of file \"" + filePath + "\".");
+	}
+	file->m_size = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+	file->map();
+	return file;
+}
+
+std::unique_ptr<MemoryMappedFile> MemoryMappedFile::createWritable(const std::string& filePath)
+{
+	std::unique_ptr<MemoryMappedFile> file = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile());
+	file->m_filePath = filePath;
+	file->m_writable = true;
+
+#ifdef _WIN32
+	file->m_fileHandle = CreateFileA(
+		filePath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file->m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		file->m_fileHandle = nullptr;
+		throw SourcetrailException("Unable to create file \"" + filePath + "\" for memory mapping.");
+	}
+#else
+	file->m_fileDescriptor = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file->m_fileDescriptor < 0)
+	{
+		throw SourcetrailException("Unable to create file \"" + filePath + "\" for memory mapping.");
+	}
+#endif
+
+	return file;
+}
+
+std::unique_ptr<MemoryMappedFile> MemoryMappedFile::openWritable(const std::string& filePath)
+{
+	std::unique_ptr<MemoryMappedFile> file = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile());
+	file->m_filePath = filePath;
+	file->m_writable = true;
+
+#ifdef _WIN32
+	file->m_fileHandle = CreateFileA(
+		filePath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file->m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		file->m_fileHandle = nullptr;
+		throw SourcetrailException("Unable to open file \"" + filePath + "\" for memory mapping.");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file->m_fileHandle, &fileSize))
+	{
+		throw SourcetrailException("Unable to determine size of file \"" + filePath + "\".");
+	}
+	file->m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	file->m_fileDescriptor = ::open(filePath.c_str(), O_RDWR);
+	if (file->m_fileDescriptor < 0)
+	{
+		throw SourcetrailException("Unable to open file \"" + filePath + "\" for memory mapping.");
+	}
+
+	struct stat fileStatus;
+	if (fstat(file->m_fileDescriptor, &fileStatus) != 0)
+	{
+		throw SourcetrailException("Unable to determine size of file \"" + filePath + "\".");
+	}
+	file->m_size = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+	file->map();
+	return file;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	unmap();
+
+#ifdef _WIN32
+	if (m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+#else
+	if (m_fileDescriptor >= 0)
+	{
+		::close(m_fileDescriptor);
+	}
+#endif
+}
+
+const char* MemoryMappedFile::getData() const
+{
+	return m_data;
+}
+
+char* MemoryMappedFile::getWritableData()
+{
+	return m_writable ? m_data : nullptr;
+}
+
+size_t MemoryMappedFile::getSize() const
+{
+	return m_size;
+}
+
+void MemoryMappedFile::resize(size_t size)
+{
+	if (!m_writable)
+	{
+		throw SourcetrailException("Unable to resize read-only file \"" + m_filePath + "\".");
+	}
+
+	unmap();
+
+#ifdef _WIN32
+	LARGE_INTEGER fileSize;
+	fileSize.QuadPart = static_cast<LONGLONG>(size);
+	if (!SetFilePointerEx(m_fileHandle, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(m_fileHandle))
+	{
+		throw SourcetrailException("Unable to resize file \"" + m_filePath + "\".");
+	}
+#else
+	if (ftruncate(m_fileDescriptor, static_cast<off_t>(size)) != 0)
+	{
+		throw SourcetrailException("Unable to resize file \"" + m_filePath + "\".");
+	}
+#endif
+
+	m_size = size;
+	map();
+}
+
+void MemoryMappedFile::flush()
+{
+	if (!m_data || !m_writable)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	if (!FlushViewOfFile(m_data, 0) || !FlushFileBuffers(m_fileHandle))
+	{
+		throw SourcetrailException("Unable to flush file \"" + m_filePath + "\".");
+	}
+#else
+	if (msync(m_data, m_size, MS_SYNC) != 0)
+	{
+		throw SourcetrailException("Unable to flush file \"" + m_filePath + "\".");
+	}
+#endif
+}
+
+#ifdef _WIN32
+MemoryMappedFile::MemoryMappedFile()
+	: m_data(nullptr), m_size(0), m_writable(false), m_fileHandle(nullptr), m_mappingHandle(nullptr)
+{
+}
+#else
+MemoryMappedFile::MemoryMappedFile(): m_data(nullptr), m_size(0), m_writable(false), m_fileDescriptor(-1) {}
+#endif
+
+void MemoryMappedFile::map()
+{
+	if (m_size == 0)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, m_writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mappingHandle)
+	{
+		throw SourcetrailException("Unable to create file mapping for \"" + m_filePath + "\".");
+	}
+
+	m_data = static_cast<char*>(MapViewOfFile(m_mappingHandle, m_writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		throw SourcetrailException("Unable to map view of file \"" + m_filePath + "\".");
+	}
+#else
+	void* data = mmap(
+		nullptr, m_size, m_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fileDescriptor, 0);
+	if (data == MAP_FAILED)
+	{
+		throw SourcetrailException("Unable to memory map file \"" + m_filePath + "\".");
+	}
+	m_data = static_cast<char*>(data);
+#endif
+}
+
+void MemoryMappedFile::unmap()
+{
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+#else
+	if (m_data)
+	{
+		munmap(m_data, m_size);
+	}
+#endif
+	m_data = nullptr;
+}
+}	 // namespace sourcetrail
@@ -16,6 +16,9 @@
 
 #include "NameHierarchy.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "json.hpp"
 
 namespace sourcetrail
@@ -105,21 +108,155 @@ NameHierarchy deserializeNameHierarchyFromJson(const std::string& serializedName
 
 std::string serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy)
 {
-	static std::string META_DELIMITER = "\tm";
-	static std::string NAME_DELIMITER = "\tn";
-	static std::string PARTS_DELIMITER = "\ts";
-	static std::string SIGNATURE_DELIMITER = "\tp";
+	std::string serialized;
+	serializeNameHierarchyToDatabaseString(nameHierarchy, nameHierarchy.nameElements.size(), serialized);
+	return serialized;
+}
+
+void serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy, size_t elementCount, std::string& serialized)
+{
+	// each delimiter is a tab followed by a marker character
+	const size_t DELIMITER_SIZE = 2;
+
+	elementCount = std::min(elementCount, nameHierarchy.nameElements.size());
 
-	std::string serialized = nameHierarchy.nameDelimiter + META_DELIMITER;
-	for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
+	size_t size = nameHierarchy.nameDelimiter.size() + DELIMITER_SIZE;
+	for (size_t i = 0; i < elementCount; i++)
 	{
+		const NameElement& nameElement = nameHierarchy.nameElements[i];
+		size += nameElement.name.size() + nameElement.prefix.size() + nameElement.postfix.size() + 2 * DELIMITER_SIZE;
 		if (i != 0)
 		{
-			serialized += NAME_DELIMITER;
+			size += DELIMITER_SIZE;
+		}
+	}
+
+	serialized.clear();
+	serialized.reserve(size);
+
+	serialized.append(nameHierarchy.nameDelimiter);
+	serialized.append("\tm", DELIMITER_SIZE);
+	for (size_t i = 0; i < elementCount; i++)
+	{
+		if (i != 0)
+		{
+			serialized.append("\tn", DELIMITER_SIZE);
 		}
 		const NameElement& nameElement = nameHierarchy.nameElements[i];
-		serialized += nameElement.name + PARTS_DELIMITER + nameElement.prefix + SIGNATURE_DELIMITER + nameElement.postfix;
+		serialized.append(nameElement.name);
+		serialized.append("\ts", DELIMITER_SIZE);
+		serialized.append(nameElement.prefix);
+		serialized.append("\tp", DELIMITER_SIZE);
+		serialized.append(nameElement.postfix);
 	}
-	return serialized;
+}
+
+bool parseNameHierarchyDatabaseString(const char* data, size_t size, StringRef& nameDelimiter, std::vector<NameElementRef>& nameElements)
+{
+	nameDelimiter = {data, 0};
+	nameElements.clear();
+
+	// Each part is terminated by a tab followed by a marker character: 'm' ends the name delimiter, 's' ends the
+	// name, 'p' ends the prefix and 'n' ends the postfix of an element. The last postfix ends with the string.
+	// Tabs with any other following character belong to the current part. memchr is typically vectorized, so
+	// scanning for tabs is much faster than comparing each character.
+	enum
+	{
+		DELIMITER,
+		NAME,
+		PREFIX,
+		POSTFIX
+	} state = DELIMITER;
+
+	const char* const end = data + size;
+	const char* partBegin = data;
+	const char* pos = data;
+	NameElementRef element;
+
+	while (pos < end)
+	{
+		const char* tab = static_cast<const char*>(memchr(pos, '\t', end - pos));
+		if (!tab || tab + 1 == end)
+		{
+			break;
+		}
+
+		const char marker = tab[1];
+		const StringRef part = {partBegin, static_cast<size_t>(tab - partBegin)};
+
+		if (state == DELIMITER && marker == 'm')
+		{
+			nameDelimiter = part;
+			state = NAME;
+		}
+		else if (state == NAME && marker == 's')
+		{
+			element.name = part;
+			state = PREFIX;
+		}
+		else if (state == PREFIX && marker == 'p')
+		{
+			element.prefix = part;
+			state = POSTFIX;
+		}
+		else if (state == POSTFIX && marker == 'n')
+		{
+			element.postfix = part;
+			nameElements.push_back(element);
+			state = NAME;
+		}
+		else
+		{
+			pos = tab + 1;
+			continue;
+		}
+
+		partBegin = tab + 2;
+		pos = partBegin;
+	}
+
+	// a hierarchy without elements is serialized to the name delimiter only
+	if (state == NAME && nameElements.empty() && partBegin == end)
+	{
+		return true;
+	}
+
+	if (state != POSTFIX)
+	{
+		nameElements.clear();
+		return false;
+	}
+
+	element.postfix = {partBegin, static_cast<size_t>(end - partBegin)};
+	nameElements.push_back(element);
+	return true;
+}
+
+NameHierarchy deserializeNameHierarchyFromDatabaseString(const std::string& serializedName, std::string* error)
+{
+	NameHierarchy nameHierarchy;
+
+	StringRef nameDelimiter;
+	std::vector<NameElementRef> nameElements;
+	if (!parseNameHierarchyDatabaseString(serializedName.data(), serializedName.size(), nameDelimiter, nameElements))
+	{
+		if (error)
+		{
+			*error = "String \"" + serializedName + "\" is not in Sourcetrail database format.";
+		}
+		return nameHierarchy;
+	}
+
+	nameHierarchy.nameDelimiter = nameDelimiter.toString();
+	nameHierarchy.nameElements.reserve(nameElements.size());
+	for (const NameElementRef& element: nameElements)
+	{
+		NameElement nameElement;
+		nameElement.prefix = element.prefix.toString();
+		nameElement.name = element.name.toString();
+		nameElement.postfix = element.postfix.toString();
+		nameHierarchy.nameElements.push_back(nameElement);
+	}
+	return nameHierarchy;
 }
 }	 // namespace sourcetrail
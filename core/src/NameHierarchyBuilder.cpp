@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "NameHierarchyBuilder.h"
+
+#include <cstring>
+
+#include "SourcetrailException.h"
+#include "utility.h"
+
+namespace
+{
+const size_t POOL_BLOCK_SIZE = 64 * 1024;
+}
+
+namespace sourcetrail
+{
+size_t NameStringPool::StringRefHash::operator()(const StringRef& s) const
+{
+	return static_cast<size_t>(utility::getHash64(s.data, s.size));
+}
+
+bool NameStringPool::StringRefEqual::operator()(const StringRef& a, const StringRef& b) const
+{
+	return a.size == b.size && (a.size == 0 || memcmp(a.data, b.data, a.size) == 0);
+}
+
+NameStringPool::NameStringPool(): m_currentBlock(nullptr), m_blockUsedSize(POOL_BLOCK_SIZE) {}
+
+uint32_t NameStringPool::intern(const char* data, size_t size)
+{
+	auto it = m_ids.find({data, size});
+	if (it != m_ids.end())
+	{
+		return it->second;
+	}
+
+	const uint32_t id = static_cast<uint32_t>(m_strings.size());
+	const StringRef s = {allocate(data, size), size};
+	m_strings.push_back(s);
+	m_ids.emplace(s, id);
+	return id;
+}
+
+StringRef NameStringPool::getString(uint32_t id) const
+{
+	return m_strings[id];
+}
+
+size_t NameStringPool::getStringCount() const
+{
+	return m_strings.size();
+}
+
+const char* NameStringPool::allocate(const char* data, size_t size)
+{
+	char* destination = nullptr;
+	if (size > POOL_BLOCK_SIZE / 4)
+	{
+		// large strings get a block of their own, so the current block keeps being filled
+		m_blocks.emplace_back(new char[size]);
+		destination = m_blocks.back().get();
+	}
+	else
+	{
+		if (m_blockUsedSize + size > POOL_BLOCK_SIZE)
+		{
+			m_blocks.emplace_back(new char[POOL_BLOCK_SIZE]);
+			m_currentBlock = m_blocks.back().get();
+			m_blockUsedSize = 0;
+		}
+		destination = m_currentBlock + m_blockUsedSize;
+		m_blockUsedSize += size;
+	}
+
+	if (size > 0)
+	{
+		memcpy(destination, data, size);
+	}
+	return destination;
+}
+
+NameHierarchyBuilder::NameHierarchyBuilder(const std::string& nameDelimiter)
+	: NameHierarchyBuilder(std::make_shared<NameStringPool>(), nameDelimiter)
+{
+}
+
+void NameHierarchyBuilder::setNameDelimiter(const std::string& nameDelimiter)
+{
+	m_nameDelimiterId = m_pool->intern(nameDelimiter.data(), nameDelimiter.size());
+}
+
+void NameHierarchyBuilder::pushElement(const std::string& prefix, const std::string& name, const std::string& postfix)
+{
+	m_elements.push_back(
+		{m_pool->intern(prefix.data(), prefix.size()),
+		 m_pool->intern(name.data(), name.size()),
+		 m_pool->intern(postfix.data(), postfix.size())});
+}
+
+void NameHierarchyBuilder::pushElement(const char* prefix, const char* name, const char* postfix)
+{
+	m_elements.push_back(
+		{m_pool->intern(prefix, strlen(prefix)), m_pool->intern(name, strlen(name)), m_pool->intern(postfix, strlen(postfix))});
+}
+
+void NameHierarchyBuilder::popElement()
+{
+	if (m_elements.empty())
+	{
+		throw SourcetrailException("Unable to remove an element from an empty name hierarchy.");
+	}
+	m_elements.pop_back();
+}
+
+void NameHierarchyBuilder::clear()
+{
+	m_elements.clear();
+}
+
+size_t NameHierarchyBuilder::getElementCount() const
+{
+	return m_elements.size();
+}
+
+NameHierarchy NameHierarchyBuilder::toNameHierarchy() const
+{
+	NameHierarchy nameHierarchy;
+	nameHierarchy.nameDelimiter = m_pool->getString(m_nameDelimiterId).toString();
+	for (const Element& element: m_elements)
+	{
+		nameHierarchy.nameElements.push_back(
+			{m_pool->getString(element.prefixId).toString(),
+			 m_pool->getString(element.nameId).toString(),
+			 m_pool->getString(element.postfixId).toString()});
+	}
+	return nameHierarchy;
+}
+
+void NameHierarchyBuilder::appendToDatabaseString(size_t elementCount, std::string& serializedName) const
+{
+	// same format as serializeNameHierarchyToDatabaseString()
+	if (elementCount == 1)
+	{
+		append(serializedName, m_nameDelimiterId);
+		serializedName += "\tm";
+	}
+	else
+	{
+		serializedName += "\tn";
+	}
+
+	const Element& element = m_elements[elementCount - 1];
+	append(serializedName, element.nameId);
+	serializedName += "\ts";
+	append(serializedName, element.prefixId);
+	serializedName += "\tp";
+	append(serializedName, element.postfixId);
+}
+
+NameHierarchyBuilder::NameHierarchyBuilder(std::shared_ptr<NameStringPool> pool, const std::string& nameDelimiter)
+	: m_pool(pool), m_nameDelimiterId(0)
+{
+	setNameDelimiter(nameDelimiter);
+}
+
+void NameHierarchyBuilder::append(std::string& s, uint32_t id) const
+{
+	const StringRef part = m_pool->getString(id);
+	s.append(part.data, part.size);
+}
+}	 // namespace sourcetrail
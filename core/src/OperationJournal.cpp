@@ -0,0 +1,660 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OperationJournal.h"
+
+#include <iterator>
+
+#include "DefinitionKind.h"
+#include "ReferenceKind.h"
+#include "SourcetrailDBWriter.h"
+#include "SourcetrailException.h"
+#include "SymbolKind.h"
+
+namespace
+{
+const char JOURNAL_MAGIC[] = "SRCTRLJ";
+const uint32_t JOURNAL_VERSION = 1;
+
+// size of the buffered entries that triggers a write to the journal file
+const size_t JOURNAL_BUFFER_CAPACITY = 1 << 20;
+
+void appendVarint(std::string& data, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<char>(value));
+}
+
+void appendInt(std::string& data, int value)
+{
+	// zigzag encoding keeps small negative values short
+	const uint32_t bits = static_cast<uint32_t>(value);
+	appendVarint(data, (bits << 1) ^ (value < 0 ? 0xFFFFFFFF : 0));
+}
+
+void appendString(std::string& data, const std::string& value)
+{
+	appendVarint(data, static_cast<uint32_t>(value.size()));
+	data.append(value);
+}
+
+enum class ResultKind
+{
+	NONE,
+	ID,
+	IDS
+};
+
+ResultKind getResultKind(sourcetrail::JournalOperation operation)
+{
+	switch (operation)
+	{
+	case sourcetrail::JournalOperation::RECORD_SYMBOL:
+	case sourcetrail::JournalOperation::RECORD_REFERENCE:
+	case sourcetrail::JournalOperation::RECORD_REFERENCE_TO_UNSOLVED_SYMBOL:
+	case sourcetrail::JournalOperation::RECORD_FILE:
+	case sourcetrail::JournalOperation::RECORD_LOCAL_SYMBOL:
+		return ResultKind::ID;
+	case sourcetrail::JournalOperation::RECORD_REFERENCES:
+		return ResultKind::IDS;
+	default:
+		return ResultKind::NONE;
+	}
+}
+
+// maps the ids of the journaled session to the ids created by the replay
+class IdMap
+{
+public:
+	int get(int journaledId) const
+	{
+		std::unordered_map<int, int>::const_iterator it = m_ids.find(journaledId);
+		return it != m_ids.end() ? it->second : journaledId;
+	}
+
+	void set(int journaledId, int replayedId)
+	{
+		if (journaledId != 0 && replayedId != 0)
+		{
+			m_ids[journaledId] = replayedId;
+		}
+	}
+
+	sourcetrail::SourceRange get(sourcetrail::SourceRange sourceRange) const
+	{
+		sourceRange.fileId = get(sourceRange.fileId);
+		return sourceRange;
+	}
+
+	void clear()
+	{
+		m_ids.clear();
+	}
+
+private:
+	std::unordered_map<int, int> m_ids;
+};
+}	 // namespace
+
+namespace sourcetrail
+{
+OperationJournal::Entry::Entry(OperationJournal* journal, JournalOperation operation)
+	: m_journal(journal), m_operation(operation), m_hasResult(false)
+{
+	if (m_journal)
+	{
+		m_data.push_back(static_cast<char>(operation));
+	}
+}
+
+OperationJournal::Entry::~Entry()
+{
+	if (m_journal)
+	{
+		if (!m_hasResult)
+		{
+			switch (getResultKind(m_operation))
+			{
+			case ResultKind::ID:
+				setResultId(0);
+				break;
+			case ResultKind::IDS:
+				setResultIds(nullptr, 0);
+				break;
+			case ResultKind::NONE:
+				break;
+			}
+		}
+		m_journal->append(m_data);
+	}
+}
+
+void OperationJournal::Entry::addInt(int value)
+{
+	if (m_journal)
+	{
+		appendInt(m_data, value);
+	}
+}
+
+void OperationJournal::Entry::addString(const std::string& value)
+{
+	if (m_journal)
+	{
+		appendString(m_data, value);
+	}
+}
+
+void OperationJournal::Entry::addName(const std::string& value)
+{
+	if (m_journal)
+	{
+		appendString(m_data, m_journal->anonymize(value));
+	}
+}
+
+void OperationJournal::Entry::addNameHierarchy(const NameHierarchy& nameHierarchy)
+{
+	if (m_journal)
+	{
+		appendString(m_data, nameHierarchy.nameDelimiter);
+		appendVarint(m_data, static_cast<uint32_t>(nameHierarchy.nameElements.size()));
+		for (const NameElement& nameElement: nameHierarchy.nameElements)
+		{
+			addName(nameElement.prefix);
+			addName(nameElement.name);
+			addName(nameElement.postfix);
+		}
+	}
+}
+
+void OperationJournal::Entry::addSourceRange(const SourceRange& sourceRange)
+{
+	if (m_journal)
+	{
+		appendInt(m_data, sourceRange.fileId);
+		appendInt(m_data, sourceRange.startLine);
+		appendInt(m_data, sourceRange.startColumn);
+		appendInt(m_data, sourceRange.endLine);
+		appendInt(m_data, sourceRange.endColumn);
+	}
+}
+
+void OperationJournal::Entry::addRows(const int* values, size_t valueCount)
+{
+	if (m_journal)
+	{
+		appendVarint(m_data, static_cast<uint32_t>(valueCount));
+		for (size_t i = 0; i < valueCount; i++)
+		{
+			appendInt(m_data, values[i]);
+		}
+	}
+}
+
+int OperationJournal::Entry::setResultId(int id)
+{
+	addInt(id);
+	m_hasResult = true;
+	return id;
+}
+
+void OperationJournal::Entry::setResultIds(const int* ids, size_t idCount)
+{
+	addRows(ids, idCount);
+	m_hasResult = true;
+}
+
+OperationJournal::OperationJournal(const std::string& journalFilePath, bool anonymize): m_anonymize(anonymize)
+{
+	m_file.open(journalFilePath, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (m_file.fail())
+	{
+		throw SourcetrailException("Unable to create journal file \"" + journalFilePath + "\".");
+	}
+
+	m_buffer.reserve(JOURNAL_BUFFER_CAPACITY);
+	m_buffer.append(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC) - 1);
+	appendVarint(m_buffer, JOURNAL_VERSION);
+}
+
+OperationJournal::~OperationJournal()
+{
+	flush();
+	m_file.close();
+}
+
+const std::string& OperationJournal::anonymize(const std::string& value)
+{
+	if (!m_anonymize || value.empty())
+	{
+		return value;
+	}
+
+	std::unordered_map<std::string, std::string>::const_iterator it = m_anonymizedStrings.find(value);
+	if (it != m_anonymizedStrings.end())
+	{
+		return it->second;
+	}
+
+	// base 36 counter padded with '_', which is not a digit, so tokens of different strings never collide
+	std::string token;
+	size_t number = m_anonymizedStrings.size();
+	do
+	{
+		token.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[number % 36]);
+		number /= 36;
+	} while (number > 0);
+	if (token.size() < value.size())
+	{
+		token.append(value.size() - token.size(), '_');
+	}
+
+	return m_anonymizedStrings.emplace(value, token).first->second;
+}
+
+void OperationJournal::append(const std::string& data)
+{
+	m_buffer.append(data);
+	if (m_buffer.size() >= JOURNAL_BUFFER_CAPACITY)
+	{
+		flush();
+	}
+}
+
+void OperationJournal::flush()
+{
+	m_file.write(m_buffer.data(), m_buffer.size());
+	m_buffer.clear();
+}
+
+OperationJournalReader::OperationJournalReader(const std::string& journalFilePath): m_position(0)
+{
+	std::ifstream file(journalFilePath, std::ios::binary | std::ios::in);
+	if (file.fail())
+	{
+		throw SourcetrailException("Unable to open journal file \"" + journalFilePath + "\".");
+	}
+	m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	const size_t magicSize = sizeof(JOURNAL_MAGIC) - 1;
+	if (m_data.compare(0, magicSize, JOURNAL_MAGIC) != 0)
+	{
+		throw SourcetrailException("File \"" + journalFilePath + "\" is no operation journal.");
+	}
+	m_position = magicSize;
+
+	const uint32_t version = readVarint();
+	if (version != JOURNAL_VERSION)
+	{
+		throw SourcetrailException(
+			"Operation journal \"" + journalFilePath + "\" has unsupported version " + std::to_string(version) + ".");
+	}
+}
+
+size_t OperationJournalReader::getByteCount() const
+{
+	return m_data.size();
+}
+
+bool OperationJournalReader::readOperation(JournalOperation& operation)
+{
+	if (m_position >= m_data.size())
+	{
+		return false;
+	}
+	operation = static_cast<JournalOperation>(m_data[m_position++]);
+	return true;
+}
+
+int OperationJournalReader::readInt()
+{
+	const uint32_t value = readVarint();
+	return static_cast<int>((value >> 1) ^ (0 - (value & 1)));
+}
+
+std::string OperationJournalReader::readString()
+{
+	const size_t size = readVarint();
+	if (size > m_data.size() - m_position)
+	{
+		throw SourcetrailException("Operation journal ends unexpectedly.");
+	}
+	const size_t position = m_position;
+	m_position += size;
+	return m_data.substr(position, size);
+}
+
+NameHierarchy OperationJournalReader::readNameHierarchy()
+{
+	NameHierarchy nameHierarchy;
+	nameHierarchy.nameDelimiter = readString();
+	const uint32_t nameElementCount = readVarint();
+	for (uint32_t i = 0; i < nameElementCount; i++)
+	{
+		NameElement nameElement;
+		nameElement.prefix = readString();
+		nameElement.name = readString();
+		nameElement.postfix = readString();
+		nameHierarchy.nameElements.push_back(nameElement);
+	}
+	return nameHierarchy;
+}
+
+SourceRange OperationJournalReader::readSourceRange()
+{
+	SourceRange sourceRange;
+	sourceRange.fileId = readInt();
+	sourceRange.startLine = readInt();
+	sourceRange.startColumn = readInt();
+	sourceRange.endLine = readInt();
+	sourceRange.endColumn = readInt();
+	return sourceRange;
+}
+
+std::vector<int> OperationJournalReader::readRows()
+{
+	const uint32_t valueCount = readVarint();
+	if (valueCount > m_data.size() - m_position)
+	{
+		throw SourcetrailException("Operation journal ends unexpectedly.");
+	}
+
+	std::vector<int> values;
+	values.reserve(valueCount);
+	for (uint32_t i = 0; i < valueCount; i++)
+	{
+		values.push_back(readInt());
+	}
+	return values;
+}
+
+uint32_t OperationJournalReader::readVarint()
+{
+	uint32_t value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (m_position >= m_data.size())
+		{
+			throw SourcetrailException("Operation journal ends unexpectedly.");
+		}
+		const uint8_t byte = static_cast<uint8_t>(m_data[m_position++]);
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+	throw SourcetrailException("Operation journal contains an invalid integer.");
+}
+
+OperationJournalReplayResult replayOperationJournal(
+	OperationJournalReader& reader, const std::string& databaseFilePath, SourcetrailDBWriter& writer)
+{
+	OperationJournalReplayResult result;
+	IdMap ids;
+
+	JournalOperation operation;
+	while (reader.readOperation(operation))
+	{
+		bool success = true;
+		switch (operation)
+		{
+		case JournalOperation::OPEN:
+			reader.readString();
+			ids.clear();
+			success = writer.open(databaseFilePath);
+			break;
+		case JournalOperation::CLOSE:
+			success = writer.close();
+			break;
+		case JournalOperation::CLEAR:
+			ids.clear();
+			success = writer.clear();
+			break;
+		case JournalOperation::BEGIN_TRANSACTION:
+			success = writer.beginTransaction();
+			break;
+		case JournalOperation::COMMIT_TRANSACTION:
+			success = writer.commitTransaction();
+			break;
+		case JournalOperation::ROLLBACK_TRANSACTION:
+			success = writer.rollbackTransaction();
+			break;
+		case JournalOperation::OPTIMIZE_DATABASE_MEMORY:
+			success = writer.optimizeDatabaseMemory();
+			break;
+		case JournalOperation::OPTIMIZE_DATABASE_LOCALITY:
+			success = writer.optimizeDatabaseLocality();
+			break;
+		case JournalOperation::ANALYZE_DATABASE:
+			success = writer.analyzeDatabase();
+			break;
+		case JournalOperation::SET_ANALYZE_ON_CLOSE_ENABLED:
+			writer.setAnalyzeOnCloseEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::SET_NAME_INDEX_ENABLED:
+			writer.setNameIndexEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::SET_HASH_KEYS_ENABLED:
+			writer.setHashKeysEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::SET_ATOMIC_BUILD_ENABLED:
+			writer.setAtomicBuildEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::SET_RECREATE_ON_CLEAR_ENABLED:
+			writer.setRecreateOnClearEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::UPDATE_NAME_INDEX:
+			success = writer.updateNameIndex();
+			break;
+		case JournalOperation::SET_LOCATION_INDEX_ENABLED:
+			writer.setLocationIndexEnabled(reader.readInt() != 0);
+			break;
+		case JournalOperation::UPDATE_LOCATION_INDEX:
+			success = writer.updateLocationIndex();
+			break;
+		case JournalOperation::RECORD_SYMBOL:
+		{
+			const NameHierarchy nameHierarchy = reader.readNameHierarchy();
+			const int symbolId = writer.recordSymbol(nameHierarchy);
+			ids.set(reader.readInt(), symbolId);
+			success = symbolId != 0;
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_DEFINITION_KIND:
+		{
+			const int symbolId = ids.get(reader.readInt());
+			success = writer.recordSymbolDefinitionKind(symbolId, intToDefinitionKind(reader.readInt()));
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_KIND:
+		{
+			const int symbolId = ids.get(reader.readInt());
+			success = writer.recordSymbolKind(symbolId, static_cast<SymbolKind>(reader.readInt()));
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_LOCATION:
+		{
+			const int symbolId = ids.get(reader.readInt());
+			success = writer.recordSymbolLocation(symbolId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_LOCATIONS:
+		case JournalOperation::RECORD_REFERENCE_LOCATIONS:
+		{
+			std::vector<int> rows = reader.readRows();
+			for (size_t i = 0; i + 6 <= rows.size(); i += 6)
+			{
+				rows[i] = ids.get(rows[i]);
+				rows[i + 1] = ids.get(rows[i + 1]);
+			}
+			success = operation == JournalOperation::RECORD_SYMBOL_LOCATIONS
+				? writer.recordSymbolLocations(rows.data(), rows.size() / 6)
+				: writer.recordReferenceLocations(rows.data(), rows.size() / 6);
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_SCOPE_LOCATION:
+		{
+			const int symbolId = ids.get(reader.readInt());
+			success = writer.recordSymbolScopeLocation(symbolId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_SYMBOL_SIGNATURE_LOCATION:
+		{
+			const int symbolId = ids.get(reader.readInt());
+			success = writer.recordSymbolSignatureLocation(symbolId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_REFERENCE:
+		{
+			const int contextSymbolId = ids.get(reader.readInt());
+			const int referencedSymbolId = ids.get(reader.readInt());
+			const ReferenceKind referenceKind = static_cast<ReferenceKind>(reader.readInt());
+			const int referenceId = writer.recordReference(contextSymbolId, referencedSymbolId, referenceKind);
+			ids.set(reader.readInt(), referenceId);
+			success = referenceId != 0;
+			break;
+		}
+		case JournalOperation::RECORD_REFERENCES:
+		{
+			std::vector<int> rows = reader.readRows();
+			for (size_t i = 0; i + 3 <= rows.size(); i += 3)
+			{
+				rows[i] = ids.get(rows[i]);
+				rows[i + 1] = ids.get(rows[i + 1]);
+			}
+			std::vector<int> referenceIds(rows.size() / 3, 0);
+			success = writer.recordReferences(rows.data(), referenceIds.size(), referenceIds.data());
+
+			const std::vector<int> journaledReferenceIds = reader.readRows();
+			for (size_t i = 0; i < journaledReferenceIds.size() && i < referenceIds.size(); i++)
+			{
+				ids.set(journaledReferenceIds[i], referenceIds[i]);
+			}
+			break;
+		}
+		case JournalOperation::RECORD_REFERENCE_LOCATION:
+		{
+			const int referenceId = ids.get(reader.readInt());
+			success = writer.recordReferenceLocation(referenceId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_REFERENCE_IS_AMBIGUOUS:
+			success = writer.recordReferenceIsAmbiguous(ids.get(reader.readInt()));
+			break;
+		case JournalOperation::RECORD_REFERENCE_TO_UNSOLVED_SYMBOL:
+		{
+			const int contextSymbolId = ids.get(reader.readInt());
+			const ReferenceKind referenceKind = static_cast<ReferenceKind>(reader.readInt());
+			const SourceRange location = ids.get(reader.readSourceRange());
+			const int referenceId = writer.recordReferenceToUnsolvedSymhol(contextSymbolId, referenceKind, location);
+			ids.set(reader.readInt(), referenceId);
+			success = referenceId != 0;
+			break;
+		}
+		case JournalOperation::RECORD_QUALIFIER_LOCATION:
+		{
+			const int referencedSymbolId = ids.get(reader.readInt());
+			success = writer.recordQualifierLocation(referencedSymbolId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_FILE:
+		{
+			const std::string filePath = reader.readString();
+			const int fileId = writer.recordFile(filePath);
+			ids.set(reader.readInt(), fileId);
+			success = fileId != 0;
+			break;
+		}
+		case JournalOperation::RECORD_FILE_LANGUAGE:
+		{
+			const int fileId = ids.get(reader.readInt());
+			success = writer.recordFileLanguage(fileId, reader.readString());
+			break;
+		}
+		case JournalOperation::RECORD_LOCAL_SYMBOL:
+		{
+			const std::string name = reader.readString();
+			const int localSymbolId = writer.recordLocalSymbol(name);
+			ids.set(reader.readInt(), localSymbolId);
+			success = localSymbolId != 0;
+			break;
+		}
+		case JournalOperation::RECORD_LOCAL_SYMBOL_LOCATION:
+		{
+			const int localSymbolId = ids.get(reader.readInt());
+			success = writer.recordLocalSymbolLocation(localSymbolId, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::RECORD_ATOMIC_SOURCE_RANGE:
+			success = writer.recordAtomicSourceRange(ids.get(reader.readSourceRange()));
+			break;
+		case JournalOperation::RECORD_ERROR:
+		{
+			const std::string message = reader.readString();
+			const bool fatal = reader.readInt() != 0;
+			success = writer.recordError(message, fatal, ids.get(reader.readSourceRange()));
+			break;
+		}
+		case JournalOperation::OPEN_IN_MEMORY:
+		{
+			reader.readString();
+			const size_t memoryLimit = static_cast<size_t>(std::stoull(reader.readString()));
+			const bool vacuum = reader.readInt() != 0;
+			ids.clear();
+			success = writer.openInMemory(databaseFilePath, memoryLimit, vacuum);
+			break;
+		}
+		case JournalOperation::OPEN_INGEST_LOG:
+			reader.readString();
+			ids.clear();
+			success = writer.openIngestLog(databaseFilePath + ".log");
+			break;
+		case JournalOperation::MATERIALIZE_INGEST_LOG:
+			reader.readString();
+			success = writer.materializeIngestLog(databaseFilePath + ".log");
+			break;
+		case JournalOperation::RESUME_INGEST_LOG:
+			reader.readString();
+			success = writer.resumeIngestLog(databaseFilePath + ".log");
+			break;
+		case JournalOperation::RECORD_FILE_COMMITTED:
+			success = writer.recordFileCommitted(ids.get(reader.readInt()));
+			break;
+		default:
+			throw SourcetrailException(
+				"Operation journal contains unknown operation " + std::to_string(static_cast<int>(operation)) + ".");
+		}
+
+		result.operationCount++;
+		if (!success)
+		{
+			if (result.failedOperationCount == 0)
+			{
+				result.firstError = writer.getLastError();
+			}
+			result.failedOperationCount++;
+		}
+	}
+
+	return result;
+}
+}	 // namespace sourcetrail
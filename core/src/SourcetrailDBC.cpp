@@ -0,0 +1,502 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SourcetrailDBC.h"
+
+#include <new>
+#include <string>
+
+#include "DefinitionKind.h"
+#include "NameHierarchy.h"
+#include "ReferenceKind.h"
+#include "SourcetrailDBWriter.h"
+#include "SymbolKind.h"
+
+static_assert(SRCTRL_DEFINITION_EXPLICIT == static_cast<int>(sourcetrail::DefinitionKind::EXPLICIT), "definition kinds differ");
+static_assert(SRCTRL_SYMBOL_UNION == static_cast<int>(sourcetrail::SymbolKind::UNION), "symbol kinds differ");
+static_assert(
+	SRCTRL_REFERENCE_ANNOTATION_USAGE == static_cast<int>(sourcetrail::ReferenceKind::ANNOTATION_USAGE),
+	"reference kinds differ");
+
+struct srctrl_writer
+{
+	sourcetrail::SourcetrailDBWriter writer;
+	std::string lastError;
+};
+
+namespace
+{
+const char* const INVALID_ARGUMENT_MESSAGE = "Invalid argument: ";
+
+bool isValidString(const char* data, size_t length)
+{
+	return data || length == 0;
+}
+
+bool isValidString(const srctrl_string& string)
+{
+	return isValidString(string.data, string.length);
+}
+
+std::string toString(const char* data, size_t length)
+{
+	return length ? std::string(data, length) : std::string();
+}
+
+std::string toString(const srctrl_string& string)
+{
+	return toString(string.data, string.length);
+}
+
+int setInvalidArgument(srctrl_writer* writer, const std::string& message)
+{
+	writer->writer.setLastError(INVALID_ARGUMENT_MESSAGE + message);
+	return SRCTRL_ERROR_INVALID_ARGUMENT;
+}
+
+bool toNameHierarchy(const srctrl_symbol& symbol, sourcetrail::NameHierarchy& nameHierarchy)
+{
+	if (!isValidString(symbol.nameDelimiter) || !symbol.nameElements || symbol.nameElementCount == 0)
+	{
+		return false;
+	}
+
+	nameHierarchy.nameDelimiter = toString(symbol.nameDelimiter);
+	nameHierarchy.nameElements.resize(symbol.nameElementCount);
+	for (size_t i = 0; i < symbol.nameElementCount; i++)
+	{
+		const srctrl_name_element& element = symbol.nameElements[i];
+		if (!isValidString(element.prefix) || !isValidString(element.name) || !isValidString(element.postfix))
+		{
+			return false;
+		}
+		nameHierarchy.nameElements[i].prefix = toString(element.prefix);
+		nameHierarchy.nameElements[i].name = toString(element.name);
+		nameHierarchy.nameElements[i].postfix = toString(element.postfix);
+	}
+	return true;
+}
+
+bool isValidReferenceKind(int referenceKind)
+{
+	return referenceKind >= SRCTRL_REFERENCE_TYPE_USAGE && referenceKind <= SRCTRL_REFERENCE_ANNOTATION_USAGE;
+}
+
+// Runs a call on the writer and converts its result into a status code. No exception may leave the C interface.
+template <typename Function>
+int callWriter(srctrl_writer* writer, Function function)
+{
+	if (!writer)
+	{
+		return SRCTRL_ERROR_INVALID_ARGUMENT;
+	}
+
+	try
+	{
+		return function(writer->writer) ? SRCTRL_OK : SRCTRL_ERROR;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return SRCTRL_ERROR_OUT_OF_MEMORY;
+	}
+	catch (...)
+	{
+		writer->writer.setLastError("Unexpected exception.");
+		return SRCTRL_ERROR;
+	}
+}
+}	 // namespace
+
+void srctrl_get_version_string(const char** version, size_t* versionLength)
+{
+	static const std::string versionString = sourcetrail::SourcetrailDBWriter().getVersionString();
+	if (version)
+	{
+		*version = versionString.c_str();
+	}
+	if (versionLength)
+	{
+		*versionLength = versionString.size();
+	}
+}
+
+int srctrl_get_supported_database_version(void)
+{
+	return sourcetrail::SourcetrailDBWriter().getSupportedDatabaseVersion();
+}
+
+srctrl_writer* srctrl_writer_create(void)
+{
+	return new (std::nothrow) srctrl_writer();
+}
+
+void srctrl_writer_destroy(srctrl_writer* writer)
+{
+	delete writer;
+}
+
+int srctrl_writer_get_last_error(srctrl_writer* writer, const char** message, size_t* messageLength)
+{
+	if (!writer || !message || !messageLength)
+	{
+		return SRCTRL_ERROR_INVALID_ARGUMENT;
+	}
+
+	try
+	{
+		writer->lastError = writer->writer.getLastError();
+	}
+	catch (const std::bad_alloc&)
+	{
+		return SRCTRL_ERROR_OUT_OF_MEMORY;
+	}
+	*message = writer->lastError.c_str();
+	*messageLength = writer->lastError.size();
+	return SRCTRL_OK;
+}
+
+int srctrl_writer_clear_last_error(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) {
+		w.clearLastError();
+		return true;
+	});
+}
+
+int srctrl_open(srctrl_writer* writer, const char* databaseFilePath, size_t databaseFilePathLength)
+{
+	if (writer && !isValidString(databaseFilePath, databaseFilePathLength))
+	{
+		return setInvalidArgument(writer, "database file path is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.open(toString(databaseFilePath, databaseFilePathLength));
+	});
+}
+
+int srctrl_close(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.close(); });
+}
+
+int srctrl_clear(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.clear(); });
+}
+
+int srctrl_is_empty(srctrl_writer* writer, int* isEmpty)
+{
+	if (writer && !isEmpty)
+	{
+		return setInvalidArgument(writer, "output parameter is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*isEmpty = w.isEmpty() ? 1 : 0;
+		return true;
+	});
+}
+
+int srctrl_is_compatible(srctrl_writer* writer, int* isCompatible)
+{
+	if (writer && !isCompatible)
+	{
+		return setInvalidArgument(writer, "output parameter is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*isCompatible = w.isCompatible() ? 1 : 0;
+		return true;
+	});
+}
+
+int srctrl_get_loaded_database_version(srctrl_writer* writer, int* databaseVersion)
+{
+	if (writer && !databaseVersion)
+	{
+		return setInvalidArgument(writer, "output parameter is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*databaseVersion = w.getLoadedDatabaseVersion();
+		return true;
+	});
+}
+
+int srctrl_begin_transaction(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.beginTransaction(); });
+}
+
+int srctrl_commit_transaction(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.commitTransaction(); });
+}
+
+int srctrl_rollback_transaction(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.rollbackTransaction(); });
+}
+
+int srctrl_optimize_database_memory(srctrl_writer* writer)
+{
+	return callWriter(writer, [](sourcetrail::SourcetrailDBWriter& w) { return w.optimizeDatabaseMemory(); });
+}
+
+int srctrl_record_symbol(srctrl_writer* writer, const srctrl_symbol* symbol, int* symbolId)
+{
+	return srctrl_record_symbols(writer, symbol, 1, symbolId);
+}
+
+int srctrl_record_symbol_definition_kind(srctrl_writer* writer, int symbolId, int definitionKind)
+{
+	if (writer && definitionKind != SRCTRL_DEFINITION_IMPLICIT && definitionKind != SRCTRL_DEFINITION_EXPLICIT)
+	{
+		return setInvalidArgument(writer, "unknown definition kind " + std::to_string(definitionKind) + ".");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordSymbolDefinitionKind(symbolId, static_cast<sourcetrail::DefinitionKind>(definitionKind));
+	});
+}
+
+int srctrl_record_symbol_kind(srctrl_writer* writer, int symbolId, int symbolKind)
+{
+	if (writer && (symbolKind < SRCTRL_SYMBOL_TYPE || symbolKind > SRCTRL_SYMBOL_UNION))
+	{
+		return setInvalidArgument(writer, "unknown symbol kind " + std::to_string(symbolKind) + ".");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordSymbolKind(symbolId, static_cast<sourcetrail::SymbolKind>(symbolKind));
+	});
+}
+
+int srctrl_record_symbol_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordSymbolLocation(symbolId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_symbol_scope_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordSymbolScopeLocation(symbolId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_symbol_signature_location(
+	srctrl_writer* writer, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordSymbolSignatureLocation(symbolId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_reference(
+	srctrl_writer* writer, int contextSymbolId, int referencedSymbolId, int referenceKind, int* referenceId)
+{
+	if (writer && !referenceId)
+	{
+		return setInvalidArgument(writer, "output parameter is null.");
+	}
+	if (writer && !isValidReferenceKind(referenceKind))
+	{
+		return setInvalidArgument(writer, "unknown reference kind " + std::to_string(referenceKind) + ".");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*referenceId = w.recordReference(
+			contextSymbolId, referencedSymbolId, static_cast<sourcetrail::ReferenceKind>(referenceKind));
+		return *referenceId != 0;
+	});
+}
+
+int srctrl_record_reference_location(
+	srctrl_writer* writer, int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordReferenceLocation(referenceId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_reference_is_ambiguous(srctrl_writer* writer, int referenceId)
+{
+	return callWriter(
+		writer, [&](sourcetrail::SourcetrailDBWriter& w) { return w.recordReferenceIsAmbiguous(referenceId); });
+}
+
+int srctrl_record_reference_to_unsolved_symbol(
+	srctrl_writer* writer,
+	int contextSymbolId,
+	int referenceKind,
+	int fileId,
+	int startLine,
+	int startColumn,
+	int endLine,
+	int endColumn,
+	int* referenceId)
+{
+	if (writer && !referenceId)
+	{
+		return setInvalidArgument(writer, "output parameter is null.");
+	}
+	if (writer && !isValidReferenceKind(referenceKind))
+	{
+		return setInvalidArgument(writer, "unknown reference kind " + std::to_string(referenceKind) + ".");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*referenceId = w.recordReferenceToUnsolvedSymhol(
+			contextSymbolId,
+			static_cast<sourcetrail::ReferenceKind>(referenceKind),
+			{fileId, startLine, startColumn, endLine, endColumn});
+		return *referenceId != 0;
+	});
+}
+
+int srctrl_record_qualifier_location(
+	srctrl_writer* writer, int referencedSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordQualifierLocation(referencedSymbolId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_file(srctrl_writer* writer, const char* filePath, size_t filePathLength, int* fileId)
+{
+	if (writer && (!isValidString(filePath, filePathLength) || !fileId))
+	{
+		return setInvalidArgument(writer, "file path or output parameter is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*fileId = w.recordFile(toString(filePath, filePathLength));
+		return *fileId != 0;
+	});
+}
+
+int srctrl_record_file_language(
+	srctrl_writer* writer, int fileId, const char* languageIdentifier, size_t languageIdentifierLength)
+{
+	if (writer && !isValidString(languageIdentifier, languageIdentifierLength))
+	{
+		return setInvalidArgument(writer, "language identifier is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordFileLanguage(fileId, toString(languageIdentifier, languageIdentifierLength));
+	});
+}
+
+int srctrl_record_local_symbol(srctrl_writer* writer, const char* name, size_t nameLength, int* localSymbolId)
+{
+	if (writer && (!isValidString(name, nameLength) || !localSymbolId))
+	{
+		return setInvalidArgument(writer, "name or output parameter is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		*localSymbolId = w.recordLocalSymbol(toString(name, nameLength));
+		return *localSymbolId != 0;
+	});
+}
+
+int srctrl_record_local_symbol_location(
+	srctrl_writer* writer, int localSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordLocalSymbolLocation(localSymbolId, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_atomic_source_range(
+	srctrl_writer* writer, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordAtomicSourceRange({fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_error(
+	srctrl_writer* writer,
+	const char* message,
+	size_t messageLength,
+	int fatal,
+	int fileId,
+	int startLine,
+	int startColumn,
+	int endLine,
+	int endColumn)
+{
+	if (writer && !isValidString(message, messageLength))
+	{
+		return setInvalidArgument(writer, "message is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordError(
+			toString(message, messageLength), fatal != 0, {fileId, startLine, startColumn, endLine, endColumn});
+	});
+}
+
+int srctrl_record_symbols(srctrl_writer* writer, const srctrl_symbol* symbols, size_t symbolCount, int* symbolIds)
+{
+	if (writer && symbolCount && (!symbols || !symbolIds))
+	{
+		return setInvalidArgument(writer, "symbols or output array is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		sourcetrail::NameHierarchy nameHierarchy;
+		for (size_t i = 0; i < symbolCount; i++)
+		{
+			if (!toNameHierarchy(symbols[i], nameHierarchy))
+			{
+				w.setLastError("Failed to record symbol in row " + std::to_string(i) + ": name hierarchy is invalid.");
+				return false;
+			}
+			symbolIds[i] = w.recordSymbol(nameHierarchy);
+			if (!symbolIds[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+int srctrl_record_symbol_locations(srctrl_writer* writer, const int* rows, size_t rowCount)
+{
+	if (writer && rowCount && !rows)
+	{
+		return setInvalidArgument(writer, "rows are null.");
+	}
+	return callWriter(
+		writer, [&](sourcetrail::SourcetrailDBWriter& w) { return w.recordSymbolLocations(rows, rowCount); });
+}
+
+int srctrl_record_references(srctrl_writer* writer, const int* rows, size_t rowCount, int* referenceIds)
+{
+	if (writer && rowCount && (!rows || !referenceIds))
+	{
+		return setInvalidArgument(writer, "rows or output array is null.");
+	}
+	return callWriter(writer, [&](sourcetrail::SourcetrailDBWriter& w) {
+		return w.recordReferences(rows, rowCount, referenceIds);
+	});
+}
+
+int srctrl_record_reference_locations(srctrl_writer* writer, const int* rows, size_t rowCount)
+{
+	if (writer && rowCount && !rows)
+	{
+		return setInvalidArgument(writer, "rows are null.");
+	}
+	return callWriter(
+		writer, [&](sourcetrail::SourcetrailDBWriter& w) { return w.recordReferenceLocations(rows, rowCount); });
+}
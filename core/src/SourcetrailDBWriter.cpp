@@ -28,10 +28,13 @@
 #include "LocationKind.h"
 #include "NameHierarchy.h"
 #include "NodeKind.h"
+#include "OperationJournal.h"
 #include "ReferenceKind.h"
 #include "SourceRange.h"
 #include "SourcetrailException.h"
+#include "StatisticsCounters.h"
 #include "SymbolKind.h"
+#include "TraceRecorder.h"
 #include "utility.h"
 #include "version.h"
 
@@ -39,7 +42,23 @@ namespace sourcetrail
 {
 // --- Public Interface ---
 
-SourcetrailDBWriter::SourcetrailDBWriter(): m_lastError("") {}
+SourcetrailDBWriter::SourcetrailDBWriter()
+	: m_statistics(new StatisticsCounters())
+	, m_lastError("")
+	, m_lastErrorRowKind(nullptr)
+	, m_lastErrorRow(0)
+	, m_nameIndexEnabled(false)
+	, m_hashKeysEnabled(false)
+	, m_locationIndexEnabled(false)
+	, m_atomicBuildEnabled(false)
+	, m_recreateOnClearEnabled(false)
+	, m_analyzeOnCloseEnabled(false)
+	, m_inMemory(false)
+	, m_memoryLimit(0)
+	, m_vacuumOnClose(false)
+	, m_namePool(std::make_shared<NameStringPool>())
+{
+}
 
 SourcetrailDBWriter::~SourcetrailDBWriter() {}
 
@@ -55,70 +74,137 @@ int SourcetrailDBWriter::getSupportedDatabaseVersion() const
 
 const std::string& SourcetrailDBWriter::getLastError() const
 {
+	if (!m_lastErrorStatus.isOk())
+	{
+		m_lastError = DatabaseStorage::getErrorMessage(m_lastErrorStatus);
+		if (m_lastErrorRowKind)
+		{
+			m_lastError = "Failed to record " + std::string(m_lastErrorRowKind) + " in row " +
+				std::to_string(m_lastErrorRow) + ": " + m_lastError;
+		}
+		m_lastErrorStatus = StorageStatus();
+	}
 	return m_lastError;
 }
 
 void SourcetrailDBWriter::setLastError(const std::string& error) const
 {
 	m_lastError = error;
+	m_lastErrorStatus = StorageStatus();
 }
 
 void SourcetrailDBWriter::clearLastError()
 {
 	m_lastError.clear();
+	m_lastErrorStatus = StorageStatus();
 }
 
 bool SourcetrailDBWriter::open(const std::string& databaseFilePath)
 {
-	m_databaseFilePath = databaseFilePath;
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::OPEN);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "open");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::OPEN);
+	journalEntry.addName(databaseFilePath);
 
-	m_projectFilePath = databaseFilePath;	 // FIXME: only find dot after last slash/backslash! otherwise it may be part of the file path
-	const size_t pos = m_projectFilePath.rfind('.');
-	if (pos != std::string::npos)
-	{
-		m_projectFilePath = m_projectFilePath.substr(0, pos);
-	}
-	m_projectFilePath += ".srctrlprj";
+	return openProject(databaseFilePath, false, 0, false);
+}
+
+bool SourcetrailDBWriter::openInMemory(const std::string& databaseFilePath, size_t memoryLimit, bool vacuum)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::OPEN_IN_MEMORY);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "open in memory");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::OPEN_IN_MEMORY);
+	journalEntry.addName(databaseFilePath);
+	journalEntry.addString(std::to_string(memoryLimit));
+	journalEntry.addInt(vacuum);
+
+	return openProject(databaseFilePath, true, memoryLimit, vacuum);
+}
+
+bool SourcetrailDBWriter::openIngestLog(const std::string& ingestLogFilePath)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::OPEN_INGEST_LOG);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "open ingest log");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::OPEN_INGEST_LOG);
+	journalEntry.addName(ingestLogFilePath);
 
+	try
 	{
-		bool projectFileExists = false;
-		{
-			std::ifstream f(m_projectFilePath.c_str());
-			projectFileExists = f.good();
-			f.close();
-		}
-		if (!projectFileExists)
+		if (m_storage)
 		{
-			try
-			{
-				createOrResetProjectFile();
-			}
-			catch (const SourcetrailException e)
-			{
-				m_lastError = e.getMessage();
-				return false;
-			}
+			closeDatabase();
 		}
+
+		m_databaseFilePath = ingestLogFilePath;
+		m_temporaryFilePath.clear();
+		m_projectFilePath.clear();
+
+		m_storage = DatabaseStorage::openIngestLog(ingestLogFilePath);
+		m_nodeIdCache.clear();
+		m_storage->setStatisticsCounters(m_statistics.get());
+		m_storage->setTraceRecorder(m_trace.get());
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+
+	return true;
+}
+
+bool SourcetrailDBWriter::materializeIngestLog(const std::string& ingestLogFilePath)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::MATERIALIZE_INGEST_LOG);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "materialize ingest log");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::MATERIALIZE_INGEST_LOG);
+	journalEntry.addName(ingestLogFilePath);
+
+	if (!m_storage || m_storage->isIngestLog())
+	{
+		setLastError("Unable to materialize ingest log, because no database is currently open.");
+		return false;
 	}
 
 	try
 	{
-		openDatabase();
+		m_storage->materializeIngestLog(ingestLogFilePath);
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
+	return true;
+}
+
+bool SourcetrailDBWriter::resumeIngestLog(const std::string& ingestLogFilePath)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RESUME_INGEST_LOG);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "resume ingest log");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RESUME_INGEST_LOG);
+	journalEntry.addName(ingestLogFilePath);
+
 	try
 	{
-		setupDatabaseTables();
-		updateProjectSettingsText();
+		if (m_storage)
+		{
+			closeDatabase();
+		}
+
+		m_databaseFilePath = ingestLogFilePath;
+		m_temporaryFilePath.clear();
+		m_projectFilePath.clear();
+
+		m_storage = DatabaseStorage::resumeIngestLog(ingestLogFilePath);
+		m_nodeIdCache.clear();
+		m_storage->setStatisticsCounters(m_statistics.get());
+		m_storage->setTraceRecorder(m_trace.get());
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -127,13 +213,17 @@ bool SourcetrailDBWriter::open(const std::string& databaseFilePath)
 
 bool SourcetrailDBWriter::close()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::CLOSE);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "close");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::CLOSE);
+
 	try
 	{
 		closeDatabase();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -142,6 +232,9 @@ bool SourcetrailDBWriter::close()
 
 bool SourcetrailDBWriter::clear()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::CLEAR);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::CLEAR);
+
 	try
 	{
 		clearDatabaseTables();
@@ -149,7 +242,7 @@ bool SourcetrailDBWriter::clear()
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -160,7 +253,7 @@ bool SourcetrailDBWriter::isEmpty() const
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to check if database is empty, because no database is currently open.";
+		setLastError("Unable to check if database is empty, because no database is currently open.");
 		return true;
 	}
 
@@ -170,7 +263,7 @@ bool SourcetrailDBWriter::isEmpty() const
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return true;
 	}
 }
@@ -179,7 +272,7 @@ bool SourcetrailDBWriter::isCompatible() const
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to check if database is compatible, because no database is currently open.";
+		setLastError("Unable to check if database is compatible, because no database is currently open.");
 		return false;
 	}
 
@@ -189,7 +282,7 @@ bool SourcetrailDBWriter::isCompatible() const
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 }
@@ -198,7 +291,7 @@ int SourcetrailDBWriter::getLoadedDatabaseVersion() const
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to fetch database version, because no database is currently open.";
+		setLastError("Unable to fetch database version, because no database is currently open.");
 		return false;
 	}
 
@@ -208,16 +301,19 @@ int SourcetrailDBWriter::getLoadedDatabaseVersion() const
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return 0;
 	}
 }
 
 bool SourcetrailDBWriter::beginTransaction()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::BEGIN_TRANSACTION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::BEGIN_TRANSACTION);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to begin transaction, because no database is currently open.";
+		setLastError("Unable to begin transaction, because no database is currently open.");
 		return false;
 	}
 
@@ -227,7 +323,7 @@ bool SourcetrailDBWriter::beginTransaction()
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -236,19 +332,23 @@ bool SourcetrailDBWriter::beginTransaction()
 
 bool SourcetrailDBWriter::commitTransaction()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::COMMIT_TRANSACTION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::COMMIT_TRANSACTION);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to commit transaction, because no database is currently open.";
+		setLastError("Unable to commit transaction, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
 		m_storage->commitTransaction();
+		checkMemoryLimit();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -257,19 +357,25 @@ bool SourcetrailDBWriter::commitTransaction()
 
 bool SourcetrailDBWriter::rollbackTransaction()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::ROLLBACK_TRANSACTION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::ROLLBACK_TRANSACTION);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to rollback transaction, because no database is currently open.";
+		setLastError("Unable to rollback transaction, because no database is currently open.");
 		return false;
 	}
 
+	// the rolled back nodes may be cached
+	m_nodeIdCache.clear();
+
 	try
 	{
 		m_storage->rollbackTransaction();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
@@ -278,9 +384,12 @@ bool SourcetrailDBWriter::rollbackTransaction()
 
 bool SourcetrailDBWriter::optimizeDatabaseMemory()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::OPTIMIZE_DATABASE_MEMORY);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::OPTIMIZE_DATABASE_MEMORY);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to optimize database memory, because no database is currently open.";
+		setLastError("Unable to optimize database memory, because no database is currently open.");
 		return false;
 	}
 
@@ -290,393 +399,1050 @@ bool SourcetrailDBWriter::optimizeDatabaseMemory()
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
 	return true;
 }
 
-int SourcetrailDBWriter::recordSymbol(const NameHierarchy& nameHierarchy)
+bool SourcetrailDBWriter::optimizeDatabaseLocality()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::OPTIMIZE_DATABASE_LOCALITY);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::OPTIMIZE_DATABASE_LOCALITY);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol, because no database is currently open.";
+		setLastError("Unable to optimize database locality, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		return addNodeHierarchy(nameHierarchy);
+		m_storage->optimizeDatabaseLocality();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return 0;
+		setLastError(e.getMessage());
+		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind)
+bool SourcetrailDBWriter::analyzeDatabase()
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::ANALYZE_DATABASE);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::ANALYZE_DATABASE);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol kind, because no database is currently open.";
+		setLastError("Unable to analyze database, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		m_storage->addSymbol(StorageSymbol(symbolId, definitionKindToInt(definitionKind)));
+		m_storage->analyze();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
 	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolKind(int symbolId, SymbolKind symbolKind)
+WriterStatistics SourcetrailDBWriter::getStatistics() const
 {
-	if (!m_storage)
-	{
-		m_lastError = "Unable to record symbol kind, because no database is currently open.";
-		return false;
-	}
+	return m_statistics->getStatistics();
+}
+
+void SourcetrailDBWriter::resetStatistics()
+{
+	m_statistics->reset();
+}
+
+bool SourcetrailDBWriter::startTracing(const std::string& traceFilePath)
+{
+	stopTracing();
 
 	try
 	{
-		m_storage->setNodeType(symbolId, nodeKindToInt(symbolKindToNodeKind(symbolKind)));
+		m_trace.reset(new TraceRecorder(traceFilePath));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 
+	if (m_storage)
+	{
+		m_storage->setTraceRecorder(m_trace.get());
+	}
 	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolLocation(int symbolId, const SourceRange& location)
+void SourcetrailDBWriter::stopTracing()
 {
-	if (!m_storage)
+	if (m_storage)
 	{
-		m_lastError = "Unable to record symbol location, because no database is currently open.";
-		return false;
+		m_storage->setTraceRecorder(nullptr);
 	}
+	m_trace.reset();
+}
+
+bool SourcetrailDBWriter::startJournal(const std::string& journalFilePath, bool anonymize)
+{
+	stopJournal();
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::TOKEN);
-		return true;
+		m_journal.reset(new OperationJournal(journalFilePath, anonymize));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
+
+	// a replay needs to know the state the journal starts from
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_HASH_KEYS_ENABLED).addInt(m_hashKeysEnabled);
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_ATOMIC_BUILD_ENABLED).addInt(m_atomicBuildEnabled);
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_RECREATE_ON_CLEAR_ENABLED)
+		.addInt(m_recreateOnClearEnabled);
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_ANALYZE_ON_CLOSE_ENABLED).addInt(m_analyzeOnCloseEnabled);
+	if (m_storage && m_storage->isInMemory())
+	{
+		OperationJournal::Entry entry(m_journal.get(), JournalOperation::OPEN_IN_MEMORY);
+		entry.addName(m_databaseFilePath);
+		entry.addString(std::to_string(m_memoryLimit));
+		entry.addInt(m_vacuumOnClose);
+	}
+	else if (m_storage)
+	{
+		OperationJournal::Entry(
+			m_journal.get(), m_storage->isIngestLog() ? JournalOperation::OPEN_INGEST_LOG : JournalOperation::OPEN)
+			.addName(m_databaseFilePath);
+	}
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_NAME_INDEX_ENABLED).addInt(m_nameIndexEnabled);
+	OperationJournal::Entry(m_journal.get(), JournalOperation::SET_LOCATION_INDEX_ENABLED).addInt(m_locationIndexEnabled);
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolScopeLocation(int symbolId, const SourceRange& location)
+void SourcetrailDBWriter::stopJournal()
+{
+	m_journal.reset();
+}
+
+void SourcetrailDBWriter::setNameIndexEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_NAME_INDEX_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_nameIndexEnabled = enabled;
+}
+
+void SourcetrailDBWriter::setHashKeysEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_HASH_KEYS_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_hashKeysEnabled = enabled;
+}
+
+void SourcetrailDBWriter::setAtomicBuildEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_ATOMIC_BUILD_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_atomicBuildEnabled = enabled;
+}
+
+void SourcetrailDBWriter::setRecreateOnClearEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_RECREATE_ON_CLEAR_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_recreateOnClearEnabled = enabled;
+}
+
+void SourcetrailDBWriter::setAnalyzeOnCloseEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_ANALYZE_ON_CLOSE_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_analyzeOnCloseEnabled = enabled;
+}
+
+bool SourcetrailDBWriter::updateNameIndex()
 {
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::UPDATE_NAME_INDEX);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol scope location, because no database is currently open.";
+		setLastError("Unable to update name index, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::SCOPE);
-		return true;
+		m_storage->updateNameIndex();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolSignatureLocation(int symbolId, const SourceRange& location)
+void SourcetrailDBWriter::setLocationIndexEnabled(bool enabled)
+{
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::SET_LOCATION_INDEX_ENABLED);
+	journalEntry.addInt(enabled);
+
+	m_locationIndexEnabled = enabled;
+}
+
+bool SourcetrailDBWriter::updateLocationIndex()
 {
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::UPDATE_LOCATION_INDEX);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol signature location, because no database is currently open.";
+		setLastError("Unable to update location index, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::SIGNATURE);
-		return true;
+		m_storage->updateLocationIndex();
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
+
+	return true;
 }
 
-int SourcetrailDBWriter::recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+int SourcetrailDBWriter::recordSymbol(const NameHierarchy& nameHierarchy)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL);
+	journalEntry.addNameHierarchy(nameHierarchy);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record reference, because no database is currently open.";
-		return 0;
+		setLastError("Unable to record symbol, because no database is currently open.");
+		return false;
 	}
 
 	try
 	{
-		return addEdge(contextSymbolId, referencedSymbolId, referenceKindToEdgeKind(referenceKind));
+		int symbolId = 0;
+		if (!checkStatus(addNodeHierarchy(nameHierarchy, symbolId)))
+		{
+			return 0;
+		}
+		return journalEntry.setResultId(symbolId);
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return 0;
 	}
 }
 
-bool SourcetrailDBWriter::recordReferenceLocation(int referenceId, const SourceRange& location)
+NameHierarchyBuilder SourcetrailDBWriter::createNameHierarchyBuilder(const std::string& nameDelimiter)
+{
+	return NameHierarchyBuilder(m_namePool, nameDelimiter);
+}
+
+int SourcetrailDBWriter::recordSymbol(const NameHierarchyBuilder& nameHierarchy)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL);
+	if (m_journal)
+	{
+		journalEntry.addNameHierarchy(nameHierarchy.toNameHierarchy());
+	}
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol reference location, because no database is currently open.";
+		setLastError("Unable to record symbol, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(referenceId, location, LocationKind::TOKEN);
-		return true;
+		int symbolId = 0;
+		if (!checkStatus(addNodeHierarchy(nameHierarchy, symbolId)))
+		{
+			return 0;
+		}
+		return journalEntry.setResultId(symbolId);
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return false;
+		setLastError(e.getMessage());
+		return 0;
 	}
 }
 
-bool SourcetrailDBWriter::recordReferenceIsAmbiguous(int referenceId)
+bool SourcetrailDBWriter::recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_DEFINITION_KIND);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_DEFINITION_KIND);
+	journalEntry.addInt(symbolId);
+	journalEntry.addInt(definitionKindToInt(definitionKind));
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record ambiguity of reference, because no database is currently open.";
+		setLastError("Unable to record symbol kind, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		addElementComponent(referenceId, ElementComponentKind::IS_AMBIGUOUS, "");
-		return false;
+		if (!checkStatus(m_storage->tryAddSymbol(StorageSymbol(symbolId, definitionKindToInt(definitionKind)))))
+		{
+			return false;
+		}
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
+
+	return true;
 }
 
-int SourcetrailDBWriter::recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location)
+bool SourcetrailDBWriter::recordSymbolKind(int symbolId, SymbolKind symbolKind)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_KIND);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_KIND);
+	journalEntry.addInt(symbolId);
+	journalEntry.addInt(static_cast<int>(symbolKind));
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol reference, because no database is currently open.";
-		return 0;
+		setLastError("Unable to record symbol kind, because no database is currently open.");
+		return false;
 	}
 
 	try
 	{
-		NameHierarchy unsolvedSymbolName;
-		NameElement unsolvedSymbolNameElement;
-		unsolvedSymbolNameElement.name = "unsolved symbol";
-		unsolvedSymbolName.nameElements.push_back(unsolvedSymbolNameElement);
-		int unsolvedSymbolId = addNodeHierarchy(unsolvedSymbolName);
-		int referenceId = addEdge(contextSymbolId, unsolvedSymbolId, referenceKindToEdgeKind(referenceKind));
-		addSourceLocation(referenceId, location, LocationKind::UNSOLVED);
-		return referenceId;
+		if (!checkStatus(m_storage->trySetNodeType(symbolId, nodeKindToInt(symbolKindToNodeKind(symbolKind)))))
+		{
+			return false;
+		}
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return 0;
+		setLastError(e.getMessage());
+		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordQualifierLocation(int referencedSymbolId, const SourceRange& location)
+bool SourcetrailDBWriter::recordSymbolLocation(int symbolId, const SourceRange& location)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_LOCATION);
+	journalEntry.addInt(symbolId);
+	journalEntry.addSourceRange(location);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol qualifier location, because no database is currently open.";
+		setLastError("Unable to record symbol location, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(referencedSymbolId, location, LocationKind::QUALIFIER);
-		return true;
+		return checkStatus(addSourceLocation(symbolId, location, LocationKind::TOKEN));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 }
 
-int SourcetrailDBWriter::recordFile(const std::string& filePath)
+bool SourcetrailDBWriter::recordSymbolLocations(const int* rows, size_t rowCount)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_LOCATIONS);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_LOCATIONS);
+	journalEntry.addRows(rows, rowCount * 6);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record file, because no database is currently open.";
+		setLastError("Unable to record symbol locations, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		return addFile(filePath);
+		size_t failedRow = 0;
+		const StorageStatus status = addSourceLocations(rows, rowCount, LocationKind::TOKEN, failedRow);
+		return checkStatus(status, "location", failedRow);
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return 0;
+		setLastError(e.getMessage());
+		return false;
 	}
 }
 
-bool SourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& languageIdentifier)
+bool SourcetrailDBWriter::recordSymbolScopeLocation(int symbolId, const SourceRange& location)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_SCOPE_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_SCOPE_LOCATION);
+	journalEntry.addInt(symbolId);
+	journalEntry.addSourceRange(location);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record file language, because no database is currently open.";
+		setLastError("Unable to record symbol scope location, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		m_storage->setFileLanguage(fileId, languageIdentifier);
+		return checkStatus(addSourceLocation(symbolId, location, LocationKind::SCOPE));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
-
-	return true;
 }
 
-int SourcetrailDBWriter::recordLocalSymbol(const std::string& name)
+bool SourcetrailDBWriter::recordSymbolSignatureLocation(int symbolId, const SourceRange& location)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_SYMBOL_SIGNATURE_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_SYMBOL_SIGNATURE_LOCATION);
+	journalEntry.addInt(symbolId);
+	journalEntry.addSourceRange(location);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record local symbol, because no database is currently open.";
+		setLastError("Unable to record symbol signature location, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		return m_storage->addLocalSymbol(StorageLocalSymbolData(name));
+		return checkStatus(addSourceLocation(symbolId, location, LocationKind::SIGNATURE));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return 0;
+		setLastError(e.getMessage());
+		return false;
 	}
 }
 
-bool SourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const SourceRange& location)
+int SourcetrailDBWriter::recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCE);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCE);
+	journalEntry.addInt(contextSymbolId);
+	journalEntry.addInt(referencedSymbolId);
+	journalEntry.addInt(static_cast<int>(referenceKind));
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record local symbol location, because no database is currently open.";
-		return false;
+		setLastError("Unable to record reference, because no database is currently open.");
+		return 0;
 	}
 
 	try
 	{
-		addSourceLocation(localSymbolId, location, LocationKind::LOCAL_SYMBOL);
-		return true;
+		int referenceId = 0;
+		if (!checkStatus(addEdge(contextSymbolId, referencedSymbolId, referenceKindToEdgeKind(referenceKind), referenceId)))
+		{
+			return 0;
+		}
+		return journalEntry.setResultId(referenceId);
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
-		return false;
+		setLastError(e.getMessage());
+		return 0;
 	}
 }
 
-bool SourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange)
+bool SourcetrailDBWriter::recordReferences(const int* rows, size_t rowCount, int* referenceIds)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCES);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCES);
+	journalEntry.addRows(rows, rowCount * 3);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record atomic source range, because no database is currently open.";
+		setLastError("Unable to record references, because no database is currently open.");
 		return false;
 	}
 
-	try
+	for (size_t i = 0; i < rowCount; i++)
 	{
-		const int sourceLocationId = m_storage->addSourceLocation(StorageSourceLocationData(
-			sourceRange.fileId,
-			sourceRange.startLine,
-			sourceRange.startColumn,
-			sourceRange.endLine,
-			sourceRange.endColumn,
-			locationKindToInt(LocationKind::ATOMIC_RANGE)));
+		const int* row = rows + i * 3;
+		if (row[2] < static_cast<int>(ReferenceKind::TYPE_USAGE) ||
+			row[2] > static_cast<int>(ReferenceKind::ANNOTATION_USAGE))
+		{
+			setLastError("Failed to record reference in row " + std::to_string(i) + ": Invalid reference kind " +
+				std::to_string(row[2]) + ".");
+			return false;
+		}
 
-		return true;
-	}
-	catch (const SourcetrailException e)
-	{
-		m_lastError = e.getMessage();
-		return false;
+		try
+		{
+			const StorageStatus status = addEdge(
+				row[0], row[1], referenceKindToEdgeKind(static_cast<ReferenceKind>(row[2])), referenceIds[i]);
+			if (!checkStatus(status, "reference", i))
+			{
+				return false;
+			}
+		}
+		catch (const SourcetrailException e)
+		{
+			setLastError("Failed to record reference in row " + std::to_string(i) + ": " + e.getMessage());
+			return false;
+		}
 	}
+	journalEntry.setResultIds(referenceIds, rowCount);
+	return true;
 }
 
-bool SourcetrailDBWriter::recordError(const std::string& message, bool fatal, const SourceRange& location)
+bool SourcetrailDBWriter::recordReferenceLocation(int referenceId, const SourceRange& location)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCE_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCE_LOCATION);
+	journalEntry.addInt(referenceId);
+	journalEntry.addSourceRange(location);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record error, because no database is currently open.";
+		setLastError("Unable to record symbol reference location, because no database is currently open.");
 		return false;
 	}
 
 	try
 	{
-		const int errorId = m_storage->addError(StorageErrorData(message, "", fatal, true));
-		addSourceLocation(errorId, location, LocationKind::INDEXER_ERROR);
-		return true;
+		return checkStatus(addSourceLocation(referenceId, location, LocationKind::TOKEN));
 	}
 	catch (const SourcetrailException e)
 	{
-		m_lastError = e.getMessage();
+		setLastError(e.getMessage());
 		return false;
 	}
 }
 
-// --- Private Interface ---
-
-void SourcetrailDBWriter::openDatabase()
+bool SourcetrailDBWriter::recordReferenceLocations(const int* rows, size_t rowCount)
 {
-	if (m_storage)
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCE_LOCATIONS);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCE_LOCATIONS);
+	journalEntry.addRows(rows, rowCount * 6);
+
+	if (!m_storage)
 	{
-		closeDatabase();
+		setLastError("Unable to record symbol reference locations, because no database is currently open.");
+		return false;
 	}
 
 	try
 	{
-		m_storage = DatabaseStorage::openDatabase(m_databaseFilePath);
+		size_t failedRow = 0;
+		const StorageStatus status = addSourceLocations(rows, rowCount, LocationKind::TOKEN, failedRow);
+		return checkStatus(status, "location", failedRow);
 	}
-	catch (CppSQLite3Exception e)
+	catch (const SourcetrailException e)
 	{
-		m_storage.reset();
-		throw e;
+		setLastError(e.getMessage());
+		return false;
 	}
 }
 
-void SourcetrailDBWriter::closeDatabase()
+bool SourcetrailDBWriter::recordReferenceIsAmbiguous(int referenceId)
 {
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCE_IS_AMBIGUOUS);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCE_IS_AMBIGUOUS);
+	journalEntry.addInt(referenceId);
+
 	if (!m_storage)
 	{
-		throw SourcetrailException("Unable to close database, because no database is currently open.");
+		setLastError("Unable to record ambiguity of reference, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		addElementComponent(referenceId, ElementComponentKind::IS_AMBIGUOUS, "");
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+}
+
+int SourcetrailDBWriter::recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_REFERENCE_TO_UNSOLVED_SYMBOL);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_REFERENCE_TO_UNSOLVED_SYMBOL);
+	journalEntry.addInt(contextSymbolId);
+	journalEntry.addInt(static_cast<int>(referenceKind));
+	journalEntry.addSourceRange(location);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record symbol reference, because no database is currently open.");
+		return 0;
+	}
+
+	try
+	{
+		NameHierarchy unsolvedSymbolName;
+		NameElement unsolvedSymbolNameElement;
+		unsolvedSymbolNameElement.name = "unsolved symbol";
+		unsolvedSymbolName.nameElements.push_back(unsolvedSymbolNameElement);
+		int unsolvedSymbolId = 0;
+		int referenceId = 0;
+		if (!checkStatus(addNodeHierarchy(unsolvedSymbolName, unsolvedSymbolId)) ||
+			!checkStatus(addEdge(contextSymbolId, unsolvedSymbolId, referenceKindToEdgeKind(referenceKind), referenceId)) ||
+			!checkStatus(addSourceLocation(referenceId, location, LocationKind::UNSOLVED)))
+		{
+			return 0;
+		}
+		return journalEntry.setResultId(referenceId);
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordQualifierLocation(int referencedSymbolId, const SourceRange& location)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_QUALIFIER_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_QUALIFIER_LOCATION);
+	journalEntry.addInt(referencedSymbolId);
+	journalEntry.addSourceRange(location);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record symbol qualifier location, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		return checkStatus(addSourceLocation(referencedSymbolId, location, LocationKind::QUALIFIER));
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+}
+
+int SourcetrailDBWriter::recordFile(const std::string& filePath)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_FILE);
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "recordFile");
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_FILE);
+	journalEntry.addName(filePath);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record file, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		return journalEntry.setResultId(addFile(filePath));
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& languageIdentifier)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_FILE_LANGUAGE);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_FILE_LANGUAGE);
+	journalEntry.addInt(fileId);
+	journalEntry.addString(languageIdentifier);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record file language, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		m_storage->setFileLanguage(fileId, languageIdentifier);
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+
+	return true;
+}
+
+bool SourcetrailDBWriter::recordFileCommitted(int fileId)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_FILE_COMMITTED);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_FILE_COMMITTED);
+	journalEntry.addInt(fileId);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record committed file, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		m_storage->addCommittedFile(fileId);
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<std::string> SourcetrailDBWriter::getCommittedFilePaths() const
+{
+	if (!m_storage)
+	{
+		setLastError("Unable to get committed files, because no database is currently open.");
+		return std::vector<std::string>();
+	}
+
+	try
+	{
+		return m_storage->getCommittedFilePaths();
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return std::vector<std::string>();
+	}
+}
+
+int SourcetrailDBWriter::recordLocalSymbol(const std::string& name)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_LOCAL_SYMBOL);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_LOCAL_SYMBOL);
+	journalEntry.addName(name);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record local symbol, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		int localSymbolId = 0;
+		if (!checkStatus(m_storage->tryAddLocalSymbol(StorageLocalSymbolData(name), localSymbolId)))
+		{
+			return 0;
+		}
+		return journalEntry.setResultId(localSymbolId);
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const SourceRange& location)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_LOCAL_SYMBOL_LOCATION);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_LOCAL_SYMBOL_LOCATION);
+	journalEntry.addInt(localSymbolId);
+	journalEntry.addSourceRange(location);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record local symbol location, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		return checkStatus(addSourceLocation(localSymbolId, location, LocationKind::LOCAL_SYMBOL));
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_ATOMIC_SOURCE_RANGE);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_ATOMIC_SOURCE_RANGE);
+	journalEntry.addSourceRange(sourceRange);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record atomic source range, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		int sourceLocationId = 0;
+		const StorageStatus status = m_storage->tryAddSourceLocation(
+			StorageSourceLocationData(
+				sourceRange.fileId,
+				sourceRange.startLine,
+				sourceRange.startColumn,
+				sourceRange.endLine,
+				sourceRange.endColumn,
+				locationKindToInt(LocationKind::ATOMIC_RANGE)),
+			sourceLocationId);
+		return checkStatus(status);
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::recordError(const std::string& message, bool fatal, const SourceRange& location)
+{
+	SOURCETRAIL_STATISTICS_MEASURE_OPERATION(m_statistics, WriterOperation::RECORD_ERROR);
+	OperationJournal::Entry journalEntry(m_journal.get(), JournalOperation::RECORD_ERROR);
+	journalEntry.addName(message);
+	journalEntry.addInt(fatal);
+	journalEntry.addSourceRange(location);
+
+	if (!m_storage)
+	{
+		setLastError("Unable to record error, because no database is currently open.");
+		return false;
+	}
+
+	try
+	{
+		const int errorId = m_storage->addError(StorageErrorData(message, "", fatal, true));
+		return checkStatus(addSourceLocation(errorId, location, LocationKind::INDEXER_ERROR));
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+}
+
+// --- Private Interface ---
+
+bool SourcetrailDBWriter::openProject(const std::string& databaseFilePath, bool inMemory, size_t memoryLimit, bool vacuum)
+{
+	// a previously opened database needs to be closed with its own settings
+	if (m_storage)
+	{
+		try
+		{
+			closeDatabase();
+		}
+		catch (const SourcetrailException e)
+		{
+			setLastError(e.getMessage());
+			return false;
+		}
+	}
+
+	m_inMemory = inMemory;
+	m_memoryLimit = memoryLimit;
+	m_vacuumOnClose = vacuum;
+	m_databaseFilePath = databaseFilePath;
+	m_temporaryFilePath = m_atomicBuildEnabled ? databaseFilePath + ".tmp" : std::string();
+
+	m_projectFilePath = databaseFilePath;	 // FIXME: only find dot after last slash/backslash! otherwise it may be part of the file path
+	const size_t pos = m_projectFilePath.rfind('.');
+	if (pos != std::string::npos)
+	{
+		m_projectFilePath = m_projectFilePath.substr(0, pos);
+	}
+	m_projectFilePath += ".srctrlprj";
+
+	{
+		bool projectFileExists = false;
+		{
+			std::ifstream f(m_projectFilePath.c_str());
+			projectFileExists = f.good();
+			f.close();
+		}
+		if (!projectFileExists)
+		{
+			try
+			{
+				createOrResetProjectFile();
+			}
+			catch (const SourcetrailException e)
+			{
+				setLastError(e.getMessage());
+				return false;
+			}
+		}
+	}
+
+	try
+	{
+		openDatabase();
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+
+	try
+	{
+		setupDatabaseTables();
+		updateProjectSettingsText();
+	}
+	catch (const SourcetrailException e)
+	{
+		setLastError(e.getMessage());
+		return false;
+	}
+
+	return true;
+}
+
+void SourcetrailDBWriter::openDatabase()
+{
+	if (m_storage)
+	{
+		closeDatabase();
+	}
+
+	try
+	{
+		if (m_inMemory)
+		{
+			m_storage = DatabaseStorage::openInMemoryDatabase(m_databaseFilePath);
+		}
+		else if (!m_temporaryFilePath.empty())
+		{
+			m_storage = DatabaseStorage::openTemporaryDatabase(m_databaseFilePath, m_temporaryFilePath);
+		}
+		else
+		{
+			m_storage = DatabaseStorage::openDatabase(m_databaseFilePath);
+		}
+		m_nodeIdCache.clear();
+		m_storage->setStatisticsCounters(m_statistics.get());
+		m_storage->setTraceRecorder(m_trace.get());
+		m_storage->setHashKeysEnabled(m_hashKeysEnabled);
+	}
+	catch (CppSQLite3Exception e)
+	{
+		m_storage.reset();
+		throw e;
+	}
+}
+
+void SourcetrailDBWriter::closeDatabase()
+{
+	if (!m_storage)
+	{
+		throw SourcetrailException("Unable to close database, because no database is currently open.");
+	}
+
+	m_nodeIdCache.clear();
+
+	if (!m_storage->isIngestLog())
+	{
+		try
+		{
+			if (m_nameIndexEnabled)
+			{
+				m_storage->updateNameIndex();
+			}
+			if (m_locationIndexEnabled)
+			{
+				m_storage->updateLocationIndex();
+			}
+			if (m_analyzeOnCloseEnabled || !m_temporaryFilePath.empty())
+			{
+				m_storage->analyze();
+			}
+			if (m_storage->isInMemory())
+			{
+				m_storage->backupToFile(getStorageFilePath(), m_vacuumOnClose);
+			}
+		}
+		catch (...)
+		{
+			m_storage.reset();
+			throw;
+		}
 	}
 	m_storage.reset();
+
+	if (!m_temporaryFilePath.empty())
+	{
+		const std::string temporaryFilePath = m_temporaryFilePath;
+		m_temporaryFilePath.clear();
+		if (!utility::replaceFile(temporaryFilePath, m_databaseFilePath))
+		{
+			throw SourcetrailException(
+				"Unable to replace database file \"" + m_databaseFilePath + "\" with \"" + temporaryFilePath + "\".");
+		}
+	}
+}
+
+void SourcetrailDBWriter::checkMemoryLimit()
+{
+	if (!m_storage || !m_storage->isInMemory() || m_memoryLimit == 0 || m_storage->getDatabaseSize() <= m_memoryLimit)
+	{
+		return;
+	}
+
+	const TraceRecorder::Scope traceScope(m_trace.get(), "writer", "move database to disk");
+
+	// the ids stay the same, so the node id cache remains valid
+	m_storage->backupToFile(getStorageFilePath(), false);
+	m_storage = DatabaseStorage::openDatabase(getStorageFilePath());
+	m_storage->setStatisticsCounters(m_statistics.get());
+	m_storage->setTraceRecorder(m_trace.get());
+	m_storage->setHashKeysEnabled(m_hashKeysEnabled);
+	m_storage->setJournalingEnabled(m_temporaryFilePath.empty());
+	m_storage->setupDatabase();
+}
+
+const std::string& SourcetrailDBWriter::getStorageFilePath() const
+{
+	return m_temporaryFilePath.empty() ? m_databaseFilePath : m_temporaryFilePath;
 }
 
 void SourcetrailDBWriter::setupDatabaseTables()
@@ -694,7 +1460,16 @@ void SourcetrailDBWriter::clearDatabaseTables()
 	{
 		throw SourcetrailException("Unable to setup database tables, because no database is currently open.");
 	}
-	m_storage->clearDatabase();
+	m_storage->setHashKeysEnabled(m_hashKeysEnabled);
+	m_nodeIdCache.clear();
+	if (m_recreateOnClearEnabled)
+	{
+		m_storage->recreateDatabase();
+	}
+	else
+	{
+		m_storage->clearDatabase();
+	}
 }
 
 void SourcetrailDBWriter::createOrResetProjectFile()
@@ -718,6 +1493,11 @@ void SourcetrailDBWriter::createOrResetProjectFile()
 
 void SourcetrailDBWriter::updateProjectSettingsText()
 {
+	if (m_storage->isIngestLog())
+	{
+		return;
+	}
+
 	try
 	{
 		std::ifstream f(m_projectFilePath.c_str());
@@ -743,7 +1523,7 @@ void SourcetrailDBWriter::updateProjectSettingsText()
 	}
 }
 
-int SourcetrailDBWriter::addNodeHierarchy(const NameHierarchy& nameHierarchy)
+StorageStatus SourcetrailDBWriter::addNodeHierarchy(const NameHierarchy& nameHierarchy, int& nodeId)
 {
 	if (nameHierarchy.nameElements.size() == 0)
 	{
@@ -752,24 +1532,93 @@ int SourcetrailDBWriter::addNodeHierarchy(const NameHierarchy& nameHierarchy)
 
 	int parentNodeId = 0;
 
-	NameHierarchy currentNameHierarchy;
-	currentNameHierarchy.nameDelimiter = nameHierarchy.nameDelimiter;
-
 	for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
 	{
-		currentNameHierarchy.nameElements.push_back(nameHierarchy.nameElements[i]);
+		serializeNameHierarchyToDatabaseString(nameHierarchy, i + 1, m_serializedNameBuffer);
+
+		int currentNodeId = 0;
+		StorageStatus status = m_storage->tryAddNode(
+			nodeKindToInt(NodeKind::UNKNOWN), m_serializedNameBuffer, currentNodeId);
+		if (!status.isOk())
+		{
+			return status;
+		}
+
+		if (parentNodeId != 0)
+		{
+			int edgeId = 0;
+			status = addEdge(parentNodeId, currentNodeId, EdgeKind::MEMBER, edgeId);
+			if (!status.isOk())
+			{
+				return status;
+			}
+		}
+
+		parentNodeId = currentNodeId;
+	}
+
+	nodeId = parentNodeId;
+	return StorageStatus();
+}
+
+StorageStatus SourcetrailDBWriter::addNodeHierarchy(const NameHierarchyBuilder& nameHierarchy, int& nodeId)
+{
+	if (nameHierarchy.m_elements.empty())
+	{
+		throw SourcetrailException("Unable to add nodes for an empty name hierarchy.");
+	}
+
+	// the pooled string ids only identify names of builders sharing the pool of this writer
+	const bool useCache = nameHierarchy.m_pool == m_namePool;
+
+	int parentNodeId = 0;
+	m_serializedNameBuffer.clear();
+
+	for (size_t i = 0; i < nameHierarchy.m_elements.size(); i++)
+	{
+		// the buffer keeps its capacity, so appending only allocates for names longer than all before
+		nameHierarchy.appendToDatabaseString(i + 1, m_serializedNameBuffer);
+
+		const NameHierarchyBuilder::Element& element = nameHierarchy.m_elements[i];
+		const NodeIdCacheKey key = {
+			parentNodeId, nameHierarchy.m_nameDelimiterId, element.prefixId, element.nameId, element.postfixId};
+		if (useCache)
+		{
+			auto it = m_nodeIdCache.find(key);
+			if (it != m_nodeIdCache.end())
+			{
+				parentNodeId = it->second;
+				continue;
+			}
+		}
 
-		int nodeId = m_storage->addNode(
-			StorageNodeData(nodeKindToInt(NodeKind::UNKNOWN), serializeNameHierarchyToDatabaseString(currentNameHierarchy)));
+		int currentNodeId = 0;
+		StorageStatus status = m_storage->tryAddNode(
+			nodeKindToInt(NodeKind::UNKNOWN), m_serializedNameBuffer, currentNodeId);
+		if (!status.isOk())
+		{
+			return status;
+		}
 
 		if (parentNodeId != 0)
 		{
-			addEdge(parentNodeId, nodeId, EdgeKind::MEMBER);
+			int edgeId = 0;
+			status = addEdge(parentNodeId, currentNodeId, EdgeKind::MEMBER, edgeId);
+			if (!status.isOk())
+			{
+				return status;
+			}
 		}
 
-		parentNodeId = nodeId;
+		if (useCache)
+		{
+			m_nodeIdCache.emplace(key, currentNodeId);
+		}
+		parentNodeId = currentNodeId;
 	}
-	return parentNodeId;
+
+	nodeId = parentNodeId;
+	return StorageStatus();
 }
 
 int SourcetrailDBWriter::addFile(const std::string& filePath)
@@ -780,7 +1629,12 @@ int SourcetrailDBWriter::addFile(const std::string& filePath)
 	nameHierarchy.nameDelimiter = "/";
 	nameHierarchy.nameElements.push_back(nameElement);
 
-	const int nodeId = addNodeHierarchy(nameHierarchy);
+	int nodeId = 0;
+	const StorageStatus status = addNodeHierarchy(nameHierarchy, nodeId);
+	if (!status.isOk())
+	{
+		throw SourcetrailException(DatabaseStorage::getErrorMessage(status));
+	}
 	m_storage->setNodeType(nodeId, nodeKindToInt(NodeKind::FILE));
 
 	m_storage->addFile(StorageFile(nodeId, filePath, "", utility::getDateTimeString(time(0)), true, true));
@@ -788,7 +1642,7 @@ int SourcetrailDBWriter::addFile(const std::string& filePath)
 	return nodeId;
 }
 
-int SourcetrailDBWriter::addEdge(int sourceId, int targetId, EdgeKind edgeKind)
+StorageStatus SourcetrailDBWriter::addEdge(int sourceId, int targetId, EdgeKind edgeKind, int& edgeId)
 {
 	if (!m_storage)
 	{
@@ -803,15 +1657,74 @@ int SourcetrailDBWriter::addEdge(int sourceId, int targetId, EdgeKind edgeKind)
 		throw SourcetrailException("Unable to add edge, because target id is invalid.");
 	}
 
-	return m_storage->addEdge(StorageEdgeData(sourceId, targetId, edgeKindToInt(edgeKind)));
+	return m_storage->tryAddEdge(StorageEdgeData(sourceId, targetId, edgeKindToInt(edgeKind)), edgeId);
+}
+
+StorageStatus SourcetrailDBWriter::addSourceLocation(int elementId, const SourceRange& location, LocationKind kind)
+{
+	int sourceLocationId = 0;
+	const StorageStatus status = m_storage->tryAddSourceLocation(
+		StorageSourceLocationData(
+			location.fileId, location.startLine, location.startColumn, location.endLine, location.endColumn, locationKindToInt(kind)),
+		sourceLocationId);
+	if (!status.isOk())
+	{
+		return status;
+	}
+
+	return m_storage->tryAddOccurrence(StorageOccurrence(elementId, sourceLocationId));
+}
+
+StorageStatus SourcetrailDBWriter::addSourceLocations(const int* rows, size_t rowCount, LocationKind kind, size_t& failedRow)
+{
+	for (size_t i = 0; i < rowCount; i++)
+	{
+		const int* row = rows + i * 6;
+		try
+		{
+			const StorageStatus status = addSourceLocation(row[0], {row[1], row[2], row[3], row[4], row[5]}, kind);
+			if (!status.isOk())
+			{
+				failedRow = i;
+				return status;
+			}
+		}
+		catch (const SourcetrailException e)
+		{
+			throw SourcetrailException("Failed to record location in row " + std::to_string(i) + ": " + e.getMessage());
+		}
+	}
+	return StorageStatus();
+}
+
+bool SourcetrailDBWriter::NodeIdCacheKey::operator==(const NodeIdCacheKey& other) const
+{
+	return parentNodeId == other.parentNodeId && nameDelimiterId == other.nameDelimiterId &&
+		prefixId == other.prefixId && nameId == other.nameId && postfixId == other.postfixId;
+}
+
+size_t SourcetrailDBWriter::NodeIdCacheKeyHash::operator()(const NodeIdCacheKey& key) const
+{
+	uint64_t hash = static_cast<uint32_t>(key.parentNodeId);
+	hash = hash * 0x9E3779B97F4A7C15ull + key.nameDelimiterId;
+	hash = hash * 0x9E3779B97F4A7C15ull + key.prefixId;
+	hash = hash * 0x9E3779B97F4A7C15ull + key.nameId;
+	hash = hash * 0x9E3779B97F4A7C15ull + key.postfixId;
+	return static_cast<size_t>(hash ^ (hash >> 32));
 }
 
-void SourcetrailDBWriter::addSourceLocation(int elementId, const SourceRange& location, LocationKind kind)
+bool SourcetrailDBWriter::checkStatus(const StorageStatus& status, const char* rowKind, size_t row) const
 {
-	const int sourceLocationId = m_storage->addSourceLocation(StorageSourceLocationData(
-		location.fileId, location.startLine, location.startColumn, location.endLine, location.endColumn, locationKindToInt(kind)));
+	if (status.isOk())
+	{
+		return true;
+	}
 
-	m_storage->addOccurrence(StorageOccurrence(elementId, sourceLocationId));
+	// the message is only built if getLastError() gets called
+	m_lastErrorStatus = status;
+	m_lastErrorRowKind = rowKind;
+	m_lastErrorRow = row;
+	return false;
 }
 
 void SourcetrailDBWriter::addElementComponent(int elementId, ElementComponentKind kind, const std::string& data)
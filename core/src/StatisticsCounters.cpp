@@ -0,0 +1,190 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StatisticsCounters.h"
+
+namespace
+{
+const char* const OPERATION_NAMES[] = {
+	"open",
+	"close",
+	"clear",
+	"beginTransaction",
+	"commitTransaction",
+	"rollbackTransaction",
+	"optimizeDatabaseMemory",
+	"recordSymbol",
+	"recordSymbolDefinitionKind",
+	"recordSymbolKind",
+	"recordSymbolLocation",
+	"recordSymbolLocations",
+	"recordSymbolScopeLocation",
+	"recordSymbolSignatureLocation",
+	"recordReference",
+	"recordReferences",
+	"recordReferenceLocation",
+	"recordReferenceLocations",
+	"recordReferenceIsAmbiguous",
+	"recordReferenceToUnsolvedSymhol",
+	"recordQualifierLocation",
+	"recordFile",
+	"recordFileLanguage",
+	"recordLocalSymbol",
+	"recordLocalSymbolLocation",
+	"recordAtomicSourceRange",
+	"recordError",
+	"openIngestLog",
+	"materializeIngestLog",
+	"resumeIngestLog",
+	"recordFileCommitted",
+	"openInMemory",
+	"analyzeDatabase",
+	"optimizeDatabaseLocality"};
+
+const char* const TABLE_NAMES[] = {
+	"node",
+	"symbol",
+	"edge",
+	"file",
+	"local_symbol",
+	"source_location",
+	"occurrence",
+	"element_component",
+	"error"};
+
+static_assert(
+	sizeof(OPERATION_NAMES) / sizeof(OPERATION_NAMES[0]) == static_cast<size_t>(sourcetrail::WriterOperation::COUNT),
+	"every writer operation needs a name");
+static_assert(
+	sizeof(TABLE_NAMES) / sizeof(TABLE_NAMES[0]) == static_cast<size_t>(sourcetrail::WriterTable::COUNT),
+	"every writer table needs a name");
+}	 // namespace
+
+namespace sourcetrail
+{
+StatisticsCounters::DurationCounter::DurationCounter(): m_count(0), m_totalNanoseconds(0), m_maxNanoseconds(0) {}
+
+void StatisticsCounters::DurationCounter::add(uint64_t nanoseconds)
+{
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	uint64_t maxNanoseconds = m_maxNanoseconds.load(std::memory_order_relaxed);
+	while (nanoseconds > maxNanoseconds &&
+		   !m_maxNanoseconds.compare_exchange_weak(maxNanoseconds, nanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+void StatisticsCounters::DurationCounter::reset()
+{
+	m_count.store(0, std::memory_order_relaxed);
+	m_totalNanoseconds.store(0, std::memory_order_relaxed);
+	m_maxNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+WriterStatistics::Duration StatisticsCounters::DurationCounter::get() const
+{
+	WriterStatistics::Duration duration;
+	duration.count = m_count.load(std::memory_order_relaxed);
+	duration.totalNanoseconds = m_totalNanoseconds.load(std::memory_order_relaxed);
+	duration.maxNanoseconds = m_maxNanoseconds.load(std::memory_order_relaxed);
+	return duration;
+}
+
+StatisticsCounters::ScopedTimer::ScopedTimer(DurationCounter* counter)
+	: m_counter(counter), m_start(counter ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+{
+}
+
+StatisticsCounters::ScopedTimer::~ScopedTimer()
+{
+	if (m_counter)
+	{
+		m_counter->add(static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()));
+	}
+}
+
+StatisticsCounters::StatisticsCounters(): m_fileContentByteCount(0)
+{
+	for (int i = 0; i < static_cast<int>(WriterTable::COUNT); i++)
+	{
+		m_insertedRows[i].store(0, std::memory_order_relaxed);
+		m_deduplicatedRows[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+StatisticsCounters::DurationCounter* StatisticsCounters::getOperationCounter(WriterOperation operation)
+{
+	return &m_operations[static_cast<int>(operation)];
+}
+
+StatisticsCounters::DurationCounter* StatisticsCounters::getCommitCounter()
+{
+	return &m_commits;
+}
+
+void StatisticsCounters::addRow(WriterTable table, bool inserted)
+{
+	std::atomic<uint64_t>* rows = inserted ? m_insertedRows : m_deduplicatedRows;
+	rows[static_cast<int>(table)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatisticsCounters::addFileContentBytes(uint64_t byteCount)
+{
+	m_fileContentByteCount.fetch_add(byteCount, std::memory_order_relaxed);
+}
+
+void StatisticsCounters::reset()
+{
+	for (DurationCounter& counter: m_operations)
+	{
+		counter.reset();
+	}
+	m_commits.reset();
+	for (int i = 0; i < static_cast<int>(WriterTable::COUNT); i++)
+	{
+		m_insertedRows[i].store(0, std::memory_order_relaxed);
+		m_deduplicatedRows[i].store(0, std::memory_order_relaxed);
+	}
+	m_fileContentByteCount.store(0, std::memory_order_relaxed);
+}
+
+WriterStatistics StatisticsCounters::getStatistics() const
+{
+	WriterStatistics statistics;
+#ifdef SOURCETRAIL_ENABLE_STATISTICS
+	statistics.enabled = true;
+#else
+	statistics.enabled = false;
+#endif
+
+	for (int i = 0; i < static_cast<int>(WriterOperation::COUNT); i++)
+	{
+		statistics.operations.push_back({OPERATION_NAMES[i], m_operations[i].get()});
+	}
+	for (int i = 0; i < static_cast<int>(WriterTable::COUNT); i++)
+	{
+		statistics.tables.push_back({TABLE_NAMES[i],
+									 m_insertedRows[i].load(std::memory_order_relaxed),
+									 m_deduplicatedRows[i].load(std::memory_order_relaxed)});
+	}
+	statistics.commits = m_commits.get();
+	statistics.fileContentByteCount = m_fileContentByteCount.load(std::memory_order_relaxed);
+	return statistics;
+}
+}	 // namespace sourcetrail
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TraceRecorder.h"
+
+#include <atomic>
+
+#include "json.hpp"
+
+#include "SourcetrailException.h"
+
+namespace
+{
+// number of spans a thread collects before handing them to the flush thread
+const size_t THREAD_BUFFER_CAPACITY = 4096;
+
+std::atomic<uint64_t> s_nextSerialNumber(1);
+}	 // namespace
+
+namespace sourcetrail
+{
+TraceRecorder::Scope::Scope(TraceRecorder* recorder, const char* category, const char* name)
+	: m_recorder(recorder)
+	, m_category(category)
+	, m_name(name)
+	, m_startNanoseconds(recorder ? recorder->now() : 0)
+{
+}
+
+TraceRecorder::Scope::~Scope()
+{
+	if (m_recorder)
+	{
+		m_recorder->addSpan(m_category, m_name, m_startNanoseconds, m_recorder->now());
+	}
+}
+
+TraceRecorder::TraceRecorder(const std::string& traceFilePath)
+	: m_serialNumber(s_nextSerialNumber.fetch_add(1))
+	, m_startTime(std::chrono::steady_clock::now())
+	, m_firstEventWritten(false)
+	, m_stopping(false)
+{
+	m_file.open(traceFilePath, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (m_file.fail())
+	{
+		throw SourcetrailException("Unable to create trace file \"" + traceFilePath + "\".");
+	}
+	m_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	m_flushThread = std::thread(&TraceRecorder::runFlushThread, this);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+		for (const auto& it: m_threadBuffers)
+		{
+			ThreadBuffer* threadBuffer = it.second.get();
+			std::vector<Event> events;
+			{
+				std::lock_guard<std::mutex> bufferLock(threadBuffer->mutex);
+				events.swap(threadBuffer->events);
+			}
+			if (!events.empty())
+			{
+				submit(std::move(events));
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_stopping = true;
+	}
+	m_queueCondition.notify_one();
+	m_flushThread.join();
+
+	m_file << "\n]}\n";
+	m_file.close();
+}
+
+uint64_t TraceRecorder::now() const
+{
+	return static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+void TraceRecorder::addSpan(const char* category, const std::string& name, uint64_t startNanoseconds, uint64_t endNanoseconds)
+{
+	ThreadBuffer* threadBuffer = getThreadBuffer();
+
+	std::vector<Event> fullEvents;
+	{
+		std::lock_guard<std::mutex> lock(threadBuffer->mutex);
+		threadBuffer->events.push_back(
+			{name, category, startNanoseconds, endNanoseconds - startNanoseconds, threadBuffer->threadId});
+		if (threadBuffer->events.size() >= THREAD_BUFFER_CAPACITY)
+		{
+			fullEvents.swap(threadBuffer->events);
+			threadBuffer->events.reserve(THREAD_BUFFER_CAPACITY);
+		}
+	}
+
+	if (!fullEvents.empty())
+	{
+		submit(std::move(fullEvents));
+	}
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getThreadBuffer()
+{
+	// Caches the buffer of the recorder that was used last on this thread. Serial numbers are never reused, so a cached
+	// buffer of a destroyed recorder is never dereferenced. Other recorders look up their buffer of this thread.
+	static thread_local uint64_t cachedSerialNumber = 0;
+	static thread_local ThreadBuffer* cachedThreadBuffer = nullptr;
+
+	if (cachedSerialNumber != m_serialNumber)
+	{
+		std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+		std::unique_ptr<ThreadBuffer>& threadBuffer = m_threadBuffers[std::this_thread::get_id()];
+		if (!threadBuffer)
+		{
+			threadBuffer.reset(new ThreadBuffer());
+			threadBuffer->events.reserve(THREAD_BUFFER_CAPACITY);
+			threadBuffer->threadId = static_cast<uint32_t>(m_threadBuffers.size());
+		}
+		cachedThreadBuffer = threadBuffer.get();
+		cachedSerialNumber = m_serialNumber;
+	}
+	return cachedThreadBuffer;
+}
+
+void TraceRecorder::submit(std::vector<Event>&& events)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_queue.push_back(std::move(events));
+	}
+	m_queueCondition.notify_one();
+}
+
+void TraceRecorder::runFlushThread()
+{
+	while (true)
+	{
+		std::vector<Event> events;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueCondition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+			if (m_queue.empty())
+			{
+				return;
+			}
+			events = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+		writeEvents(events);
+	}
+}
+
+void TraceRecorder::writeEvents(const std::vector<Event>& events)
+{
+	for (const Event& event: events)
+	{
+		nlohmann::json j;
+		j["name"] = event.name;
+		j["cat"] = event.category;
+		j["ph"] = "X";
+		j["ts"] = event.startNanoseconds / 1000.0;
+		j["dur"] = event.durationNanoseconds / 1000.0;
+		j["pid"] = 1;
+		j["tid"] = event.threadId;
+
+		std::string serializedEvent;
+		try
+		{
+			serializedEvent = j.dump();
+		}
+		catch (const nlohmann::json::exception&)
+		{
+			// skip spans whose name is not valid UTF-8
+			continue;
+		}
+
+		m_file << (m_firstEventWritten ? ",\n" : "\n") << serializedEvent;
+		m_firstEventWritten = true;
+	}
+}
+}	 // namespace sourcetrail
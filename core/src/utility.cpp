@@ -16,7 +16,16 @@
 
 #include "utility.h"
 
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
 #include <ctime>
 #include <fstream>
 #include <vector>
@@ -63,6 +72,40 @@ std::istream& safeGetline(std::istream& is, std::string& t)
 		}
 	}
 }
+
+const uint64_t HASH_PRIME_1 = 11400714785074694791ULL;
+const uint64_t HASH_PRIME_2 = 14029467366897019727ULL;
+const uint64_t HASH_PRIME_3 = 1609587929392839161ULL;
+const uint64_t HASH_PRIME_4 = 9650029242287828579ULL;
+const uint64_t HASH_PRIME_5 = 2870177450012600261ULL;
+
+uint64_t rotateLeft(uint64_t value, int bitCount)
+{
+	return (value << bitCount) | (value >> (64 - bitCount));
+}
+
+uint64_t readLittleEndian(const unsigned char* data, size_t byteCount)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < byteCount; i++)
+	{
+		value |= static_cast<uint64_t>(data[i]) << (8 * i);
+	}
+	return value;
+}
+
+uint64_t hashRound(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * HASH_PRIME_2;
+	accumulator = rotateLeft(accumulator, 31);
+	return accumulator * HASH_PRIME_1;
+}
+
+uint64_t hashMergeRound(uint64_t accumulator, uint64_t value)
+{
+	accumulator ^= hashRound(0, value);
+	return accumulator * HASH_PRIME_1 + HASH_PRIME_4;
+}
 }	 // namespace
 
 namespace sourcetrail
@@ -75,6 +118,51 @@ bool getFileExists(const std::string& filePath)
 	return file.good();
 }
 
+bool replaceFile(const std::string& filePath, const std::string& newFilePath)
+{
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(
+		filePath.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	const bool flushed = FlushFileBuffers(fileHandle) != 0;
+	CloseHandle(fileHandle);
+
+	return flushed &&
+		MoveFileExA(filePath.c_str(), newFilePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const int fileDescriptor = open(filePath.c_str(), O_RDWR);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+	const bool flushed = fsync(fileDescriptor) == 0;
+	close(fileDescriptor);
+
+	if (!flushed || std::rename(filePath.c_str(), newFilePath.c_str()) != 0)
+	{
+		return false;
+	}
+
+	// the rename itself is only durable once the directory entry is written
+	const size_t separatorPos = newFilePath.rfind('/');
+	const std::string directoryPath = separatorPos == std::string::npos
+		? std::string(".")
+		: (separatorPos == 0 ? std::string("/") : newFilePath.substr(0, separatorPos));
+	const int directoryDescriptor = open(directoryPath.c_str(), O_RDONLY);
+	if (directoryDescriptor < 0)
+	{
+		return false;
+	}
+	// some file systems don't support flushing directories
+	const bool directoryFlushed = fsync(directoryDescriptor) == 0 || errno == EINVAL;
+	close(directoryDescriptor);
+	return directoryFlushed;
+#endif
+}
+
 std::string getFileContent(const std::string& filePath)
 {
 	std::vector<std::string> lines;
@@ -142,5 +230,126 @@ int getLineCount(const std::string s)
 {
 	return static_cast<int>(std::count(s.begin(), s.end(), '\n'));
 }
+
+std::string toLowerCase(const std::string& s)
+{
+	std::string lower = s;
+	for (char& c: lower)
+	{
+		if (c >= 'A' && c <= 'Z')
+		{
+			c = static_cast<char>(c - 'A' + 'a');
+		}
+	}
+	return lower;
+}
+
+std::vector<std::string> getLowerCaseNameTokens(const std::string& name)
+{
+	// splits at non-alphanumeric ASCII characters and at camel case boundaries, e.g. "HTTPServer_getURL2" results
+	// in "http", "server", "get" and "url2". Non-ASCII bytes are treated as letters.
+	const auto isUpper = [](char c) { return c >= 'A' && c <= 'Z'; };
+	const auto isLower = [](char c) { return (c >= 'a' && c <= 'z') || (c & 0x80); };
+	const auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+	std::vector<std::string> tokens;
+	std::string token;
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		const char c = name[i];
+		if (!isUpper(c) && !isLower(c) && !isDigit(c))
+		{
+			if (!token.empty())
+			{
+				tokens.push_back(token);
+				token.clear();
+			}
+			continue;
+		}
+
+		if (isUpper(c) && !token.empty())
+		{
+			const bool afterLower = isLower(name[i - 1]) || isDigit(name[i - 1]);
+			const bool beforeLower = isUpper(name[i - 1]) && i + 1 < name.size() && isLower(name[i + 1]);
+			if (afterLower || beforeLower)
+			{
+				tokens.push_back(token);
+				token.clear();
+			}
+		}
+		token += isUpper(c) ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	if (!token.empty())
+	{
+		tokens.push_back(token);
+	}
+	return tokens;
+}
+
+uint64_t getHash64(const std::string& s)
+{
+	return getHash64(s.data(), s.size());
+}
+
+uint64_t getHash64(const char* characters, size_t size)
+{
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(characters);
+	const unsigned char* end = data + size;
+	uint64_t hash = 0;
+
+	if (size >= 32)
+	{
+		uint64_t v1 = HASH_PRIME_1 + HASH_PRIME_2;
+		uint64_t v2 = HASH_PRIME_2;
+		uint64_t v3 = 0;
+		uint64_t v4 = 0 - HASH_PRIME_1;
+		while (end - data >= 32)
+		{
+			v1 = hashRound(v1, readLittleEndian(data, 8));
+			v2 = hashRound(v2, readLittleEndian(data + 8, 8));
+			v3 = hashRound(v3, readLittleEndian(data + 16, 8));
+			v4 = hashRound(v4, readLittleEndian(data + 24, 8));
+			data += 32;
+		}
+		hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+		hash = hashMergeRound(hash, v1);
+		hash = hashMergeRound(hash, v2);
+		hash = hashMergeRound(hash, v3);
+		hash = hashMergeRound(hash, v4);
+	}
+	else
+	{
+		hash = HASH_PRIME_5;
+	}
+
+	hash += static_cast<uint64_t>(size);
+
+	while (end - data >= 8)
+	{
+		hash ^= hashRound(0, readLittleEndian(data, 8));
+		hash = rotateLeft(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+		data += 8;
+	}
+	if (end - data >= 4)
+	{
+		hash ^= readLittleEndian(data, 4) * HASH_PRIME_1;
+		hash = rotateLeft(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+		data += 4;
+	}
+	while (data < end)
+	{
+		hash ^= (*data) * HASH_PRIME_5;
+		hash = rotateLeft(hash, 11) * HASH_PRIME_1;
+		data++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= HASH_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= HASH_PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
 }	 // namespace utility
 }	 // namespace sourcetrail
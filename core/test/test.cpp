@@ -16,11 +16,25 @@
 
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() function
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <tuple>
+
 #include "catch.hpp"
+#include "json.hpp"
 
 #include "DatabaseStorage.h"
+#include "GraphSnapshot.h"
 #include "NodeKind.h"
+#include "OperationJournal.h"
+#include "SourcetrailDBC.h"
 #include "SourcetrailDBWriter.h"
+#include "SourcetrailException.h"
+#include "utility.h"
 
 namespace sourcetrail
 {
@@ -599,4 +613,1345 @@ namespace sourcetrail
 		writer.close();
 		REQUIRE(writer.getLastError() == "");
 	}
+
+	TEST_CASE("Testing GraphSnapshot represents edges in compressed sparse row format")
+	{
+		const std::string databasePath = "testing.db";
+		const std::string snapshotPath = "testing.srctrlgraph";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int idFoo = writer.recordSymbol({ "::" ,{ { "", "foo", "" } } });
+		const int idBar = writer.recordSymbol({ "::" ,{ { "", "bar", "" } } });
+		const int idBarBaz = writer.recordSymbol({ "::" ,{ { "", "bar", "" }, { "", "baz", "" } } });
+		const int idCall = writer.recordReference(idFoo, idBarBaz, ReferenceKind::CALL);
+		const int idUsage = writer.recordReference(idFoo, idBar, ReferenceKind::USAGE);
+		REQUIRE(writer.getLastError() == "");
+
+		const std::unique_ptr<GraphSnapshot> created = GraphSnapshot::create(*storage);
+		created->save(snapshotPath);
+		const std::unique_ptr<GraphSnapshot> loaded = GraphSnapshot::load(snapshotPath);
+
+		for (const GraphSnapshot* snapshot: { created.get(), loaded.get() })
+		{
+			REQUIRE(snapshot->getNodeCount() == 3);
+			REQUIRE(snapshot->getEdgeCount() == 3);
+
+			const int indexFoo = snapshot->getNodeIndex(idFoo);
+			const int indexBar = snapshot->getNodeIndex(idBar);
+			const int indexBarBaz = snapshot->getNodeIndex(idBarBaz);
+			REQUIRE(indexFoo >= 0);
+			REQUIRE(snapshot->getNodeId(indexBar) == idBar);
+			REQUIRE(snapshot->getNodeIndex(idCall) == -1);
+
+			const int32_t* offsets = snapshot->getOffsets();
+			REQUIRE(offsets[indexFoo + 1] - offsets[indexFoo] == 2);
+			REQUIRE(snapshot->getTargets()[offsets[indexFoo]] == indexBarBaz);
+			REQUIRE(snapshot->getEdgeIds()[offsets[indexFoo]] == idCall);
+			REQUIRE(snapshot->getEdgeKinds()[offsets[indexFoo]] == edgeKindToInt(EdgeKind::CALL));
+			REQUIRE(snapshot->getTargets()[offsets[indexFoo] + 1] == indexBar);
+			REQUIRE(snapshot->getEdgeIds()[offsets[indexFoo] + 1] == idUsage);
+
+			REQUIRE(offsets[indexBar + 1] - offsets[indexBar] == 1);
+			REQUIRE(snapshot->getTargets()[offsets[indexBar]] == indexBarBaz);
+			REQUIRE(snapshot->getEdgeKinds()[offsets[indexBar]] == edgeKindToInt(EdgeKind::MEMBER));
+
+			REQUIRE(offsets[indexBarBaz + 1] - offsets[indexBarBaz] == 0);
+		}
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing GraphSnapshot rejects corrupt snapshot files")
+	{
+		const std::string databasePath = "testing.db";
+		const std::string snapshotPath = "testing.srctrlgraph";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int idFoo = writer.recordSymbol({ "::" ,{ { "", "foo", "" } } });
+		const int idBar = writer.recordSymbol({ "::" ,{ { "", "bar", "" } } });
+		writer.recordReference(idFoo, idBar, ReferenceKind::CALL);
+		REQUIRE(writer.getLastError() == "");
+
+		GraphSnapshot::create(*storage)->save(snapshotPath);
+		writer.close();
+
+		// header [4], node ids [2], node kinds [2], offsets [3], targets [1], edge kinds [1], edge ids [1]
+		std::vector<int32_t> words(14);
+		{
+			std::ifstream fileStream(snapshotPath, std::ios::in | std::ios::binary);
+			fileStream.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(int32_t));
+			REQUIRE(fileStream.gcount() == static_cast<std::streamsize>(words.size() * sizeof(int32_t)));
+		}
+		REQUIRE(GraphSnapshot::load(snapshotPath)->getEdgeCount() == 1);
+
+		const auto writeWord = [&](size_t index, int32_t value) {
+			std::vector<int32_t> corruptWords = words;
+			corruptWords[index] = value;
+			std::ofstream fileStream(snapshotPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			fileStream.write(reinterpret_cast<const char*>(corruptWords.data()), corruptWords.size() * sizeof(int32_t));
+		};
+
+		SECTION("node ids out of order")
+		{
+			writeWord(5, words[4]);
+			REQUIRE_THROWS_AS(GraphSnapshot::load(snapshotPath), SourcetrailException);
+		}
+
+		SECTION("offset beyond the edges")
+		{
+			writeWord(9, 2);
+			REQUIRE_THROWS_AS(GraphSnapshot::load(snapshotPath), SourcetrailException);
+		}
+
+		SECTION("decreasing offsets")
+		{
+			writeWord(9, -1);
+			REQUIRE_THROWS_AS(GraphSnapshot::load(snapshotPath), SourcetrailException);
+		}
+
+		SECTION("last offset not matching the edge count")
+		{
+			writeWord(10, 0);
+			REQUIRE_THROWS_AS(GraphSnapshot::load(snapshotPath), SourcetrailException);
+		}
+
+		SECTION("target beyond the nodes")
+		{
+			writeWord(11, 2);
+			REQUIRE_THROWS_AS(GraphSnapshot::load(snapshotPath), SourcetrailException);
+		}
+
+		std::remove(snapshotPath.c_str());
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter builds name search index")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int idNamespace = writer.recordSymbol({ "::" ,{ { "", "io", "" } } });
+		const int idClass = writer.recordSymbol({ "::" ,{ { "", "io", "" }, { "", "HTTPServer", "" } } });
+		const int idMethod = writer.recordSymbol({ "::" ,{ { "", "io", "" }, { "", "HTTPServer", "" }, { "void", "getURL", "()" } } });
+		REQUIRE(writer.updateNameIndex());
+		REQUIRE(writer.getLastError() == "");
+
+		SECTION("prefix search matches name and name tokens case insensitively")
+		{
+			REQUIRE(storage->findNodeIdsByNamePrefix("httpS") == std::vector<int>({ idClass }));
+			REQUIRE(storage->findNodeIdsByNamePrefix("serv") == std::vector<int>({ idClass }));
+			REQUIRE(storage->findNodeIdsByNamePrefix("ur") == std::vector<int>({ idMethod }));
+			REQUIRE(storage->findNodeIdsByNamePrefix("io") == std::vector<int>({ idNamespace }));
+			REQUIRE(storage->findNodeIdsByNamePrefix("x").empty());
+		}
+
+		SECTION("substring search matches inside of names")
+		{
+			REQUIRE(storage->findNodeIdsByNameSubstring("pSer") == std::vector<int>({ idClass }));
+			REQUIRE(storage->findNodeIdsByNameSubstring("e").size() == 2);
+			REQUIRE(storage->findNodeIdsByNameSubstring("e", 1).size() == 1);
+		}
+
+		SECTION("substring search looks up trigrams of names")
+		{
+			REQUIRE(storage->findNodeIdsByNameSubstring("TPSERV") == std::vector<int>({ idClass }));
+			REQUIRE(storage->findNodeIdsByNameSubstring("geturl") == std::vector<int>({ idMethod }));
+			REQUIRE(storage->findNodeIdsByNameSubstring("serverx").empty());
+			REQUIRE(storage->findNodeIdsByNameSubstring("io") == std::vector<int>({ idNamespace }));
+		}
+
+		SECTION("trigrams are added to indices built without them")
+		{
+			{
+				CppSQLite3DB database;
+				database.open(databasePath.c_str());
+				database.execDML("DROP TABLE node_name_trigram;");
+			}
+			REQUIRE_THROWS_AS(storage->findNodeIdsByNameSubstring("pserv"), SourcetrailException);
+
+			REQUIRE(writer.updateNameIndex());
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM node_name_trigram WHERE trigram = 'pse';") == 1);
+			REQUIRE(storage->findNodeIdsByNameSubstring("pserv") == std::vector<int>({ idClass }));
+		}
+
+		SECTION("updating the index is incremental")
+		{
+			const int idField = writer.recordSymbol({ "::" ,{ { "", "io", "" }, { "", "HTTPServer", "" }, { "", "m_url", "" } } });
+			REQUIRE(writer.updateNameIndex());
+			std::vector<int> nodeIds = storage->findNodeIdsByNamePrefix("url");
+			std::sort(nodeIds.begin(), nodeIds.end());
+			REQUIRE(nodeIds == std::vector<int>({ idMethod, idField }));
+		}
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter builds source location index")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int fileId = writer.recordFile("path/to/non_existing_file.cpp");
+		const int otherFileId = writer.recordFile("path/to/other_non_existing_file.cpp");
+		const int idClass = writer.recordSymbol({ "::" ,{ { "", "Foo", "" } } });
+		const int idMethod = writer.recordSymbol({ "::" ,{ { "", "Foo", "" }, { "void", "bar", "()" } } });
+
+		writer.recordSymbolScopeLocation(idClass, { fileId, 1, 1, 100, 1 });
+		writer.recordSymbolLocation(idClass, { fileId, 1, 7, 1, 9 });
+		writer.recordSymbolScopeLocation(idMethod, { fileId, 10, 2, 20, 2 });
+		writer.recordSymbolLocation(idMethod, { fileId, 10, 7, 10, 9 });
+		writer.recordSymbolScopeLocation(idClass, { otherFileId, 1, 1, 100, 1 });
+		REQUIRE(writer.updateLocationIndex());
+		REQUIRE(writer.getLastError() == "");
+
+		const auto getLocationKinds = [&](int line, int column) {
+			std::vector<int> kinds;
+			for (const StorageSourceLocation& location: storage->getLocationsAt(fileId, line, column))
+			{
+				kinds.push_back(location.locationKind);
+			}
+			std::sort(kinds.begin(), kinds.end());
+			return kinds;
+		};
+
+		const int scope = locationKindToInt(LocationKind::SCOPE);
+		const int token = locationKindToInt(LocationKind::TOKEN);
+
+		REQUIRE(getLocationKinds(1, 8) == std::vector<int>({ std::min(scope, token), std::max(scope, token) }));
+		REQUIRE(getLocationKinds(1, 10) == std::vector<int>({ scope }));
+		REQUIRE(getLocationKinds(10, 1) == std::vector<int>({ scope }));
+		REQUIRE(getLocationKinds(10, 7).size() == 3);
+		REQUIRE(getLocationKinds(15, 1).size() == 2);
+		REQUIRE(getLocationKinds(20, 3) == std::vector<int>({ scope }));
+		REQUIRE(getLocationKinds(101, 1).empty());
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing NameHierarchy database string deserialization")
+	{
+		SECTION("deserialization is the inverse of serialization")
+		{
+			const NameHierarchy nameHierarchy({ "::" ,{ { "", "std", "" }, { "template <typename T>", "vector", "<T>" }, { "void", "push_back", "(const T &)" } } });
+			const std::string serialized = serializeNameHierarchyToDatabaseString(nameHierarchy);
+
+			std::string error;
+			const NameHierarchy deserialized = deserializeNameHierarchyFromDatabaseString(serialized, &error);
+			REQUIRE(error == "");
+			REQUIRE(deserialized.nameDelimiter == nameHierarchy.nameDelimiter);
+			REQUIRE(deserialized.nameElements.size() == 3);
+			for (size_t i = 0; i < 3; i++)
+			{
+				REQUIRE(deserialized.nameElements[i].prefix == nameHierarchy.nameElements[i].prefix);
+				REQUIRE(deserialized.nameElements[i].name == nameHierarchy.nameElements[i].name);
+				REQUIRE(deserialized.nameElements[i].postfix == nameHierarchy.nameElements[i].postfix);
+			}
+		}
+
+		SECTION("deserialization is the inverse of serialization for hierarchies without elements")
+		{
+			const NameHierarchy nameHierarchy({ "::", {} });
+			const std::string serialized = serializeNameHierarchyToDatabaseString(nameHierarchy);
+			REQUIRE(serialized == "::\tm");
+
+			std::string error;
+			const NameHierarchy deserialized = deserializeNameHierarchyFromDatabaseString(serialized, &error);
+			REQUIRE(error == "");
+			REQUIRE(deserialized.nameDelimiter == "::");
+			REQUIRE(deserialized.nameElements.empty());
+		}
+
+		SECTION("serializing leading elements reuses the buffer")
+		{
+			const NameHierarchy nameHierarchy({ "::" ,{ { "", "std", "" }, { "template <typename T>", "vector", "<T>" }, { "void", "push_back", "(const T &)" } } });
+
+			std::string buffer;
+			serializeNameHierarchyToDatabaseString(nameHierarchy, 3, buffer);
+			REQUIRE(buffer == serializeNameHierarchyToDatabaseString(nameHierarchy));
+			REQUIRE(buffer.capacity() >= buffer.size());
+
+			const char* data = buffer.data();
+			serializeNameHierarchyToDatabaseString(nameHierarchy, 1, buffer);
+			REQUIRE(buffer == serializeNameHierarchyToDatabaseString({ "::", { { "", "std", "" } } }));
+			REQUIRE(buffer.data() == data);
+
+			serializeNameHierarchyToDatabaseString(nameHierarchy, 5, buffer);
+			REQUIRE(buffer == serializeNameHierarchyToDatabaseString(nameHierarchy));
+		}
+
+		SECTION("parsing references the parsed characters")
+		{
+			const std::string serialized = serializeNameHierarchyToDatabaseString({ ".", { { "", "a\tb", "" }, { "int", "c", "\t" } } });
+
+			StringRef nameDelimiter;
+			std::vector<NameElementRef> nameElements;
+			REQUIRE(parseNameHierarchyDatabaseString(serialized.data(), serialized.size(), nameDelimiter, nameElements));
+			REQUIRE(nameDelimiter.data == serialized.data());
+			REQUIRE(nameDelimiter.toString() == ".");
+			REQUIRE(nameElements.size() == 2);
+			REQUIRE(nameElements[0].name.toString() == "a\tb");
+			REQUIRE(nameElements[1].prefix.toString() == "int");
+			REQUIRE(nameElements[1].postfix.toString() == "\t");
+		}
+
+		SECTION("deserialization fails for strings in other formats")
+		{
+			std::string error;
+			REQUIRE(deserializeNameHierarchyFromDatabaseString("foo", &error).nameElements.empty());
+			REQUIRE(error != "");
+			REQUIRE(deserializeNameHierarchyFromDatabaseString("::\tmfoo\tsbar", nullptr).nameElements.empty());
+
+			error.clear();
+			deserializeNameHierarchyFromDatabaseString("::\tmfoo", &error);
+			REQUIRE(error != "");
+		}
+
+		SECTION("serialized names can be parsed while streaming nodes")
+		{
+			const std::string databasePath = "testing.db";
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+			SourcetrailDBWriter writer;
+			writer.open(databasePath);
+			writer.clear();
+			writer.recordSymbol({ "::" ,{ { "", "foo", "" }, { "", "bar", "" } } });
+
+			std::vector<std::string> names;
+			StringRef nameDelimiter;
+			std::vector<NameElementRef> nameElements;
+			storage->forEachNode([&](int, int, const char* serializedName, size_t serializedNameSize) {
+				REQUIRE(parseNameHierarchyDatabaseString(serializedName, serializedNameSize, nameDelimiter, nameElements));
+				names.push_back(nameElements.back().name.toString());
+			});
+			REQUIRE(names == std::vector<std::string>({ "foo", "bar" }));
+
+			writer.close();
+		}
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records locations in bulk")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int fileId = writer.recordFile("path/to/non_existing_file.cpp");
+		const int idSymbol1 = writer.recordSymbol({ "." ,{ { "void", "foo", "()" } } });
+		const int idSymbol2 = writer.recordSymbol({ "." ,{ { "void", "bar", "()" } } });
+		const int idReference1 = writer.recordReference(idSymbol1, idSymbol2, ReferenceKind::CALL);
+
+		const int symbolRows[] = {
+			idSymbol1, fileId, 1, 1, 1, 3,
+			idSymbol2, fileId, 2, 1, 2, 3
+		};
+		REQUIRE(writer.recordSymbolLocations(symbolRows, 2));
+
+		const int referenceRows[] = {
+			idReference1, fileId, 3, 1, 3, 3
+		};
+		REQUIRE(writer.recordReferenceLocations(referenceRows, 1));
+		REQUIRE(writer.getLastError() == "");
+
+		const std::vector<StorageSourceLocation> sourceLocations = storage->getAll<StorageSourceLocation>();
+		REQUIRE(sourceLocations.size() == 3);
+		REQUIRE(sourceLocations[1].startLineNumber == 2);
+		REQUIRE(sourceLocations[1].endColumnNumber == 3);
+
+		const std::vector<StorageOccurrence> occurrences = storage->getAll<StorageOccurrence>();
+		REQUIRE(occurrences.size() == 3);
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records references in bulk")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+
+		const int idSymbol1 = writer.recordSymbol({ "." ,{ { "void", "foo", "()" } } });
+		const int idSymbol2 = writer.recordSymbol({ "." ,{ { "void", "bar", "()" } } });
+		const int idReference1 = writer.recordReference(idSymbol1, idSymbol2, ReferenceKind::CALL);
+
+		const int rows[] = {
+			idSymbol1, idSymbol2, static_cast<int>(ReferenceKind::USAGE),
+			idSymbol1, idSymbol2, static_cast<int>(ReferenceKind::CALL)
+		};
+		int referenceIds[2] = { 0, 0 };
+		REQUIRE(writer.recordReferences(rows, 2, referenceIds));
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(referenceIds[0] != 0);
+		REQUIRE(referenceIds[0] != idReference1);
+		REQUIRE(referenceIds[1] == idReference1);
+
+		const int invalidRows[] = {
+			idSymbol2, idSymbol1, 42
+		};
+		REQUIRE(!writer.recordReferences(invalidRows, 1, referenceIds));
+		REQUIRE(writer.getLastError() != "");
+
+		writer.close();
+	}
+
+	TEST_CASE("Testing C interface records data through a writer handle")
+	{
+		const std::string databasePath = "testing.db";
+
+		srctrl_writer* writer = srctrl_writer_create();
+		REQUIRE(writer != nullptr);
+		REQUIRE(srctrl_open(writer, databasePath.data(), databasePath.size()) == SRCTRL_OK);
+		REQUIRE(srctrl_clear(writer) == SRCTRL_OK);
+
+		const std::string filePath = "path/to/non_existing_file.cpp";
+		int fileId = 0;
+		REQUIRE(srctrl_record_file(writer, filePath.data(), filePath.size(), &fileId) == SRCTRL_OK);
+		REQUIRE(fileId != 0);
+
+		const srctrl_name_element fooElement = { { "void", 4 }, { "foo", 3 }, { "()", 2 } };
+		const srctrl_name_element barElement = { { "void", 4 }, { "bar", 3 }, { "()", 2 } };
+		const srctrl_symbol symbols[] = { { { "::", 2 }, &fooElement, 1 }, { { "::", 2 }, &barElement, 1 } };
+		int symbolIds[2] = { 0, 0 };
+		REQUIRE(srctrl_record_symbols(writer, symbols, 2, symbolIds) == SRCTRL_OK);
+		REQUIRE(symbolIds[0] != 0);
+		REQUIRE(symbolIds[1] != 0);
+
+		int symbolId = 0;
+		REQUIRE(srctrl_record_symbol(writer, &symbols[0], &symbolId) == SRCTRL_OK);
+		REQUIRE(symbolId == symbolIds[0]);
+		REQUIRE(srctrl_record_symbol_kind(writer, symbolId, SRCTRL_SYMBOL_FUNCTION) == SRCTRL_OK);
+		REQUIRE(srctrl_record_symbol_kind(writer, symbolId, 100) == SRCTRL_ERROR_INVALID_ARGUMENT);
+
+		const int referenceRows[] = { symbolIds[0], symbolIds[1], SRCTRL_REFERENCE_CALL };
+		int referenceId = 0;
+		REQUIRE(srctrl_record_references(writer, referenceRows, 1, &referenceId) == SRCTRL_OK);
+		REQUIRE(srctrl_record_reference_is_ambiguous(writer, referenceId) == SRCTRL_OK);
+
+		const int locationRows[] = { referenceId, fileId, 3, 1, 3, 3 };
+		REQUIRE(srctrl_record_reference_locations(writer, locationRows, 1) == SRCTRL_OK);
+
+		REQUIRE(srctrl_record_symbol_location(writer, 0, fileId, 1, 1, 1, 3) == SRCTRL_ERROR);
+		const char* message = nullptr;
+		size_t messageLength = 0;
+		REQUIRE(srctrl_writer_get_last_error(writer, &message, &messageLength) == SRCTRL_OK);
+		REQUIRE(messageLength != 0);
+		REQUIRE(srctrl_writer_clear_last_error(writer) == SRCTRL_OK);
+
+		REQUIRE(srctrl_close(writer) == SRCTRL_OK);
+		srctrl_writer_destroy(writer);
+
+		REQUIRE(srctrl_open(nullptr, databasePath.data(), databasePath.size()) == SRCTRL_ERROR_INVALID_ARGUMENT);
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter collects statistics")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		writer.beginTransaction();
+		const int idSymbol1 = writer.recordSymbol({ "." ,{ { "void", "foo", "()" } } });
+		const int idSymbol2 = writer.recordSymbol({ "." ,{ { "void", "foo", "()" } } });
+		REQUIRE(idSymbol1 == idSymbol2);
+		writer.commitTransaction();
+		writer.close();
+
+		const WriterStatistics statistics = writer.getStatistics();
+		REQUIRE(statistics.operations.size() == static_cast<size_t>(WriterOperation::COUNT));
+		REQUIRE(statistics.tables.size() == static_cast<size_t>(WriterTable::COUNT));
+
+		const WriterStatistics::Operation& recordSymbolStatistics =
+			statistics.operations[static_cast<int>(WriterOperation::RECORD_SYMBOL)];
+		const WriterStatistics::Table& nodeStatistics = statistics.tables[static_cast<int>(WriterTable::NODE)];
+		REQUIRE(recordSymbolStatistics.name == "recordSymbol");
+		REQUIRE(nodeStatistics.name == "node");
+
+#ifdef SOURCETRAIL_ENABLE_STATISTICS
+		REQUIRE(statistics.enabled);
+		REQUIRE(recordSymbolStatistics.duration.count == 2);
+		REQUIRE(recordSymbolStatistics.duration.maxNanoseconds > 0);
+		REQUIRE(recordSymbolStatistics.duration.totalNanoseconds >= recordSymbolStatistics.duration.maxNanoseconds);
+		REQUIRE(nodeStatistics.insertedRowCount == 1);
+		REQUIRE(nodeStatistics.deduplicatedRowCount == 1);
+		REQUIRE(statistics.commits.count >= 1);
+
+		writer.resetStatistics();
+		REQUIRE(writer.getStatistics().operations[static_cast<int>(WriterOperation::RECORD_SYMBOL)].duration.count == 0);
+#else
+		REQUIRE(!statistics.enabled);
+		REQUIRE(recordSymbolStatistics.duration.count == 0);
+		REQUIRE(nodeStatistics.insertedRowCount == 0);
+#endif
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter writes trace")
+	{
+		const std::string databasePath = "testing.db";
+		const std::string traceFilePath = "testing_trace.json";
+
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.startTracing(traceFilePath));
+			REQUIRE(writer.open(databasePath));
+			REQUIRE(writer.clear());
+			REQUIRE(writer.beginTransaction());
+			REQUIRE(writer.recordFile("testing_trace_missing_file.cpp") != 0);
+			REQUIRE(writer.commitTransaction());
+			REQUIRE(writer.optimizeDatabaseMemory());
+			REQUIRE(writer.close());
+			writer.stopTracing();
+		}
+
+		std::ifstream traceFile(traceFilePath);
+		const std::string trace((std::istreambuf_iterator<char>(traceFile)), std::istreambuf_iterator<char>());
+		traceFile.close();
+		std::remove(traceFilePath.c_str());
+
+		const nlohmann::json j = nlohmann::json::parse(trace);
+		std::set<std::string> spanNames;
+		for (const nlohmann::json& event: j["traceEvents"])
+		{
+			REQUIRE(event["ph"] == "X");
+			spanNames.insert(event["name"].get<std::string>());
+		}
+
+		REQUIRE(spanNames.count("open") == 1);
+		REQUIRE(spanNames.count("recordFile") == 1);
+		REQUIRE(spanNames.count("read file") == 1);
+		REQUIRE(spanNames.count("count lines") == 1);
+		REQUIRE(spanNames.count("insert file") == 1);
+		REQUIRE(spanNames.count("transaction") == 1);
+		REQUIRE(spanNames.count("create indices") == 1);
+		REQUIRE(spanNames.count("vacuum") == 1);
+		REQUIRE(spanNames.count("COMMIT TRANSACTION;") == 1);
+		REQUIRE(spanNames.count("execute prepared statement") == 1);
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter traces alternating writers on one thread")
+	{
+		const std::string traceFilePaths[] = {"testing_trace_0.json", "testing_trace_1.json"};
+		const std::string databasePaths[] = {"testing_trace_0.srctrldb", "testing_trace_1.srctrldb"};
+
+		{
+			SourcetrailDBWriter writers[2];
+			for (int i = 0; i < 2; i++)
+			{
+				REQUIRE(writers[i].startTracing(traceFilePaths[i]));
+				REQUIRE(writers[i].open(databasePaths[i]));
+			}
+			for (int j = 0; j < 50; j++)
+			{
+				for (int i = 0; i < 2; i++)
+				{
+					REQUIRE(writers[i].recordFile("testing_trace_missing_file_" + std::to_string(j) + ".cpp") != 0);
+				}
+			}
+			for (int i = 0; i < 2; i++)
+			{
+				REQUIRE(writers[i].close());
+				writers[i].stopTracing();
+			}
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			std::ifstream traceFile(traceFilePaths[i]);
+			const std::string trace((std::istreambuf_iterator<char>(traceFile)), std::istreambuf_iterator<char>());
+			traceFile.close();
+
+			// each recorder keeps one buffer per thread
+			std::set<int> threadIds;
+			size_t eventCount = 0;
+			const nlohmann::json j = nlohmann::json::parse(trace);
+			for (const nlohmann::json& event: j["traceEvents"])
+			{
+				threadIds.insert(event["tid"].get<int>());
+				eventCount++;
+			}
+			REQUIRE(eventCount > 50);
+			REQUIRE(threadIds.size() == 1);
+
+			std::remove(traceFilePaths[i].c_str());
+			std::remove(databasePaths[i].c_str());
+			std::remove(("testing_trace_" + std::to_string(i) + ".srctrlprj").c_str());
+		}
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter reports error for invalid trace file path")
+	{
+		SourcetrailDBWriter writer;
+		REQUIRE(!writer.startTracing("missing_directory/testing_trace.json"));
+		REQUIRE(!writer.getLastError().empty());
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter journal replay reproduces database")
+	{
+		const std::string journalFilePath = "testing_journal.bin";
+
+		auto recordJournaledWorkload = [&](const std::string& databasePath, bool anonymize) {
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.startJournal(journalFilePath, anonymize));
+			REQUIRE(writer.open(databasePath));
+			REQUIRE(writer.clear());
+			REQUIRE(writer.beginTransaction());
+			const int fileId = writer.recordFile("testing_journal_missing_file.cpp");
+			REQUIRE(writer.recordFileLanguage(fileId, "cpp"));
+			const int fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+			const int barId = writer.recordSymbol({"::", {{"", "Bar", ""}, {"int", "bar", "(int)"}}});
+			REQUIRE(writer.recordSymbolKind(fooId, SymbolKind::FUNCTION));
+			REQUIRE(writer.recordSymbolDefinitionKind(fooId, DefinitionKind::EXPLICIT));
+			REQUIRE(writer.recordSymbolLocation(fooId, {fileId, 1, 6, 1, 8}));
+			const int referenceId = writer.recordReference(fooId, barId, ReferenceKind::CALL);
+			REQUIRE(writer.recordReferenceLocation(referenceId, {fileId, 2, 3, 2, 5}));
+			const int rows[] = {barId, fooId, static_cast<int>(ReferenceKind::USAGE)};
+			int referenceIds[1] = {0};
+			REQUIRE(writer.recordReferences(rows, 1, referenceIds));
+			const int locationRows[] = {referenceIds[0], fileId, 4, 1, 4, 3};
+			REQUIRE(writer.recordReferenceLocations(locationRows, 1));
+			REQUIRE(writer.recordReferenceToUnsolvedSymhol(fooId, ReferenceKind::CALL, {fileId, 3, 1, 3, 4}) != 0);
+			const int localSymbolId = writer.recordLocalSymbol("local");
+			REQUIRE(writer.recordLocalSymbolLocation(localSymbolId, {fileId, 5, 1, 5, 5}));
+			REQUIRE(writer.recordError("secret error", false, {fileId, 6, 1, 6, 2}));
+			REQUIRE(writer.commitTransaction());
+			REQUIRE(writer.close());
+		};
+
+		auto getSerializedNames = [](const std::string& databasePath) {
+			std::set<std::string> serializedNames;
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+			for (const StorageNode& node: storage->getAll<StorageNode>())
+			{
+				serializedNames.insert(node.serializedName);
+			}
+			return serializedNames;
+		};
+
+		auto replay = [&](const std::string& databasePath) {
+			std::remove(databasePath.c_str());
+			OperationJournalReader reader(journalFilePath);
+			SourcetrailDBWriter writer;
+			const OperationJournalReplayResult result = replayOperationJournal(reader, databasePath, writer);
+			REQUIRE(result.failedOperationCount == 0);
+			REQUIRE(result.operationCount == 26);
+		};
+
+		recordJournaledWorkload("testing.db", false);
+		replay("testing_replay.db");
+		{
+			std::shared_ptr<DatabaseStorage> original = DatabaseStorage::openDatabase("testing.db");
+			std::shared_ptr<DatabaseStorage> replayed = DatabaseStorage::openDatabase("testing_replay.db");
+			REQUIRE(replayed->getAll<StorageEdge>().size() == original->getAll<StorageEdge>().size());
+			REQUIRE(replayed->getAll<StorageSourceLocation>().size() == original->getAll<StorageSourceLocation>().size());
+			REQUIRE(replayed->getAll<StorageOccurrence>().size() == original->getAll<StorageOccurrence>().size());
+			REQUIRE(replayed->getAll<StorageLocalSymbol>().size() == 1);
+			REQUIRE(replayed->getAll<StorageError>().size() == 1);
+		}
+		REQUIRE(getSerializedNames("testing_replay.db") == getSerializedNames("testing.db"));
+
+		recordJournaledWorkload("testing.db", true);
+		replay("testing_replay.db");
+		{
+			std::shared_ptr<DatabaseStorage> replayed = DatabaseStorage::openDatabase("testing_replay.db");
+			REQUIRE(replayed->getAll<StorageNode>().size() == getSerializedNames("testing.db").size());
+			for (const StorageNode& node: replayed->getAll<StorageNode>())
+			{
+				REQUIRE(node.serializedName.find("foo") == std::string::npos);
+				REQUIRE(node.serializedName.find("testing_journal") == std::string::npos);
+			}
+			const std::vector<StorageError> errors = replayed->getAll<StorageError>();
+			REQUIRE(errors.size() == 1);
+			REQUIRE(errors[0].message.size() == std::string("secret error").size());
+			REQUIRE(errors[0].message != "secret error");
+		}
+
+		std::remove(journalFilePath.c_str());
+		std::remove("testing_replay.db");
+		std::remove("testing_replay.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter materializes ingest log like direct writes")
+	{
+		const std::string ingestLogFilePath = "testing_ingest.log";
+
+		auto recordWorkload = [](SourcetrailDBWriter& writer) {
+			REQUIRE(writer.beginTransaction());
+			const int fileId = writer.recordFile("testing_ingest_missing_file.cpp");
+			REQUIRE(writer.recordFileLanguage(fileId, "cpp"));
+			const int fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+			const int barId = writer.recordSymbol({"::", {{"", "Bar", ""}, {"int", "bar", "(int)"}}});
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == fooId);
+			REQUIRE(writer.recordSymbolKind(fooId, SymbolKind::FUNCTION));
+			REQUIRE(writer.recordSymbolDefinitionKind(fooId, DefinitionKind::EXPLICIT));
+			REQUIRE(writer.recordSymbolDefinitionKind(fooId, DefinitionKind::IMPLICIT));
+			REQUIRE(writer.recordSymbolLocation(fooId, {fileId, 1, 6, 1, 8}));
+			REQUIRE(writer.recordSymbolLocation(fooId, {fileId, 1, 6, 1, 8}));
+			REQUIRE(writer.recordSymbolScopeLocation(fooId, {fileId, 1, 1, 3, 1}));
+			const int referenceId = writer.recordReference(fooId, barId, ReferenceKind::CALL);
+			REQUIRE(writer.recordReference(fooId, barId, ReferenceKind::CALL) == referenceId);
+			REQUIRE(writer.recordReferenceLocation(referenceId, {fileId, 2, 3, 2, 5}));
+			REQUIRE(writer.recordReferenceIsAmbiguous(referenceId));
+			REQUIRE(writer.recordReferenceToUnsolvedSymhol(fooId, ReferenceKind::CALL, {fileId, 3, 1, 3, 4}) != 0);
+			const int localSymbolId = writer.recordLocalSymbol("local");
+			REQUIRE(writer.recordLocalSymbolLocation(localSymbolId, {fileId, 2, 3, 2, 5}));
+			REQUIRE(writer.recordAtomicSourceRange({fileId, 1, 1, 3, 1}));
+			REQUIRE(writer.recordError("some error", false, {fileId, 6, 1, 6, 2}));
+			REQUIRE(writer.recordError("some error", false, {fileId, 6, 1, 6, 2}));
+			REQUIRE(writer.commitTransaction());
+		};
+
+		// nodes, edges, local symbols and errors keep their ids, source locations are compared by value
+		auto getContents = [](const std::string& databasePath) {
+			std::vector<std::string> contents;
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+			for (const StorageNode& node: storage->getAll<StorageNode>())
+			{
+				contents.push_back("node " + std::to_string(node.id) + " " + std::to_string(node.nodeKind) + " " + node.serializedName);
+			}
+			for (const StorageSymbol& symbol: storage->getAll<StorageSymbol>())
+			{
+				contents.push_back("symbol " + std::to_string(symbol.id) + " " + std::to_string(symbol.definitionKind));
+			}
+			for (const StorageFile& file: storage->getAll<StorageFile>())
+			{
+				contents.push_back("file " + std::to_string(file.id) + " " + file.filePath + " " + file.languageIdentifier);
+			}
+			for (const StorageEdge& edge: storage->getAll<StorageEdge>())
+			{
+				contents.push_back(
+					"edge " + std::to_string(edge.id) + " " + std::to_string(edge.sourceNodeId) + " " +
+					std::to_string(edge.targetNodeId) + " " + std::to_string(edge.edgeKind));
+			}
+			for (const StorageLocalSymbol& localSymbol: storage->getAll<StorageLocalSymbol>())
+			{
+				contents.push_back("local " + std::to_string(localSymbol.id) + " " + localSymbol.name);
+			}
+			for (const StorageError& error: storage->getAll<StorageError>())
+			{
+				contents.push_back("error " + std::to_string(error.id) + " " + error.message);
+			}
+
+			std::map<int, std::string> sourceLocations;
+			for (const StorageSourceLocation& location: storage->getAll<StorageSourceLocation>())
+			{
+				sourceLocations[location.id] = std::to_string(location.fileNodeId) + ":" +
+					std::to_string(location.startLineNumber) + ":" + std::to_string(location.startColumnNumber) + ":" +
+					std::to_string(location.endLineNumber) + ":" + std::to_string(location.endColumnNumber) + ":" +
+					std::to_string(location.locationKind);
+				contents.push_back("location " + sourceLocations[location.id]);
+			}
+			for (const StorageOccurrence& occurrence: storage->getAll<StorageOccurrence>())
+			{
+				contents.push_back(
+					"occurrence " + std::to_string(occurrence.elementId) + " " +
+					sourceLocations[occurrence.sourceLocationId]);
+			}
+			std::sort(contents.begin(), contents.end());
+			return contents;
+		};
+
+		// the ingest log assigns the ids of a new database
+		std::remove("testing_direct.db");
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open("testing_direct.db"));
+			recordWorkload(writer);
+			REQUIRE(writer.close());
+		}
+
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openIngestLog(ingestLogFilePath));
+			REQUIRE(writer.isEmpty());
+			recordWorkload(writer);
+			REQUIRE(!writer.isEmpty());
+			REQUIRE(!writer.rollbackTransaction());
+			REQUIRE(writer.close());
+
+			std::remove("testing_materialized.db");
+			REQUIRE(writer.open("testing_materialized.db"));
+			REQUIRE(writer.materializeIngestLog(ingestLogFilePath));
+			REQUIRE(!writer.materializeIngestLog(ingestLogFilePath));
+			REQUIRE(writer.close());
+		}
+
+		const std::vector<std::string> expectedContents = getContents("testing_direct.db");
+		REQUIRE(expectedContents.size() > 10);
+		REQUIRE(getContents("testing_materialized.db") == expectedContents);
+
+		{
+			// the lookup indices are created after materializing, so further writes are deduplicated
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open("testing_materialized.db"));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) != 0);
+			REQUIRE(writer.close());
+		}
+		REQUIRE(getContents("testing_materialized.db") == expectedContents);
+
+		std::remove(ingestLogFilePath.c_str());
+		std::remove("testing_direct.db");
+		std::remove("testing_direct.srctrlprj");
+		std::remove("testing_materialized.db");
+		std::remove("testing_materialized.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter stores committed files with the transaction")
+	{
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open("testing.db"));
+			REQUIRE(writer.clear());
+			REQUIRE(writer.getCommittedFilePaths().empty());
+
+			REQUIRE(writer.beginTransaction());
+			const int fileId = writer.recordFile("testing_committed_a.cpp");
+			REQUIRE(writer.recordFileCommitted(fileId));
+			REQUIRE(writer.commitTransaction());
+
+			REQUIRE(writer.beginTransaction());
+			const int rolledBackFileId = writer.recordFile("testing_committed_b.cpp");
+			REQUIRE(writer.recordFileCommitted(rolledBackFileId));
+			REQUIRE(writer.rollbackTransaction());
+			REQUIRE(writer.getCommittedFilePaths() == std::vector<std::string>({"testing_committed_a.cpp"}));
+
+			REQUIRE(writer.recordFileCommitted(writer.recordFile("testing_committed_c.cpp")));
+			REQUIRE(writer.close());
+		}
+
+		{
+			// each checkpoint inserts one row instead of rewriting all committed ids
+			CppSQLite3DB database;
+			database.open("testing.db");
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM committed_file;") == 2);
+		}
+
+		SourcetrailDBWriter writer;
+		REQUIRE(writer.open("testing.db"));
+		std::vector<std::string> committedFilePaths = writer.getCommittedFilePaths();
+		std::sort(committedFilePaths.begin(), committedFilePaths.end());
+		REQUIRE(committedFilePaths == std::vector<std::string>({"testing_committed_a.cpp", "testing_committed_c.cpp"}));
+		REQUIRE(writer.clear());
+		REQUIRE(writer.getCommittedFilePaths().empty());
+		REQUIRE(writer.close());
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter resumes ingest log after last committed file")
+	{
+		const std::string ingestLogFilePath = "testing_resume.log";
+
+		int fooId = 0;
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openIngestLog(ingestLogFilePath));
+			const int fileId = writer.recordFile("testing_resume_a.cpp");
+			fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+			REQUIRE(writer.recordSymbolLocation(fooId, {fileId, 1, 1, 1, 3}));
+			REQUIRE(writer.recordFileCommitted(fileId));
+
+			// this file is not committed, as if the indexer crashed while recording it
+			const int otherFileId = writer.recordFile("testing_resume_b.cpp");
+			REQUIRE(writer.recordSymbolLocation(writer.recordSymbol({"::", {{"void", "lost", "()"}}}), {otherFileId, 1, 1, 1, 4}));
+		}
+
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.resumeIngestLog(ingestLogFilePath));
+			REQUIRE(writer.getCommittedFilePaths() == std::vector<std::string>({"testing_resume_a.cpp"}));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == fooId);
+
+			const int fileId = writer.recordFile("testing_resume_b.cpp");
+			const int barId = writer.recordSymbol({"::", {{"void", "bar", "()"}}});
+			REQUIRE(barId > fooId);
+			REQUIRE(writer.recordSymbolLocation(barId, {fileId, 1, 1, 1, 3}));
+			REQUIRE(writer.recordFileCommitted(fileId));
+			REQUIRE(writer.close());
+
+			std::remove("testing_resumed.db");
+			REQUIRE(writer.open("testing_resumed.db"));
+			REQUIRE(writer.materializeIngestLog(ingestLogFilePath));
+			std::vector<std::string> committedFilePaths = writer.getCommittedFilePaths();
+			std::sort(committedFilePaths.begin(), committedFilePaths.end());
+			REQUIRE(committedFilePaths == std::vector<std::string>({"testing_resume_a.cpp", "testing_resume_b.cpp"}));
+			REQUIRE(writer.close());
+		}
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase("testing_resumed.db");
+		std::set<std::string> serializedNames;
+		for (const StorageNode& node: storage->getAll<StorageNode>())
+		{
+			serializedNames.insert(node.serializedName);
+		}
+		REQUIRE(serializedNames.size() == 4);
+		REQUIRE(storage->getAll<StorageSourceLocation>().size() == 2);
+		for (const std::string& serializedName: serializedNames)
+		{
+			REQUIRE(serializedName.find("lost") == std::string::npos);
+		}
+
+		std::remove(ingestLogFilePath.c_str());
+		std::remove("testing_resumed.db");
+		std::remove("testing_resumed.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter reports failed statements by last error")
+	{
+		const std::string databaseFilePath = "testing_status.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		SourcetrailDBWriter writer;
+		REQUIRE(writer.open(databaseFilePath));
+		const int fileId = writer.recordFile("testing_status.cpp");
+		const int fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+		REQUIRE(fooId != 0);
+
+		REQUIRE(!writer.recordSymbolDefinitionKind(fooId + 1000, DefinitionKind::EXPLICIT));
+		REQUIRE(writer.getLastError().find("insert symbol") != std::string::npos);
+
+		const int rows[] = {fooId, fileId, 1, 1, 1, 3, fooId + 1000, fileId, 2, 1, 2, 3};
+		REQUIRE(!writer.recordSymbolLocations(rows, 2));
+		REQUIRE(writer.getLastError().find("Failed to record location in row 1: ") == 0);
+
+		REQUIRE(writer.recordSymbolDefinitionKind(fooId, DefinitionKind::EXPLICIT));
+		writer.clearLastError();
+		REQUIRE(writer.getLastError().empty());
+		REQUIRE(writer.close());
+
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_status.srctrlprj");
+	}
+
+	TEST_CASE("Testing hash function matches XXH64")
+	{
+		REQUIRE(utility::getHash64("") == 0xEF46DB3751D8E999ULL);
+		REQUIRE(utility::getHash64("abc") == 0x44BC2CF5AD770999ULL);
+		REQUIRE(utility::getHash64("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ULL);
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter finds recorded symbols and errors by hash keys")
+	{
+		const std::string databaseFilePath = "testing_hash_keys.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		int fooId = 0;
+		{
+			// a database without hash keys gets them added when it is opened with hash keys enabled
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databaseFilePath));
+			fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+			REQUIRE(fooId != 0);
+			REQUIRE(writer.close());
+		}
+
+		{
+			SourcetrailDBWriter writer;
+			writer.setHashKeysEnabled(true);
+			REQUIRE(writer.open(databaseFilePath));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == fooId);
+			const int barId = writer.recordSymbol({"::", {{"void", "bar", "()"}}});
+			REQUIRE(barId != 0);
+			REQUIRE(barId != fooId);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "bar", "()"}}}) == barId);
+
+			const int fileId = writer.recordFile("testing_hash_keys.cpp");
+			REQUIRE(writer.recordError("some error", false, {fileId, 1, 1, 1, 3}));
+			REQUIRE(writer.recordError("some error", false, {fileId, 2, 1, 2, 3}));
+			REQUIRE(writer.close());
+		}
+
+		{
+			// the hash keys are kept up to date without enabling them again
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databaseFilePath));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == fooId);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "baz", "()"}}}) != 0);
+			REQUIRE(writer.close());
+		}
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+		storage->setupDatabase();
+		REQUIRE(storage->getHashKeysEnabled());
+		REQUIRE(storage->getAll<StorageError>().size() == 1);
+		std::set<std::string> serializedNames;
+		for (const StorageNode& node: storage->getAll<StorageNode>())
+		{
+			serializedNames.insert(node.serializedName);
+		}
+		REQUIRE(serializedNames.size() == storage->getAll<StorageNode>().size());
+		storage.reset();
+
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_hash_keys.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records symbols from name hierarchy builder")
+	{
+		const std::string databaseFilePath = "testing_builder.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		SourcetrailDBWriter writer;
+		REQUIRE(writer.open(databaseFilePath));
+
+		NameHierarchyBuilder builder = writer.createNameHierarchyBuilder("::");
+		builder.pushElement("", "Foo", "");
+		builder.pushElement("void", "bar", "()");
+		REQUIRE(builder.getElementCount() == 2);
+		REQUIRE(serializeNameHierarchyToDatabaseString(builder.toNameHierarchy()) ==
+				serializeNameHierarchyToDatabaseString({"::", {{"", "Foo", ""}, {"void", "bar", "()"}}}));
+
+		const int barId = writer.recordSymbol(builder);
+		REQUIRE(barId != 0);
+		REQUIRE(writer.recordSymbol(builder) == barId);
+		REQUIRE(writer.recordSymbol({"::", {{"", "Foo", ""}, {"void", "bar", "()"}}}) == barId);
+
+		builder.popElement();
+		const int fooId = writer.recordSymbol(builder);
+		REQUIRE(fooId == writer.recordSymbol({"::", {{"", "Foo", ""}}}));
+
+		builder.pushElement(std::string("int"), std::string("baz"), std::string("(int)"));
+		const int bazId = writer.recordSymbol(builder);
+		REQUIRE(bazId == writer.recordSymbol({"::", {{"", "Foo", ""}, {"int", "baz", "(int)"}}}));
+
+		// builders with a pool of their own are supported as well
+		NameHierarchyBuilder standaloneBuilder(".");
+		standaloneBuilder.pushElement("", "Foo", "");
+		const int javaFooId = writer.recordSymbol(standaloneBuilder);
+		REQUIRE(javaFooId != 0);
+		REQUIRE(javaFooId != fooId);
+		REQUIRE(javaFooId == writer.recordSymbol({".", {{"", "Foo", ""}}}));
+
+		// rolled back symbols are not looked up in memory
+		REQUIRE(writer.beginTransaction());
+		builder.clear();
+		builder.pushElement("", "Rolled", "");
+		REQUIRE(writer.recordSymbol(builder) != 0);
+		REQUIRE(writer.rollbackTransaction());
+		const int rolledId = writer.recordSymbol(builder);
+		REQUIRE(rolledId != 0);
+		REQUIRE(rolledId == writer.recordSymbol({"::", {{"", "Rolled", ""}}}));
+
+		builder.clear();
+		REQUIRE(writer.recordSymbol(builder) == 0);
+		REQUIRE(!writer.getLastError().empty());
+		REQUIRE(writer.close());
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+		REQUIRE(storage->getAll<StorageNode>().size() == 5);
+		REQUIRE(storage->getAll<StorageEdge>().size() == 2);
+		storage.reset();
+
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_builder.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter writes in-memory database at close")
+	{
+		const std::string databaseFilePath = "testing_in_memory.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		auto getSerializedNames = [&]() {
+			std::set<std::string> serializedNames;
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+			for (const StorageNode& node: storage->getAll<StorageNode>())
+			{
+				serializedNames.insert(node.serializedName);
+			}
+			return serializedNames;
+		};
+
+		int fooId = 0;
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openInMemory(databaseFilePath));
+			REQUIRE(writer.beginTransaction());
+			fooId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+			REQUIRE(fooId != 0);
+			REQUIRE(writer.commitTransaction());
+			REQUIRE(!utility::getFileExists(databaseFilePath));
+			REQUIRE(writer.close());
+		}
+		REQUIRE(getSerializedNames().size() == 1);
+
+		{
+			// the existing file is loaded and replaced
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openInMemory(databaseFilePath, 0, true));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == fooId);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "bar", "()"}}}) != 0);
+			REQUIRE(writer.close());
+		}
+		REQUIRE(getSerializedNames().size() == 2);
+
+		{
+			// exceeding the memory limit continues on disk
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openInMemory(databaseFilePath, 1));
+			REQUIRE(writer.clear());
+			REQUIRE(writer.beginTransaction());
+			const int bazId = writer.recordSymbol({"::", {{"void", "baz", "()"}}});
+			REQUIRE(bazId != 0);
+			REQUIRE(writer.commitTransaction());
+			REQUIRE(getSerializedNames().size() == 1);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "baz", "()"}}}) == bazId);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "qux", "()"}}}) != 0);
+			REQUIRE(getSerializedNames().size() == 2);
+			REQUIRE(writer.close());
+		}
+		REQUIRE(getSerializedNames().size() == 2);
+
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_in_memory.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter atomic build replaces database on close")
+	{
+		const std::string databaseFilePath = "testing_atomic_build.srctrldb";
+		const std::string temporaryFilePath = databaseFilePath + ".tmp";
+		std::remove(databaseFilePath.c_str());
+
+		auto getSerializedNames = [&]() {
+			std::set<std::string> serializedNames;
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+			for (const StorageNode& node: storage->getAll<StorageNode>())
+			{
+				serializedNames.insert(node.serializedName);
+			}
+			return serializedNames;
+		};
+
+		{
+			SourcetrailDBWriter writer;
+			writer.setAtomicBuildEnabled(true);
+			REQUIRE(writer.open(databaseFilePath));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) != 0);
+			REQUIRE(utility::getFileExists(temporaryFilePath));
+			REQUIRE(!utility::getFileExists(databaseFilePath));
+			REQUIRE(writer.close());
+		}
+		REQUIRE(!utility::getFileExists(temporaryFilePath));
+		REQUIRE(getSerializedNames().size() == 1);
+		{
+			CppSQLite3DB database;
+			database.open(databaseFilePath.c_str());
+			REQUIRE(database.tableExists("sqlite_stat1"));
+		}
+
+		{
+			SourcetrailDBWriter writer;
+			writer.setAtomicBuildEnabled(true);
+			REQUIRE(writer.open(databaseFilePath));
+			REQUIRE(writer.beginTransaction());
+			REQUIRE(writer.recordSymbol({"::", {{"void", "baz", "()"}}}) != 0);
+			REQUIRE(writer.rollbackTransaction());
+			REQUIRE(writer.recordSymbol({"::", {{"void", "bar", "()"}}}) != 0);
+
+			// readers still see the previous database
+			REQUIRE(getSerializedNames().size() == 1);
+		}
+		// the database file is only replaced by close()
+		REQUIRE(getSerializedNames().size() == 1);
+
+		{
+			SourcetrailDBWriter writer;
+			writer.setAtomicBuildEnabled(true);
+			REQUIRE(writer.openInMemory(databaseFilePath));
+			REQUIRE(writer.recordSymbol({"::", {{"void", "bar", "()"}}}) != 0);
+			REQUIRE(writer.close());
+		}
+		REQUIRE(!utility::getFileExists(temporaryFilePath));
+		REQUIRE(getSerializedNames().size() == 2);
+
+		std::remove(databaseFilePath.c_str());
+		std::remove(temporaryFilePath.c_str());
+		std::remove("testing_atomic_build.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter recreates database on clear")
+	{
+		const std::string databaseFilePath = "testing_recreate_on_clear.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		auto getFileSize = [&]() {
+			std::ifstream file(databaseFilePath, std::ios::binary | std::ios::ate);
+			return static_cast<size_t>(file.tellg());
+		};
+
+		SourcetrailDBWriter writer;
+		writer.setRecreateOnClearEnabled(true);
+		REQUIRE(writer.open(databaseFilePath));
+		REQUIRE(writer.clear());
+		const size_t emptySize = getFileSize();
+
+		REQUIRE(writer.beginTransaction());
+		for (int i = 0; i < 1000; i++)
+		{
+			REQUIRE(writer.recordSymbol({"::", {{"void", "foo" + std::to_string(i), "()"}}}) != 0);
+		}
+		REQUIRE(writer.commitTransaction());
+		REQUIRE(getFileSize() > emptySize);
+
+		SECTION("clear replaces the file")
+		{
+			REQUIRE(writer.clear());
+			REQUIRE(getFileSize() == emptySize);
+			REQUIRE(writer.recordSymbol({"::", {{"void", "bar", "()"}}}) == 1);
+		}
+
+		SECTION("clear drops the tables during a transaction")
+		{
+			REQUIRE(writer.beginTransaction());
+			REQUIRE(writer.clear());
+			REQUIRE(writer.commitTransaction());
+			REQUIRE(DatabaseStorage::openDatabase(databaseFilePath)->getAll<StorageNode>().empty());
+		}
+
+		REQUIRE(writer.close());
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_recreate_on_clear.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter analyzes database")
+	{
+		const std::string databaseFilePath = "testing_analyze.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		auto hasStatistics = [&]() {
+			CppSQLite3DB database;
+			database.open(databaseFilePath.c_str());
+			return database.tableExists("sqlite_stat1") &&
+				database.execScalar("SELECT COUNT(*) FROM sqlite_stat1 WHERE tbl = 'node';") > 0;
+		};
+
+		SourcetrailDBWriter writer;
+		REQUIRE(!writer.analyzeDatabase());
+		REQUIRE(writer.open(databaseFilePath));
+		REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) != 0);
+
+		SECTION("explicitly")
+		{
+			REQUIRE(writer.analyzeDatabase());
+			REQUIRE(hasStatistics());
+			REQUIRE(writer.close());
+		}
+
+		SECTION("on close")
+		{
+			writer.setAnalyzeOnCloseEnabled(true);
+			REQUIRE(!hasStatistics());
+			REQUIRE(writer.close());
+			REQUIRE(hasStatistics());
+		}
+
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_analyze.srctrlprj");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter optimizes database locality")
+	{
+		const std::string databaseFilePath = "testing_locality.srctrldb";
+		std::remove(databaseFilePath.c_str());
+
+		// maps each element to the data of its locations, which has to survive renumbering the locations
+		typedef std::tuple<int, int, int, int, int, int, int> OccurrenceData;
+		auto getOccurrences = [&]() {
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+			std::map<int, StorageSourceLocation> locations;
+			for (const StorageSourceLocation& location: storage->getAll<StorageSourceLocation>())
+			{
+				locations.emplace(location.id, location);
+			}
+			std::set<OccurrenceData> occurrences;
+			for (const StorageOccurrence& occurrence: storage->getAll<StorageOccurrence>())
+			{
+				const StorageSourceLocation& l = locations.at(occurrence.sourceLocationId);
+				occurrences.insert(OccurrenceData(
+					occurrence.elementId, l.fileNodeId, l.startLineNumber, l.startColumnNumber, l.endLineNumber,
+					l.endColumnNumber, l.locationKind));
+			}
+			return occurrences;
+		};
+
+		SourcetrailDBWriter writer;
+		REQUIRE(writer.open(databaseFilePath));
+		REQUIRE(writer.clear());
+
+		const int fileId = writer.recordFile("path/to/non_existing_file.cpp");
+		const int otherFileId = writer.recordFile("path/to/other_non_existing_file.cpp");
+		const int symbolId = writer.recordSymbol({"::", {{"void", "foo", "()"}}});
+		REQUIRE(writer.beginTransaction());
+		for (int line = 20; line > 0; line--)
+		{
+			REQUIRE(writer.recordSymbolLocation(symbolId, {line % 2 ? fileId : otherFileId, line, 1, line, 4}));
+		}
+		const int referenceId = writer.recordReference(symbolId, symbolId, ReferenceKind::CALL);
+		REQUIRE(writer.recordReferenceLocation(referenceId, {fileId, 1, 1, 1, 4}));
+		REQUIRE(writer.updateLocationIndex());
+		REQUIRE(writer.commitTransaction());
+
+		const std::set<OccurrenceData> occurrences = getOccurrences();
+		REQUIRE(occurrences.size() == 21);
+
+		REQUIRE(writer.beginTransaction());
+		REQUIRE(!writer.optimizeDatabaseLocality());
+		REQUIRE(writer.commitTransaction());
+		REQUIRE(writer.optimizeDatabaseLocality());
+		REQUIRE(getOccurrences() == occurrences);
+
+		{
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databaseFilePath);
+			const std::vector<StorageSourceLocation> locations = storage->getAll<StorageSourceLocation>();
+			REQUIRE(locations.size() == 20);
+			for (size_t i = 1; i < locations.size(); i++)
+			{
+				REQUIRE(locations[i - 1].id < locations[i].id);
+				REQUIRE(
+					std::make_pair(locations[i - 1].fileNodeId, locations[i - 1].startLineNumber) <
+					std::make_pair(locations[i].fileNodeId, locations[i].startLineNumber));
+			}
+
+			// the location index is rebuilt with the new ids
+			const std::vector<StorageSourceLocation> locationsAt = storage->getLocationsAt(otherFileId, 4, 2);
+			REQUIRE(locationsAt.size() == 1);
+			REQUIRE(locationsAt.front().startLineNumber == 4);
+		}
+
+		// recording continues with the same element ids and deduplicates the moved locations
+		REQUIRE(writer.recordSymbol({"::", {{"void", "foo", "()"}}}) == symbolId);
+		REQUIRE(writer.recordReference(symbolId, symbolId, ReferenceKind::CALL) == referenceId);
+		REQUIRE(writer.recordReferenceLocation(referenceId, {fileId, 1, 1, 1, 4}));
+		REQUIRE(getOccurrences() == occurrences);
+
+		REQUIRE(writer.close());
+		std::remove(databaseFilePath.c_str());
+		std::remove("testing_locality.srctrlprj");
+	}
 }
@@ -59,11 +59,8 @@ def main():
 	srctrl.recordSymbolKind(memberId, srctrl.SYMBOL_FIELD)
 	srctrl.recordSymbolLocation(memberId, fileId, 4, 2, 4, 10)
 
-	methodId = srctrl.recordSymbol(
-		'{ "name_delimiter": ".", "name_elements": [ '
-			'{ "prefix": "", "name": "MyType", "postfix": "" }, '
-			'{ "prefix": "", "name": "my_method", "postfix": "" } '
-		'] }')
+	# passing the name elements as parallel lists avoids building and parsing JSON
+	methodId = srctrl.recordSymbolWithNameElements(".", ["", ""], ["MyType", "my_method"], ["", ""])
 	srctrl.recordSymbolDefinitionKind(methodId, srctrl.DEFINITION_EXPLICIT)
 	srctrl.recordSymbolKind(methodId, srctrl.SYMBOL_METHOD)
 	srctrl.recordSymbolLocation(methodId, fileId, 6, 6, 6, 14)
@@ -246,8 +246,14 @@ public:
 
     CppSQLite3Query execQuery();
 
+    // non-throwing variants of execDML() and execQuery(), return the SQLite result code
+    int tryExecDML(int& nRowsChanged);
+    // reads the first column of the first result row, bHasRow is false if there is no row
+    int tryExecScalar(int& nValue, bool& bHasRow);
+
     void bind(int nParam, const char* szValue);
     void bind(int nParam, const int nValue);
+    void bind(int nParam, const sqlite_int64 nValue);
     void bind(int nParam, const double dwValue);
     void bind(int nParam, const unsigned char* blobValue, int nLen);
     void bindNull(int nParam);
@@ -310,6 +316,10 @@ public:
 
 	bool IsAutoCommitOn();
 
+	// copies the whole database to or from a database file with the online backup API
+	void backupTo(const char* szFile);
+	void restoreFrom(const char* szFile);
+
 private:
 
     CppSQLite3DB(const CppSQLite3DB& db);
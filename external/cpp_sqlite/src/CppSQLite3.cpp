@@ -991,6 +991,54 @@ CppSQLite3Query CppSQLite3Statement::execQuery()
 }
 
 
+int CppSQLite3Statement::tryExecDML(int& nRowsChanged)
+{
+	nRowsChanged = 0;
+	if (mpDB == 0 || mpVM == 0)
+	{
+		return SQLITE_MISUSE;
+	}
+
+	int nRet = sqlite3_step(mpVM);
+	if (nRet == SQLITE_DONE)
+	{
+		nRowsChanged = sqlite3_changes(mpDB);
+	}
+
+	int nResetRet = sqlite3_reset(mpVM);
+	if (nRet == SQLITE_DONE || nResetRet != SQLITE_OK)
+	{
+		return nResetRet;
+	}
+	return nRet;
+}
+
+
+int CppSQLite3Statement::tryExecScalar(int& nValue, bool& bHasRow)
+{
+	nValue = 0;
+	bHasRow = false;
+	if (mpDB == 0 || mpVM == 0)
+	{
+		return SQLITE_MISUSE;
+	}
+
+	int nRet = sqlite3_step(mpVM);
+	if (nRet == SQLITE_ROW)
+	{
+		nValue = sqlite3_column_int(mpVM, 0);
+		bHasRow = true;
+	}
+
+	int nResetRet = sqlite3_reset(mpVM);
+	if (nRet == SQLITE_ROW || nRet == SQLITE_DONE || nResetRet != SQLITE_OK)
+	{
+		return nResetRet;
+	}
+	return nRet;
+}
+
+
 void CppSQLite3Statement::bind(int nParam, const char* szValue)
 {
 	checkVM();
@@ -1019,6 +1067,20 @@ void CppSQLite3Statement::bind(int nParam, const int nValue)
 }
 
 
+void CppSQLite3Statement::bind(int nParam, const sqlite_int64 nValue)
+{
+	checkVM();
+	int nRes = sqlite3_bind_int64(mpVM, nParam, nValue);
+
+	if (nRes != SQLITE_OK)
+	{
+		throw CppSQLite3Exception(nRes,
+								"Error binding int64 param",
+								DONT_DELETE_MSG);
+	}
+}
+
+
 void CppSQLite3Statement::bind(int nParam, const double dValue)
 {
 	checkVM();
@@ -1391,6 +1453,76 @@ bool CppSQLite3DB::IsAutoCommitOn()
 	return sqlite3_get_autocommit(mpDB) ? true : false;
 }
 
+
+static void copyDatabase(sqlite3* pSource, sqlite3* pDestination)
+{
+	sqlite3_backup* pBackup = sqlite3_backup_init(pDestination, "main", pSource, "main");
+	if (!pBackup)
+	{
+		throw CppSQLite3Exception(sqlite3_errcode(pDestination),
+								(char*)sqlite3_errmsg(pDestination),
+								DONT_DELETE_MSG);
+	}
+
+	sqlite3_backup_step(pBackup, -1);
+
+	int nRes = sqlite3_backup_finish(pBackup);
+	if (nRes != SQLITE_OK)
+	{
+		throw CppSQLite3Exception(nRes,
+								(char*)sqlite3_errmsg(pDestination),
+								DONT_DELETE_MSG);
+	}
+}
+
+
+static sqlite3* openOtherDatabase(const char* szFile)
+{
+	sqlite3* pDB = 0;
+	int nRet = sqlite3_open(szFile, &pDB);
+	if (nRet != SQLITE_OK)
+	{
+		CppSQLite3Exception e(nRet, (char*)sqlite3_errmsg(pDB), DONT_DELETE_MSG);
+		sqlite3_close(pDB);
+		throw e;
+	}
+	return pDB;
+}
+
+
+void CppSQLite3DB::backupTo(const char* szFile)
+{
+	checkDB();
+	sqlite3* pFile = openOtherDatabase(szFile);
+	try
+	{
+		copyDatabase(mpDB, pFile);
+	}
+	catch (...)
+	{
+		sqlite3_close(pFile);
+		throw;
+	}
+	sqlite3_close(pFile);
+}
+
+
+void CppSQLite3DB::restoreFrom(const char* szFile)
+{
+	checkDB();
+	sqlite3* pFile = openOtherDatabase(szFile);
+	try
+	{
+		copyDatabase(pFile, mpDB);
+	}
+	catch (...)
+	{
+		sqlite3_close(pFile);
+		throw;
+	}
+	sqlite3_close(pFile);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // SQLite encode.c reproduced here, containing implementation notes and source
 // for sqlite3_encode_binary() and sqlite3_decode_binary() 
@@ -1,7 +1,9 @@
 #ifndef SOURCETRAILDB_H
 #define SOURCETRAILDB_H
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 enum DefinitionKind
 {
@@ -77,20 +79,32 @@ bool optimizeDatabaseMemory();
 
 int recordSymbol(std::string serializedNameHierarchy);
 
+int recordSymbolWithNameElements(
+	std::string nameDelimiter,
+	const std::vector<std::string>& prefixes,
+	const std::vector<std::string>& names,
+	const std::vector<std::string>& postfixes);
+
 bool recordSymbolDefinitionKind(int symbolId, DefinitionKind symbolDefinitionKind);
 
 bool recordSymbolKind(int symbolId, SymbolKind symbolKind);
 
 bool recordSymbolLocation(int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
 
+bool recordSymbolLocations(const int* locationRows, size_t locationRowCount);
+
 bool recordSymbolScopeLocation(int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
 
 bool recordSymbolSignatureLocation(int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
 
 int recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind);
 
+bool recordReferences(const int* referenceRows, size_t referenceRowCount, int* referenceIds, size_t referenceIdCount);
+
 bool recordReferenceLocation(int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
 
+bool recordReferenceLocations(const int* locationRows, size_t locationRowCount);
+
 bool recordReferenceIsAmbiguous(int referenceId);
 
 int recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, int fileId, int startLine, int startColumn, int endLine, int endColumn);
@@ -109,4 +123,84 @@ bool recordAtomicSourceRange(int fileId, int startLine, int startColumn, int end
 
 bool recordError(std::string message, bool fatal, int fileId, int startLine, int startColumn, int endLine, int endColumn);
 
+// The functions above operate on a single default writer. The functions below operate on independent writers that
+// are identified by the handle returned by createWriter(). Different handles can be used from different threads at
+// the same time, but each handle must only be used by one thread at a time.
+
+int createWriter();
+
+bool destroyWriter(int writerHandle);
+
+std::string getLastError(int writerHandle);
+
+void clearLastError(int writerHandle);
+
+bool open(int writerHandle, std::string databaseFilePath);
+
+bool close(int writerHandle);
+
+bool clear(int writerHandle);
+
+bool isEmpty(int writerHandle);
+
+bool isCompatible(int writerHandle);
+
+int getLoadedDatabaseVersion(int writerHandle);
+
+bool beginTransaction(int writerHandle);
+
+bool commitTransaction(int writerHandle);
+
+bool rollbackTransaction(int writerHandle);
+
+bool optimizeDatabaseMemory(int writerHandle);
+
+int recordSymbol(int writerHandle, std::string serializedNameHierarchy);
+
+int recordSymbolWithNameElements(
+	int writerHandle,
+	std::string nameDelimiter,
+	const std::vector<std::string>& prefixes,
+	const std::vector<std::string>& names,
+	const std::vector<std::string>& postfixes);
+
+bool recordSymbolDefinitionKind(int writerHandle, int symbolId, DefinitionKind symbolDefinitionKind);
+
+bool recordSymbolKind(int writerHandle, int symbolId, SymbolKind symbolKind);
+
+bool recordSymbolLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordSymbolLocations(int writerHandle, const int* locationRows, size_t locationRowCount);
+
+bool recordSymbolScopeLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordSymbolSignatureLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+int recordReference(int writerHandle, int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind);
+
+bool recordReferences(
+	int writerHandle, const int* referenceRows, size_t referenceRowCount, int* referenceIds, size_t referenceIdCount);
+
+bool recordReferenceLocation(int writerHandle, int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordReferenceLocations(int writerHandle, const int* locationRows, size_t locationRowCount);
+
+bool recordReferenceIsAmbiguous(int writerHandle, int referenceId);
+
+int recordReferenceToUnsolvedSymhol(int writerHandle, int contextSymbolId, ReferenceKind referenceKind, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordQualifierLocation(int writerHandle, int referencedSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+int recordFile(int writerHandle, std::string filePath);
+
+bool recordFileLanguage(int writerHandle, int fileId, std::string languageIdentifier);
+
+int recordLocalSymbol(int writerHandle, std::string name);
+
+bool recordLocalSymbolLocation(int writerHandle, int localSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordAtomicSourceRange(int writerHandle, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
+bool recordError(int writerHandle, std::string message, bool fatal, int fileId, int startLine, int startColumn, int endLine, int endColumn);
+
 #endif // SOURCETRAILDB_H
@@ -1,13 +1,172 @@
 //sourcetraildb.i
 
-%module sourcetraildb
+%module(threads="1") sourcetraildb
 %include "std_string.i"
+%include "std_vector.i"
 %feature("autodoc", "1");
 
 %{
 #include "sourcetraildb.h"
 %}
 
+%template(StringVector) std::vector<std::string>;
+
+// Only release the Python GIL for calls that may block on file I/O or SQLite for a long time, so that other Python
+// threads can keep running meanwhile. A writer is not thread safe, so calls to the same writer must still not be made
+// concurrently.
+%nothread;
+%thread open;
+%thread close;
+%thread destroyWriter;
+%thread commitTransaction;
+%thread optimizeDatabaseMemory;
+%thread recordFile;
+%thread recordSymbolLocations;
+%thread recordReferences;
+%thread recordReferenceLocations;
+
+// The bulk functions take rows of 32 bit integers and fill buffers of ids without copying them. The row buffers need
+// to contain a multiple of the row width, the id buffers need to provide room for one id per row.
+#ifdef SWIGPYTHON
+// Python accepts any C-contiguous buffer of 32 bit integers in native byte order (e.g. array.array("i"), numpy.int32
+// arrays or memoryviews of these). Id buffers need to be writable.
+%define %sourcetrail_int_buffer(POINTER_TYPE, POINTER_NAME, COUNT_NAME, ROW_WIDTH, BUFFER_FLAGS, DESCRIPTION)
+%typemap(in) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME) (Py_buffer view, bool viewAcquired = false)
+{
+	if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | BUFFER_FLAGS) != 0)
+	{
+		SWIG_fail;
+	}
+	viewAcquired = true;
+
+	// '<', '>' and '!' select a fixed byte order, which is only accepted if it is the one of the host
+	const int one = 1;
+	const bool littleEndianHost = *reinterpret_cast<const char*>(&one) == 1;
+	bool littleEndianBuffer = littleEndianHost;
+	const char* format = view.format ? view.format : "B";
+	if (*format == '<')
+	{
+		littleEndianBuffer = true;
+		format++;
+	}
+	else if (*format == '>' || *format == '!')
+	{
+		littleEndianBuffer = false;
+		format++;
+	}
+	else if (*format == '@' || *format == '=')
+	{
+		format++;
+	}
+	if (littleEndianBuffer != littleEndianHost)
+	{
+		PyErr_SetString(PyExc_TypeError, DESCRIPTION " need to be in native byte order");
+		SWIG_fail;
+	}
+	if (view.itemsize != sizeof(int) || (strcmp(format, "i") != 0 && strcmp(format, "l") != 0))
+	{
+		PyErr_SetString(PyExc_TypeError, DESCRIPTION " need to be a buffer of 32 bit integers");
+		SWIG_fail;
+	}
+	if ((view.len / view.itemsize) % ROW_WIDTH != 0)
+	{
+		PyErr_SetString(PyExc_ValueError, DESCRIPTION " need to consist of " #ROW_WIDTH " integers each");
+		SWIG_fail;
+	}
+
+	$1 = static_cast<POINTER_TYPE>(view.buf);
+	$2 = static_cast<size_t>(view.len / view.itemsize / ROW_WIDTH);
+}
+
+%typemap(freearg) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME)
+{
+	if (viewAcquired$argnum)
+	{
+		PyBuffer_Release(&view$argnum);
+	}
+}
+
+%typemap(typecheck, precedence=SWIG_TYPECHECK_POINTER) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME)
+{
+	$1 = PyObject_CheckBuffer($input) ? 1 : 0;
+}
+%enddef
+#endif
+
+#ifdef SWIGJAVA
+%{
+#include <type_traits>
+%}
+
+// Java accepts direct IntBuffers in native byte order, e.g.
+// ByteBuffer.allocateDirect(4 * n).order(ByteOrder.nativeOrder()).asIntBuffer(). The rows between the position and
+// the limit of the buffer are used, neither of them is modified by the call. Id buffers must not be read-only.
+%define %sourcetrail_int_buffer(POINTER_TYPE, POINTER_NAME, COUNT_NAME, ROW_WIDTH, BUFFER_FLAGS, DESCRIPTION)
+%typemap(jni) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME) "jobject"
+%typemap(jtype) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME) "java.nio.IntBuffer"
+%typemap(jstype) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME) "java.nio.IntBuffer"
+%typemap(javain) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME) "$javainput"
+
+%typemap(in) (POINTER_TYPE POINTER_NAME, size_t COUNT_NAME)
+{
+	int* data = $input ? static_cast<int*>(jenv->GetDirectBufferAddress($input)) : nullptr;
+	if (!data)
+	{
+		SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, DESCRIPTION " need to be a direct IntBuffer");
+		return $null;
+	}
+
+	jclass bufferClass = jenv->FindClass("java/nio/IntBuffer");
+	const jint position = jenv->CallIntMethod($input, jenv->GetMethodID(bufferClass, "position", "()I"));
+	const jint limit = jenv->CallIntMethod($input, jenv->GetMethodID(bufferClass, "limit", "()I"));
+	const bool readOnly = jenv->CallBooleanMethod($input, jenv->GetMethodID(bufferClass, "isReadOnly", "()Z"));
+	jobject order = jenv->CallObjectMethod(
+		$input, jenv->GetMethodID(bufferClass, "order", "()Ljava/nio/ByteOrder;"));
+	jclass byteOrderClass = jenv->FindClass("java/nio/ByteOrder");
+	jobject nativeOrder = jenv->CallStaticObjectMethod(
+		byteOrderClass, jenv->GetStaticMethodID(byteOrderClass, "nativeOrder", "()Ljava/nio/ByteOrder;"));
+	// the ByteOrder constants are singletons, so the orders can be compared by identity
+	const bool isNativeOrder = jenv->IsSameObject(order, nativeOrder);
+	jenv->DeleteLocalRef(nativeOrder);
+	jenv->DeleteLocalRef(byteOrderClass);
+	jenv->DeleteLocalRef(order);
+	jenv->DeleteLocalRef(bufferClass);
+	if (!isNativeOrder)
+	{
+		SWIG_JavaThrowException(
+			jenv, SWIG_JavaIllegalArgumentException, DESCRIPTION " need to be in native byte order");
+		return $null;
+	}
+	if (readOnly && !std::is_const<std::remove_pointer<POINTER_TYPE>::type>::value)
+	{
+		SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, DESCRIPTION " must not be read-only");
+		return $null;
+	}
+	if ((limit - position) % ROW_WIDTH != 0)
+	{
+		SWIG_JavaThrowException(
+			jenv, SWIG_JavaIllegalArgumentException, DESCRIPTION " need to consist of " #ROW_WIDTH " integers each");
+		return $null;
+	}
+
+	$1 = data + position;
+	$2 = static_cast<size_t>((limit - position) / ROW_WIDTH);
+}
+%enddef
+#endif
+
+#if defined(SWIGPYTHON) || defined(SWIGJAVA)
+%sourcetrail_int_buffer(const int*, locationRows, locationRowCount, 6, 0, "location rows")
+%sourcetrail_int_buffer(const int*, referenceRows, referenceRowCount, 3, 0, "reference rows")
+%sourcetrail_int_buffer(int*, referenceIds, referenceIdCount, 1, PyBUF_WRITABLE, "reference ids")
+#else
+// The bulk functions take raw int row buffers and there are no typemaps for them in this language,
+// so they are not exported instead of being wrapped as unusable pointer arguments.
+%ignore recordSymbolLocations;
+%ignore recordReferences;
+%ignore recordReferenceLocations;
+#endif
+
 //double-check that this is indeed %include !!!
 %include "sourcetraildb.h"
 
@@ -1,5 +1,9 @@
 #include "sourcetraildb.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "DefinitionKind.h"
 #include "NameHierarchy.h"
 #include "SymbolKind.h"
@@ -96,6 +100,87 @@ namespace
 		}
 		return sourcetrail::ReferenceKind::TYPE_USAGE;
 	}
+
+	typedef std::shared_ptr<sourcetrail::SourcetrailDBWriter> WriterPtr;
+
+	std::mutex writersMutex;
+	std::map<int, WriterPtr> writers;
+	int nextWriterHandle = 1;
+
+	// Holding a reference keeps the writer alive even if destroyWriter() gets called while it is in use.
+	WriterPtr getWriter(int writerHandle)
+	{
+		std::lock_guard<std::mutex> lock(writersMutex);
+		std::map<int, WriterPtr>::const_iterator it = writers.find(writerHandle);
+		return it != writers.end() ? it->second : WriterPtr();
+	}
+
+	int recordSymbol(sourcetrail::SourcetrailDBWriter& writer, std::string serializedNameHierarchy)
+	{
+		std::string error;
+		const sourcetrail::NameHierarchy nameHierarchy = sourcetrail::deserializeNameHierarchyFromJson(serializedNameHierarchy, &error);
+		if (error.size() || nameHierarchy.nameElements.empty())
+		{
+			writer.setLastError("Unable to deserialize name hierarchy \"" + serializedNameHierarchy + "\": " + error);
+			return 0;
+		}
+		return writer.recordSymbol(nameHierarchy);
+	}
+
+	int recordSymbolWithNameElements(
+		sourcetrail::SourcetrailDBWriter& writer,
+		std::string nameDelimiter,
+		const std::vector<std::string>& prefixes,
+		const std::vector<std::string>& names,
+		const std::vector<std::string>& postfixes)
+	{
+		if (names.empty() || prefixes.size() != names.size() || postfixes.size() != names.size())
+		{
+			writer.setLastError("Unable to record symbol, because the prefixes, names and postfixes are empty or differ in size.");
+			return 0;
+		}
+
+		sourcetrail::NameHierarchy nameHierarchy;
+		nameHierarchy.nameDelimiter = std::move(nameDelimiter);
+		nameHierarchy.nameElements.resize(names.size());
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			nameHierarchy.nameElements[i].prefix = prefixes[i];
+			nameHierarchy.nameElements[i].name = names[i];
+			nameHierarchy.nameElements[i].postfix = postfixes[i];
+		}
+		return writer.recordSymbol(nameHierarchy);
+	}
+
+	// The reference rows are passed to the writer unchanged, so the kinds of the bindings have to match the core
+	// values that convertReferenceKind() would return.
+	static_assert(REFERENCE_TYPE_USAGE == static_cast<int>(sourcetrail::ReferenceKind::TYPE_USAGE), "");
+	static_assert(REFERENCE_USAGE == static_cast<int>(sourcetrail::ReferenceKind::USAGE), "");
+	static_assert(REFERENCE_CALL == static_cast<int>(sourcetrail::ReferenceKind::CALL), "");
+	static_assert(REFERENCE_INHERITANCE == static_cast<int>(sourcetrail::ReferenceKind::INHERITANCE), "");
+	static_assert(REFERENCE_OVERRIDE == static_cast<int>(sourcetrail::ReferenceKind::OVERRIDE), "");
+	static_assert(REFERENCE_TYPE_ARGUMENT == static_cast<int>(sourcetrail::ReferenceKind::TYPE_ARGUMENT), "");
+	static_assert(
+		REFERENCE_TEMPLATE_SPECIALIZATION == static_cast<int>(sourcetrail::ReferenceKind::TEMPLATE_SPECIALIZATION), "");
+	static_assert(REFERENCE_INCLUDE == static_cast<int>(sourcetrail::ReferenceKind::INCLUDE), "");
+	static_assert(REFERENCE_IMPORT == static_cast<int>(sourcetrail::ReferenceKind::IMPORT), "");
+	static_assert(REFERENCE_MACRO_USAGE == static_cast<int>(sourcetrail::ReferenceKind::MACRO_USAGE), "");
+	static_assert(REFERENCE_ANNOTATION_USAGE == static_cast<int>(sourcetrail::ReferenceKind::ANNOTATION_USAGE), "");
+
+	bool recordReferences(
+		sourcetrail::SourcetrailDBWriter& writer,
+		const int* referenceRows,
+		size_t referenceRowCount,
+		int* referenceIds,
+		size_t referenceIdCount)
+	{
+		if (referenceIdCount < referenceRowCount)
+		{
+			writer.setLastError("Unable to record references, because the buffer for the reference ids is too small.");
+			return false;
+		}
+		return writer.recordReferences(referenceRows, referenceRowCount, referenceIds);
+	}
 }
 
 sourcetrail::SourcetrailDBWriter dbWriter;
@@ -172,14 +257,16 @@ bool optimizeDatabaseMemory()
 
 int recordSymbol(std::string serializedNameHierarchy)
 {
-	std::string error;
-	const sourcetrail::NameHierarchy nameHierarchy = sourcetrail::deserializeNameHierarchyFromJson(serializedNameHierarchy, &error);
-	if (error.size() || nameHierarchy.nameElements.empty())
-	{
-		dbWriter.setLastError("Unable to deserialize name hierarchy \"" + serializedNameHierarchy + "\": " + error);
-		return 0;
-	}
-	return dbWriter.recordSymbol(nameHierarchy);
+	return recordSymbol(dbWriter, serializedNameHierarchy);
+}
+
+int recordSymbolWithNameElements(
+	std::string nameDelimiter,
+	const std::vector<std::string>& prefixes,
+	const std::vector<std::string>& names,
+	const std::vector<std::string>& postfixes)
+{
+	return recordSymbolWithNameElements(dbWriter, std::move(nameDelimiter), prefixes, names, postfixes);
 }
 
 bool recordSymbolDefinitionKind(int symbolId, DefinitionKind symbolDefinitionKind)
@@ -197,6 +284,11 @@ bool recordSymbolLocation(int symbolId, int fileId, int startLine, int startColu
 	return dbWriter.recordSymbolLocation(symbolId, { fileId, startLine, startColumn, endLine, endColumn });
 }
 
+bool recordSymbolLocations(const int* locationRows, size_t locationRowCount)
+{
+	return dbWriter.recordSymbolLocations(locationRows, locationRowCount);
+}
+
 bool recordSymbolScopeLocation(int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
 {
 	return dbWriter.recordSymbolScopeLocation(symbolId, { fileId, startLine, startColumn, endLine, endColumn });
@@ -212,11 +304,21 @@ int recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind r
 	return dbWriter.recordReference(contextSymbolId, referencedSymbolId, convertReferenceKind(referenceKind));
 }
 
+bool recordReferences(const int* referenceRows, size_t referenceRowCount, int* referenceIds, size_t referenceIdCount)
+{
+	return recordReferences(dbWriter, referenceRows, referenceRowCount, referenceIds, referenceIdCount);
+}
+
 bool recordReferenceLocation(int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
 {
 	return dbWriter.recordReferenceLocation(referenceId, { fileId, startLine, startColumn, endLine, endColumn });
 }
 
+bool recordReferenceLocations(const int* locationRows, size_t locationRowCount)
+{
+	return dbWriter.recordReferenceLocations(locationRows, locationRowCount);
+}
+
 bool recordReferenceIsAmbiguous(int referenceId)
 {
 	return dbWriter.recordReferenceIsAmbiguous(referenceId);
@@ -261,3 +363,235 @@ bool recordError(std::string message, bool fatal, int fileId, int startLine, int
 {
 	return dbWriter.recordError(message, fatal, { fileId, startLine, startColumn, endLine, endColumn });
 }
+
+int createWriter()
+{
+	std::lock_guard<std::mutex> lock(writersMutex);
+	const int writerHandle = nextWriterHandle++;
+	writers[writerHandle] = std::make_shared<sourcetrail::SourcetrailDBWriter>();
+	return writerHandle;
+}
+
+bool destroyWriter(int writerHandle)
+{
+	WriterPtr writer;
+	{
+		std::lock_guard<std::mutex> lock(writersMutex);
+		std::map<int, WriterPtr>::iterator it = writers.find(writerHandle);
+		if (it == writers.end())
+		{
+			return false;
+		}
+		writer = it->second;
+		writers.erase(it);
+	}
+	// the database gets closed when the last reference to the writer is released, which happens outside of the lock
+	return true;
+}
+
+std::string getLastError(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->getLastError() : "No writer exists for handle " + std::to_string(writerHandle) + ".";
+}
+
+void clearLastError(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	if (writer)
+	{
+		writer->clearLastError();
+	}
+}
+
+bool open(int writerHandle, std::string databaseFilePath)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->open(databaseFilePath);
+}
+
+bool close(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->close();
+}
+
+bool clear(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->clear();
+}
+
+bool isEmpty(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->isEmpty();
+}
+
+bool isCompatible(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->isCompatible();
+}
+
+int getLoadedDatabaseVersion(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->getLoadedDatabaseVersion() : 0;
+}
+
+bool beginTransaction(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->beginTransaction();
+}
+
+bool commitTransaction(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->commitTransaction();
+}
+
+bool rollbackTransaction(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->rollbackTransaction();
+}
+
+bool optimizeDatabaseMemory(int writerHandle)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->optimizeDatabaseMemory();
+}
+
+int recordSymbol(int writerHandle, std::string serializedNameHierarchy)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? recordSymbol(*writer, serializedNameHierarchy) : 0;
+}
+
+int recordSymbolWithNameElements(
+	int writerHandle,
+	std::string nameDelimiter,
+	const std::vector<std::string>& prefixes,
+	const std::vector<std::string>& names,
+	const std::vector<std::string>& postfixes)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? recordSymbolWithNameElements(*writer, nameDelimiter, prefixes, names, postfixes) : 0;
+}
+
+bool recordSymbolDefinitionKind(int writerHandle, int symbolId, DefinitionKind symbolDefinitionKind)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolDefinitionKind(symbolId, convertDefinitionKind(symbolDefinitionKind));
+}
+
+bool recordSymbolKind(int writerHandle, int symbolId, SymbolKind symbolKind)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolKind(symbolId, convertSymbolKind(symbolKind));
+}
+
+bool recordSymbolLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolLocation(symbolId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+bool recordSymbolLocations(int writerHandle, const int* locationRows, size_t locationRowCount)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolLocations(locationRows, locationRowCount);
+}
+
+bool recordSymbolScopeLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolScopeLocation(symbolId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+bool recordSymbolSignatureLocation(int writerHandle, int symbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordSymbolSignatureLocation(symbolId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+int recordReference(int writerHandle, int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->recordReference(contextSymbolId, referencedSymbolId, convertReferenceKind(referenceKind)) : 0;
+}
+
+bool recordReferences(
+	int writerHandle, const int* referenceRows, size_t referenceRowCount, int* referenceIds, size_t referenceIdCount)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && recordReferences(*writer, referenceRows, referenceRowCount, referenceIds, referenceIdCount);
+}
+
+bool recordReferenceLocation(int writerHandle, int referenceId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordReferenceLocation(referenceId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+bool recordReferenceLocations(int writerHandle, const int* locationRows, size_t locationRowCount)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordReferenceLocations(locationRows, locationRowCount);
+}
+
+bool recordReferenceIsAmbiguous(int writerHandle, int referenceId)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordReferenceIsAmbiguous(referenceId);
+}
+
+int recordReferenceToUnsolvedSymhol(int writerHandle, int contextSymbolId, ReferenceKind referenceKind, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->recordReferenceToUnsolvedSymhol(contextSymbolId, convertReferenceKind(referenceKind), { fileId, startLine, startColumn, endLine, endColumn }) : 0;
+}
+
+bool recordQualifierLocation(int writerHandle, int referencedSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordQualifierLocation(referencedSymbolId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+int recordFile(int writerHandle, std::string filePath)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->recordFile(filePath) : 0;
+}
+
+bool recordFileLanguage(int writerHandle, int fileId, std::string languageIdentifier)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordFileLanguage(fileId, languageIdentifier);
+}
+
+int recordLocalSymbol(int writerHandle, std::string name)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer ? writer->recordLocalSymbol(name) : 0;
+}
+
+bool recordLocalSymbolLocation(int writerHandle, int localSymbolId, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordLocalSymbolLocation(localSymbolId, { fileId, startLine, startColumn, endLine, endColumn });
+}
+
+bool recordAtomicSourceRange(int writerHandle, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordAtomicSourceRange({ fileId, startLine, startColumn, endLine, endColumn });
+}
+
+bool recordError(int writerHandle, std::string message, bool fatal, int fileId, int startLine, int startColumn, int endLine, int endColumn)
+{
+	const WriterPtr writer = getWriter(writerHandle);
+	return writer && writer->recordError(message, fatal, { fileId, startLine, startColumn, endLine, endColumn });
+}